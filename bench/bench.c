@@ -0,0 +1,132 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench_arena.h"
+#include "bench_binary.h"
+#include "bench_classify.h"
+#include "bench_diff.h"
+#include "bench_error.h"
+#include "bench_files.h"
+#include "bench_layers.h"
+#include "bench_lookup.h"
+#include "bench_memory.h"
+#include "bench_miss.h"
+#include "bench_number.h"
+#include "bench_parse.h"
+#include "bench_prefix.h"
+#include "bench_reparse.h"
+#include "bench_suite.h"
+
+static const char usage[] =
+    "Usage: bnc [--json [--entries N] [--seed N] [--mix S,B,I,F,C]\n"
+    "            [--comments P] [--long-keys P] [--shadowed P]]\n"
+    "\n"
+    "Without options, prints every benchmark as a table. With --json, runs\n"
+    "the suite on a config generated from the options: N entries mixing\n"
+    "strings, bools, ints, floats and colors by the given weights, with P%\n"
+    "of them preceded by a comment, having a long key, or redefining an\n"
+    "earlier key.\n";
+
+static int
+parse_int(const char *arg, int *dst)
+{
+    char *end;
+    long n = arg ? strtol(arg, &end, 10) : -1;
+    if (arg == NULL || *end != '\0' || n < 0 || n > 100000000)
+        return -1;
+
+    *dst = n;
+    return 0;
+}
+
+static int
+parse_mix(const char *arg, GenOpts *opts)
+{
+    if (arg == NULL)
+        return -1;
+
+    for (int i = 0; i < GEN_TYPES; i++) {
+        char *end;
+        long n = strtol(arg, &end, 10);
+        if (end == arg || n < 0 || n > 1000)
+            return -1;
+        if (*end != (i + 1 < GEN_TYPES ? ',' : '\0'))
+            return -1;
+
+        opts->mix[i] = n;
+        arg = end + 1;
+    }
+    return 0;
+}
+
+static int
+parse_args(int argc, char **argv, GenOpts *opts)
+{
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *val = argv[i + 1];
+        int seed = 0;
+
+        if (!strcmp(arg, "--json"))
+            continue;
+
+        int res = -1;
+        if (!strcmp(arg, "--entries"))
+            res = parse_int(val, &opts->count);
+        else if (!strcmp(arg, "--seed") && (res = parse_int(val, &seed)) == 0)
+            opts->seed = seed;
+        else if (!strcmp(arg, "--mix"))
+            res = parse_mix(val, opts);
+        else if (!strcmp(arg, "--comments"))
+            res = parse_int(val, &opts->comments);
+        else if (!strcmp(arg, "--long-keys"))
+            res = parse_int(val, &opts->long_keys);
+        else if (!strcmp(arg, "--shadowed"))
+            res = parse_int(val, &opts->shadowed);
+
+        if (res != 0)
+            return -1;
+        i++;
+    }
+    return opts->count > 0 ? 0 : -1;
+}
+
+int
+main(int argc, char **argv)
+{
+    FILE *stream = stdout;
+
+    if (argc > 1) {
+        GenOpts opts = {
+            .count = 100000,
+            .seed = 1,
+            .mix = {30, 10, 30, 20, 10},
+            .comments = 20,
+            .long_keys = 10,
+            .shadowed = 5,
+        };
+        if (strcmp(argv[1], "--json") != 0 ||
+            parse_args(argc, argv, &opts) != 0) {
+            fprintf(stderr, "%s", usage);
+            return 1;
+        }
+        return run_suite_bench(stream, &opts) == 0 ? 0 : 1;
+    }
+
+    run_lookup_bench(stream);
+    run_miss_bench(stream);
+    run_prefix_bench(stream);
+    run_layers_bench(stream);
+    run_diff_bench(stream);
+    run_parse_bench(stream);
+    run_parallel_bench(stream);
+    run_reparse_bench(stream);
+    run_files_bench(stream);
+    run_arena_bench(stream);
+    run_classify_bench(stream);
+    run_error_bench(stream);
+    run_binary_bench(stream);
+    run_number_bench(stream);
+    run_memory_bench(stream);
+    return 0;
+}
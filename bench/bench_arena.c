@@ -0,0 +1,56 @@
+#include <stdlib.h>
+
+#include "../config.h"
+#include "bench_arena.h"
+
+#define ARENA_ROUNDS 20
+
+static void
+bench_size(FILE *stream, int count)
+{
+    int len;
+    char *src = generate_mixed_config(count, &len);
+    if (src == NULL) {
+        fprintf(stderr, "Error: memory allocation failed\n");
+        return;
+    }
+
+    CfgError err;
+    CfgArena arena = {0};
+
+    // The first parse sizes the arena, later ones reuse it
+    if (cfg_parse_arena(src, len, &arena, &err) != 0) {
+        cfg_fprint_error(stderr, &err);
+        goto out;
+    }
+    int first = arena.allocs;
+
+    double start = now();
+    for (int i = 0; i < ARENA_ROUNDS; i++) {
+        if (cfg_parse_arena(src, len, &arena, &err) != 0) {
+            cfg_fprint_error(stderr, &err);
+            goto out;
+        }
+    }
+    double elapsed = now() - start;
+
+    double mb = (double) len * ARENA_ROUNDS / (1 << 20);
+    fprintf(stream, "%8d %10.1f %8d %10.2f\n", count, mb / elapsed, first,
+            (double) (arena.allocs - first) / ARENA_ROUNDS);
+
+out:
+    cfg_arena_free(&arena);
+    free(src);
+}
+
+void
+run_arena_bench(FILE *stream)
+{
+    static const int sizes[] = {10, 1000, 100000};
+
+    fprintf(stream, "Arena (allocations per parse)\n");
+    fprintf(stream, "%8s %10s %8s %10s\n", "entries", "MB/s", "first",
+            "reparse");
+    for (int i = 0; i < (int) COUNT_OF(sizes); i++)
+        bench_size(stream, sizes[i]);
+}
@@ -0,0 +1,8 @@
+#ifndef BENCH_ARENA_H
+#define BENCH_ARENA_H
+
+#include "utils.h"
+
+void run_arena_bench(FILE *stream);
+
+#endif
@@ -0,0 +1,74 @@
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "../config.h"
+#include "bench_binary.h"
+
+#define BINARY_ROUNDS 10
+
+static void
+bench_size(FILE *stream, int count)
+{
+    char text[] = "/tmp/bench-binary-XXXXXX.cfg";
+    char binary[] = "/tmp/bench-binary-XXXXXX";
+    int text_fd = mkstemps(text, 4);
+    int binary_fd = mkstemp(binary);
+
+    int len;
+    char *src = generate_mixed_config(count, &len);
+    CfgEntry *entries = malloc(count * sizeof(CfgEntry));
+    CfgSlot *slots = malloc(CFG_INDEX_CAPACITY(count) * sizeof(CfgSlot));
+    if (src == NULL || entries == NULL || slots == NULL || text_fd < 0 ||
+        binary_fd < 0 || write(text_fd, src, len) != len) {
+        fprintf(stderr, "Error: failed to prepare the benchmark\n");
+        goto out;
+    }
+
+    CfgError err;
+    Cfg cfg = {
+        .entries = entries,
+        .capacity = count,
+        .index = {.slots = slots, .capacity = CFG_INDEX_CAPACITY(count)},
+    };
+
+    double start = now();
+    for (int i = 0; i < BINARY_ROUNDS; i++)
+        cfg_parse_file(text, &cfg, &err);
+    double parse = (now() - start) / BINARY_ROUNDS;
+
+    if (cfg_save_binary(&cfg, binary, &err) != 0) {
+        cfg_fprint_error(stderr, &err);
+        goto out;
+    }
+
+    start = now();
+    for (int i = 0; i < BINARY_ROUNDS; i++)
+        cfg_load_binary(binary, &cfg, &err);
+    double load = (now() - start) / BINARY_ROUNDS;
+
+    fprintf(stream, "%8d %12.1f %12.1f\n", count, parse * 1e6, load * 1e6);
+
+out:
+    if (text_fd >= 0) {
+        close(text_fd);
+        unlink(text);
+    }
+    if (binary_fd >= 0) {
+        close(binary_fd);
+        unlink(binary);
+    }
+    free(slots);
+    free(entries);
+    free(src);
+}
+
+void
+run_binary_bench(FILE *stream)
+{
+    static const int sizes[] = {100, 10000, 100000};
+
+    fprintf(stream, "Load (microseconds per load)\n");
+    fprintf(stream, "%8s %12s %12s\n", "entries", "text", "binary");
+    for (int i = 0; i < (int) COUNT_OF(sizes); i++)
+        bench_size(stream, sizes[i]);
+}
@@ -0,0 +1,8 @@
+#ifndef BENCH_BINARY_H
+#define BENCH_BINARY_H
+
+#include "utils.h"
+
+void run_binary_bench(FILE *stream);
+
+#endif
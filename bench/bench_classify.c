@@ -0,0 +1,94 @@
+#include <ctype.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "bench_classify.h"
+
+#define CLASSIFY_ENTRIES 200000
+#define CLASSIFY_ROUNDS 10
+
+// Same classes as the table in config.c
+#define CC_KEY 0x01
+#define CC_STRING 0x02
+#define CC_BLANK 0x04
+
+static uint8_t char_class[256];
+
+static void
+init_char_class(void)
+{
+    for (int ch = 0; ch < 128; ch++) {
+        if (isalpha(ch) || ch == '.' || ch == '_')
+            char_class[ch] |= CC_KEY;
+        if (isalnum(ch) || isblank(ch) || (ispunct(ch) && ch != '"'))
+            char_class[ch] |= CC_STRING;
+        if (isspace(ch) && ch != '\n')
+            char_class[ch] |= CC_BLANK;
+    }
+}
+
+// Count the bytes of each class the way the scanner used to
+static long
+classify_ctype(const char *src, int len)
+{
+    long n = 0;
+    for (int i = 0; i < len; i++) {
+        char ch = src[i];
+        n += isalpha(ch) || ch == '.' || ch == '_';
+        n += isalnum(ch) || isblank(ch) || (ispunct(ch) && ch != '"');
+        n += isspace(ch) && ch != '\n';
+    }
+    return n;
+}
+
+static long
+classify_table(const char *src, int len)
+{
+    long n = 0;
+    for (int i = 0; i < len; i++) {
+        uint8_t cls = char_class[(uint8_t) src[i]];
+        n += (cls & CC_KEY) != 0;
+        n += (cls & CC_STRING) != 0;
+        n += (cls & CC_BLANK) != 0;
+    }
+    return n;
+}
+
+static double
+time_classify(long (*classify)(const char *, int), const char *src, int len)
+{
+    volatile long sink = 0;
+
+    double start = now();
+    for (int i = 0; i < CLASSIFY_ROUNDS; i++)
+        sink += classify(src, len);
+    double elapsed = now() - start;
+
+    (void) sink;
+    return elapsed * 1e9 / ((double) len * CLASSIFY_ROUNDS);
+}
+
+void
+run_classify_bench(FILE *stream)
+{
+    int len;
+    char *src = generate_mixed_config(CLASSIFY_ENTRIES, &len);
+    if (src == NULL) {
+        fprintf(stderr, "Error: memory allocation failed\n");
+        return;
+    }
+
+    init_char_class();
+    if (classify_ctype(src, len) != classify_table(src, len))
+        fprintf(stderr, "Error: classifications differ\n");
+
+    fprintf(stream, "Classify (ns per byte, %.1f MB)\n",
+            (double) len / (1 << 20));
+    fprintf(stream, "%8s %10s\n", "method", "ns/byte");
+    fprintf(stream, "%8s %10.3f\n", "ctype",
+            time_classify(classify_ctype, src, len));
+    fprintf(stream, "%8s %10.3f\n", "table",
+            time_classify(classify_table, src, len));
+
+    free(src);
+}
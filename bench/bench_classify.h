@@ -0,0 +1,8 @@
+#ifndef BENCH_CLASSIFY_H
+#define BENCH_CLASSIFY_H
+
+#include "utils.h"
+
+void run_classify_bench(FILE *stream);
+
+#endif
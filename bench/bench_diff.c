@@ -0,0 +1,116 @@
+#include <stdlib.h>
+
+#include "../config.h"
+#include "bench_diff.h"
+
+static void
+on_change(CfgChange change, const char *key, CfgValType type, void *user)
+{
+    (void) key;
+    (void) type;
+    *(long *) user += change;
+}
+
+static double
+time_diff(Cfg *old, Cfg *new, int iters)
+{
+    long sum = 0;
+
+    double start = now();
+    for (int i = 0; i < iters; i++)
+        cfg_diff(old, new, on_change, &sum);
+    double elapsed = now() - start;
+
+    volatile long sink = sum;
+    (void) sink;
+    return elapsed * 1e3 / iters;
+}
+
+static double
+time_notify(CfgSubscribers *subs, Cfg *old, Cfg *new, int iters)
+{
+    double start = now();
+    for (int i = 0; i < iters; i++)
+        cfg_notify(subs, old, new);
+    return (now() - start) * 1e3 / iters;
+}
+
+static void
+bench_size(FILE *stream, int count)
+{
+    CfgError err;
+    int len;
+    char *src = generate_config(count, &len);
+    CfgEntry *entries[2];
+    CfgSlot *slots[2];
+    int *sorted[2];
+    Cfg cfgs[2];
+    for (int i = 0; i < 2; i++) {
+        entries[i] = malloc(count * sizeof(CfgEntry));
+        slots[i] = malloc(CFG_INDEX_CAPACITY(count) * sizeof(CfgSlot));
+        sorted[i] = malloc(CFG_SORTED_CAPACITY(count) * sizeof(int));
+        cfgs[i] = (Cfg){
+            .entries = entries[i],
+            .capacity = count,
+            .index = {.slots = slots[i], .capacity = CFG_INDEX_CAPACITY(count)},
+            .sorted = {.entries = sorted[i],
+                       .capacity = CFG_SORTED_CAPACITY(count)},
+        };
+    }
+    if (src == NULL || !entries[0] || !entries[1] || !slots[0] || !slots[1] ||
+        !sorted[0] || !sorted[1]) {
+        fprintf(stderr, "Error: memory allocation failed\n");
+        goto out;
+    }
+
+    for (int i = 0; i < 2; i++) {
+        if (cfg_parse(src, len, &cfgs[i], &err) != 0)
+            cfg_fprint_error(stderr, &err);
+    }
+
+    // One value in a hundred changes
+    for (int i = 0; i < count; i += 100)
+        entries[1][i].val.integer++;
+
+    int iters = 10000000 / count;
+    if (iters > 10000)
+        iters = 10000;
+    double indexed = time_diff(&cfgs[0], &cfgs[1], iters);
+
+    // Keys are "k." followed by the number in base 26, lowest digit first
+    CfgSubscription buf[1];
+    CfgSubscribers subs = {.subs = buf, .capacity = 1};
+    long sum = 0;
+    cfg_subscribe(&subs, "k.ab", on_change, &sum);
+    double narrowed = time_notify(&subs, &cfgs[0], &cfgs[1], iters);
+
+    for (int i = 0; i < 2; i++) {
+        cfgs[i].index.size = 0;
+        cfgs[i].sorted.count = 0;
+    }
+    double unindexed = time_diff(&cfgs[0], &cfgs[1], iters / 10 + 1);
+    double filtered = time_notify(&subs, &cfgs[0], &cfgs[1], iters / 10 + 1);
+
+    fprintf(stream, "%8d %10.3f %10.3f %10.3f %10.3f\n", count, indexed,
+            unindexed, narrowed, filtered);
+
+out:
+    for (int i = 0; i < 2; i++) {
+        free(sorted[i]);
+        free(slots[i]);
+        free(entries[i]);
+    }
+    free(src);
+}
+
+void
+run_diff_bench(FILE *stream)
+{
+    static const int sizes[] = {100, 1000, 10000, 100000};
+
+    fprintf(stream, "Diff (ms per cfg_diff and cfg_notify)\n");
+    fprintf(stream, "%8s %10s %10s %10s %10s\n", "entries", "indexed",
+            "unindexed", "prefix", "filtered");
+    for (int i = 0; i < (int) COUNT_OF(sizes); i++)
+        bench_size(stream, sizes[i]);
+}
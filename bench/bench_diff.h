@@ -0,0 +1,8 @@
+#ifndef BENCH_DIFF_H
+#define BENCH_DIFF_H
+
+#include "utils.h"
+
+void run_diff_bench(FILE *stream);
+
+#endif
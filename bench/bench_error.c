@@ -0,0 +1,59 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "../config.h"
+#include "bench_error.h"
+
+#define ERROR_ROUNDS 20
+
+static void
+bench_size(FILE *stream, int count)
+{
+    int len;
+    char *src = generate_mixed_config(count, &len);
+    CfgEntry *entries = malloc(count * sizeof(CfgEntry));
+    if (src == NULL || entries == NULL) {
+        fprintf(stderr, "Error: memory allocation failed\n");
+        goto out;
+    }
+
+    // Break the last line, so the error is found after scanning everything
+    src[len - 2] = '@';
+
+    CfgError err;
+    Cfg cfg = {.entries = entries, .capacity = count};
+
+    double start = now();
+    for (int i = 0; i < ERROR_ROUNDS; i++) {
+        if (cfg_parse(src, len, &cfg, &err) == 0) {
+            fprintf(stderr, "Error: the source should be invalid\n");
+            goto out;
+        }
+    }
+    double elapsed = now() - start;
+
+    // The time of a successful parse, without the error
+    memcpy(src + len - 2, ")\n", 2);
+    start = now();
+    for (int i = 0; i < ERROR_ROUNDS; i++)
+        cfg_parse(src, len, &cfg, &err);
+    double baseline = now() - start;
+
+    fprintf(stream, "%8d %12.1f %12.1f\n", count,
+            ERROR_ROUNDS / elapsed, ERROR_ROUNDS / baseline);
+
+out:
+    free(entries);
+    free(src);
+}
+
+void
+run_error_bench(FILE *stream)
+{
+    static const int sizes[] = {1000, 100000, 1000000};
+
+    fprintf(stream, "Error at the end (parses per second)\n");
+    fprintf(stream, "%8s %12s %12s\n", "entries", "error", "valid");
+    for (int i = 0; i < (int) COUNT_OF(sizes); i++)
+        bench_size(stream, sizes[i]);
+}
@@ -0,0 +1,8 @@
+#ifndef BENCH_ERROR_H
+#define BENCH_ERROR_H
+
+#include "utils.h"
+
+void run_error_bench(FILE *stream);
+
+#endif
@@ -0,0 +1,124 @@
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../config.h"
+#include "bench_files.h"
+
+#define FILES 10000
+#define FILE_ENTRIES 20
+
+// Small files on tmpfs, so the cost is in the syscalls rather than the disk
+static const char *
+bench_dir(void)
+{
+    struct stat st;
+    if (stat("/dev/shm", &st) == 0 && S_ISDIR(st.st_mode))
+        return "/dev/shm";
+    return "/tmp";
+}
+
+static int
+write_files(char (*paths)[128], int *total)
+{
+    int len;
+    char *src = generate_mixed_config(FILE_ENTRIES, &len);
+    if (src == NULL)
+        return -1;
+
+    *total = 0;
+    for (int i = 0; i < FILES; i++) {
+        FILE *file = fopen(paths[i], "w");
+        if (file == NULL) {
+            free(src);
+            return -1;
+        }
+        fwrite(src, 1, len, file);
+        fclose(file);
+        *total += len;
+    }
+
+    free(src);
+    return 0;
+}
+
+void
+run_files_bench(FILE *stream)
+{
+    static const int threads[] = {1, 2, 4, 8};
+
+    char dir[64];
+    snprintf(dir, sizeof(dir), "%s/bench-files-XXXXXX", bench_dir());
+    if (mkdtemp(dir) == NULL) {
+        fprintf(stderr, "Error: failed to create %s\n", dir);
+        return;
+    }
+
+    char(*paths)[128] = malloc(FILES * sizeof(*paths));
+    const char **names = malloc(FILES * sizeof(*names));
+    Cfg *cfgs = malloc(FILES * sizeof(Cfg));
+    CfgError *errs = malloc(FILES * sizeof(CfgError));
+    CfgEntry *entries = malloc(FILE_ENTRIES * sizeof(CfgEntry));
+    CfgArena arena = {0};
+    int total = 0;
+    if (paths == NULL || names == NULL || cfgs == NULL || errs == NULL ||
+        entries == NULL) {
+        fprintf(stderr, "Error: memory allocation failed\n");
+        goto out;
+    }
+
+    for (int i = 0; i < FILES; i++) {
+        snprintf(paths[i], sizeof(paths[i]), "%s/%05d.cfg", dir, i);
+        names[i] = paths[i];
+    }
+
+    if (write_files(paths, &total) != 0) {
+        fprintf(stderr, "Error: failed to write the files\n");
+        goto out;
+    }
+
+    fprintf(stream, "Files (ms for %d files of %d entries in %s)\n", FILES,
+            FILE_ENTRIES, bench_dir());
+    fprintf(stream, "%8s %10s %10s\n", "threads", "ms", "MB/s");
+
+    // One cfg_parse_file() after the other
+    CfgError err;
+    Cfg cfg = {.entries = entries, .capacity = FILE_ENTRIES};
+    double start = now();
+    for (int i = 0; i < FILES; i++) {
+        if (cfg_parse_file(names[i], &cfg, &err) != 0) {
+            cfg_fprint_error(stderr, &err);
+            goto out;
+        }
+    }
+    double elapsed = now() - start;
+    fprintf(stream, "%8s %10.1f %10.1f\n", "serial", elapsed * 1e3,
+            total / elapsed / (1 << 20));
+
+    for (int i = 0; i < (int) COUNT_OF(threads); i++) {
+        CfgFilesOpts opts = {.arena = &arena, .nthreads = threads[i]};
+
+        start = now();
+        if (cfg_parse_files(names, FILES, cfgs, errs, &opts) != 0) {
+            fprintf(stderr, "Error: failed to load the files\n");
+            goto out;
+        }
+        elapsed = now() - start;
+        fprintf(stream, "%8d %10.1f %10.1f\n", threads[i], elapsed * 1e3,
+                total / elapsed / (1 << 20));
+    }
+
+out:
+    if (paths != NULL) {
+        for (int i = 0; i < FILES; i++)
+            unlink(paths[i]);
+    }
+    rmdir(dir);
+    cfg_arena_free(&arena);
+    free(entries);
+    free(errs);
+    free(cfgs);
+    free(names);
+    free(paths);
+}
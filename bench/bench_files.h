@@ -0,0 +1,8 @@
+#ifndef BENCH_FILES_H
+#define BENCH_FILES_H
+
+#include "utils.h"
+
+void run_files_bench(FILE *stream);
+
+#endif
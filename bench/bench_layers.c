@@ -0,0 +1,112 @@
+#include <stdlib.h>
+
+#include "../config.h"
+#include "bench_layers.h"
+
+#define LAYER_ENTRIES 10000
+#define LOOKUPS 1000000
+
+static double
+time_lookups(CfgLayers *layers, char (*keys)[16], int nkeys)
+{
+    volatile int sink = 0;
+
+    double start = now();
+    for (int i = 0; i < LOOKUPS; i++)
+        sink += cfg_layers_get_int(layers, keys[i % nkeys], -1);
+    double elapsed = now() - start;
+
+    (void) sink;
+    return elapsed * 1e9 / LOOKUPS;
+}
+
+// Every layer defines the same keys, but only the bottom one as integers,
+// so every lookup falls through all the others
+static void
+bench_layers(FILE *stream, Cfg *cfgs, int nlayers, char (*keys)[16])
+{
+    int count = nlayers * LAYER_ENTRIES;
+    CfgLayerSlot *slots = malloc(CFG_INDEX_CAPACITY(count) *
+                                 sizeof(CfgLayerSlot));
+    if (slots == NULL) {
+        fprintf(stderr, "Error: memory allocation failed\n");
+        return;
+    }
+
+    CfgLayers layers = {.slots = slots, .capacity = CFG_INDEX_CAPACITY(count)};
+    for (int i = 0; i < nlayers; i++)
+        cfg_layers_set(&layers, i, &cfgs[i]);
+
+    double start = now();
+    cfg_layers_get_int(&layers, keys[0], -1);
+    double build = (now() - start) * 1e3;
+    double merged = time_lookups(&layers, keys, LAYER_ENTRIES);
+
+    layers.capacity = 0;
+    cfg_layers_set(&layers, 0, &cfgs[0]);
+    double search = time_lookups(&layers, keys, LAYER_ENTRIES);
+
+    fprintf(stream, "%8d %10.2f %10.1f %10.1f\n", nlayers, build, merged,
+            search);
+    free(slots);
+}
+
+void
+run_layers_bench(FILE *stream)
+{
+    int len;
+    int text_len;
+    char *src = generate_config(LAYER_ENTRIES, &len);
+    char *text = generate_text_config(LAYER_ENTRIES, &text_len);
+    char(*keys)[16] = malloc(LAYER_ENTRIES * sizeof(*keys));
+    Cfg cfgs[CFG_MAX_LAYERS] = {0};
+
+    for (int i = 0; i < CFG_MAX_LAYERS; i++) {
+        CfgEntry *entries = malloc(LAYER_ENTRIES * sizeof(CfgEntry));
+        CfgSlot *slots = malloc(CFG_INDEX_CAPACITY(LAYER_ENTRIES) *
+                                sizeof(CfgSlot));
+        cfgs[i] = (Cfg){
+            .entries = entries,
+            .capacity = LAYER_ENTRIES,
+            .index = {.slots = slots,
+                      .capacity = CFG_INDEX_CAPACITY(LAYER_ENTRIES)},
+        };
+        if (entries == NULL || slots == NULL) {
+            fprintf(stderr, "Error: memory allocation failed\n");
+            goto out;
+        }
+    }
+    if (src == NULL || text == NULL || keys == NULL) {
+        fprintf(stderr, "Error: memory allocation failed\n");
+        goto out;
+    }
+
+    for (int i = 0; i < LAYER_ENTRIES; i++)
+        make_key(keys[i], (i * 7919) % LAYER_ENTRIES);
+
+    CfgError err;
+    for (int i = 0; i < CFG_MAX_LAYERS; i++) {
+        const char *layer_src = i == 0 ? src : text;
+        int layer_len = i == 0 ? len : text_len;
+        if (cfg_parse(layer_src, layer_len, &cfgs[i], &err) != 0) {
+            cfg_fprint_error(stderr, &err);
+            goto out;
+        }
+    }
+
+    fprintf(stream, "Layers (%d entries each, build ms, ns per lookup)\n",
+            LAYER_ENTRIES);
+    fprintf(stream, "%8s %10s %10s %10s\n", "layers", "build", "merged",
+            "search");
+    for (int n = 1; n <= CFG_MAX_LAYERS; n *= 2)
+        bench_layers(stream, cfgs, n, keys);
+
+out:
+    for (int i = 0; i < CFG_MAX_LAYERS; i++) {
+        free(cfgs[i].index.slots);
+        free(cfgs[i].entries);
+    }
+    free(keys);
+    free(text);
+    free(src);
+}
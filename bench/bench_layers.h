@@ -0,0 +1,8 @@
+#ifndef BENCH_LAYERS_H
+#define BENCH_LAYERS_H
+
+#include "utils.h"
+
+void run_layers_bench(FILE *stream);
+
+#endif
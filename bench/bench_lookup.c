@@ -0,0 +1,111 @@
+#include <stdlib.h>
+
+#include "../config.h"
+#include "bench_lookup.h"
+
+static double
+time_lookups(Cfg *cfg, char (*keys)[16], int nkeys, int lookups)
+{
+    volatile int sink = 0;
+
+    double start = now();
+    for (int i = 0; i < lookups; i++)
+        sink += cfg_get_int(cfg, keys[i % nkeys], -1);
+    double elapsed = now() - start;
+
+    (void) sink;
+    return elapsed * 1e9 / lookups;
+}
+
+static double
+time_handles(Cfg *cfg, CfgKey *handles, int nkeys, int lookups)
+{
+    volatile int sink = 0;
+
+    double start = now();
+    for (int i = 0; i < lookups; i++)
+        sink += cfg_get_int_h(cfg, handles[i % nkeys], -1);
+    double elapsed = now() - start;
+
+    (void) sink;
+    return elapsed * 1e9 / lookups;
+}
+
+static void
+bench_size(FILE *stream, int count)
+{
+    int len;
+    char *src = generate_config(count, &len);
+    CfgEntry *entries = malloc(count * sizeof(CfgEntry));
+    CfgSlot *slots = malloc(CFG_INDEX_CAPACITY(count) * sizeof(CfgSlot));
+    char(*keys)[16] = malloc(count * sizeof(*keys));
+    CfgKey *handles = malloc(count * sizeof(CfgKey));
+    uint32_t *hashes = malloc(count * sizeof(uint32_t));
+    uint8_t *lens = malloc(count);
+    uint8_t *types = malloc(count);
+    if (src == NULL || entries == NULL || slots == NULL || keys == NULL ||
+        handles == NULL || hashes == NULL || lens == NULL || types == NULL) {
+        fprintf(stderr, "Error: memory allocation failed\n");
+        goto out;
+    }
+
+    for (int i = 0; i < count; i++)
+        make_key(keys[i], (i * 7919) % count);
+
+    CfgError err;
+    Cfg cfg = {
+        .entries = entries,
+        .capacity = count,
+        .index = {.slots = slots, .capacity = CFG_INDEX_CAPACITY(count)},
+        .keys = {.hashes = hashes,
+                 .lens = lens,
+                 .types = types,
+                 .capacity = count},
+    };
+    if (cfg_parse(src, len, &cfg, &err) != 0) {
+        cfg_fprint_error(stderr, &err);
+        goto out;
+    }
+
+    double indexed = time_lookups(&cfg, keys, count, 1000000);
+
+    for (int i = 0; i < count; i++)
+        handles[i] = cfg_key_resolve(&cfg, keys[i], CFG_TYPE_INT);
+    double handle = time_handles(&cfg, handles, count, 1000000);
+
+    // Keep the total work of the scans bounded
+    int lookups = 100000000 / count;
+    if (lookups > 1000000)
+        lookups = 1000000;
+
+    cfg.index.size = 0;
+    double dense = time_lookups(&cfg, keys, count, lookups);
+
+    cfg.keys.count = 0;
+    double linear = time_lookups(&cfg, keys, count, lookups);
+
+    fprintf(stream, "%8d %10.1f %10.1f %10.1f %10.1f\n", count, handle,
+            indexed, dense, linear);
+
+out:
+    free(types);
+    free(lens);
+    free(hashes);
+    free(handles);
+    free(keys);
+    free(slots);
+    free(entries);
+    free(src);
+}
+
+void
+run_lookup_bench(FILE *stream)
+{
+    static const int sizes[] = {10, 100, 1000, 10000, 100000};
+
+    fprintf(stream, "Lookup (ns per cfg_get_int)\n");
+    fprintf(stream, "%8s %10s %10s %10s %10s\n", "entries", "handle",
+            "indexed", "dense", "linear");
+    for (int i = 0; i < (int) COUNT_OF(sizes); i++)
+        bench_size(stream, sizes[i]);
+}
@@ -0,0 +1,8 @@
+#ifndef BENCH_LOOKUP_H
+#define BENCH_LOOKUP_H
+
+#include "utils.h"
+
+void run_lookup_bench(FILE *stream);
+
+#endif
@@ -0,0 +1,102 @@
+#include <stdlib.h>
+
+#include "../config.h"
+#include "bench_memory.h"
+
+#define MEMORY_ROUNDS 10
+#define MEMORY_LOOKUPS 1000000
+
+typedef struct {
+    double kb;
+    double parse;   // MB/s
+    double lookup;  // ns
+} Footprint;
+
+static int
+measure(Cfg *cfg, const char *src, int len, char (*keys)[16], Footprint *fp)
+{
+    CfgError err;
+
+    double start = now();
+    for (int i = 0; i < MEMORY_ROUNDS; i++) {
+        if (cfg_parse(src, len, cfg, &err) != 0) {
+            cfg_fprint_error(stderr, &err);
+            return -1;
+        }
+    }
+    double elapsed = (now() - start) / MEMORY_ROUNDS;
+    fp->parse = (double) len / (1 << 20) / elapsed;
+
+    volatile int sink = 0;
+    start = now();
+    for (int i = 0; i < MEMORY_LOOKUPS; i++)
+        sink += cfg_get_int(cfg, keys[i % cfg->count], -1);
+    fp->lookup = (now() - start) * 1e9 / MEMORY_LOOKUPS;
+    (void) sink;
+
+    // Entries and pool, the index is the same for both layouts
+    size_t bytes = cfg->compact != NULL
+                       ? cfg->count * sizeof(CfgCompactEntry) + cfg->pool_len
+                       : cfg->count * sizeof(CfgEntry);
+    fp->kb = bytes / 1024.0;
+    return 0;
+}
+
+static void
+bench_size(FILE *stream, int count)
+{
+    int len;
+    char *src = generate_mixed_config(count, &len);
+    CfgEntry *entries = malloc(count * sizeof(CfgEntry));
+    CfgCompactEntry *compact = malloc(count * sizeof(CfgCompactEntry));
+    char *pool = malloc(len);
+    CfgSlot *slots = malloc(CFG_INDEX_CAPACITY(count) * sizeof(CfgSlot));
+    char(*keys)[16] = malloc(count * sizeof(*keys));
+    if (src == NULL || entries == NULL || compact == NULL || pool == NULL ||
+        slots == NULL || keys == NULL) {
+        fprintf(stderr, "Error: memory allocation failed\n");
+        goto out;
+    }
+
+    for (int i = 0; i < count; i++)
+        make_key(keys[i], (i * 7919) % count);
+
+    CfgIndex index = {.slots = slots, .capacity = CFG_INDEX_CAPACITY(count)};
+    Cfg cfg = {.entries = entries, .capacity = count, .index = index};
+    Cfg compact_cfg = {
+        .compact = compact,
+        .capacity = count,
+        .index = index,
+        .pool = pool,
+        .pool_capacity = len,
+    };
+
+    Footprint fat, slim;
+    if (measure(&cfg, src, len, keys, &fat) != 0 ||
+        measure(&compact_cfg, src, len, keys, &slim) != 0)
+        goto out;
+
+    fprintf(stream, "%8d %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f\n", count,
+            fat.kb, slim.kb, fat.parse, slim.parse, fat.lookup, slim.lookup);
+
+out:
+    free(keys);
+    free(slots);
+    free(pool);
+    free(compact);
+    free(entries);
+    free(src);
+}
+
+void
+run_memory_bench(FILE *stream)
+{
+    static const int sizes[] = {1000, 10000, 100000};
+
+    fprintf(stream, "Memory footprint (default and compact layouts, "
+                    "mixed config)\n");
+    fprintf(stream, "%8s %10s %10s %10s %10s %10s %10s\n", "entries", "KB",
+            "KB", "MB/s", "MB/s", "ns/lookup", "ns/lookup");
+    for (int i = 0; i < (int) COUNT_OF(sizes); i++)
+        bench_size(stream, sizes[i]);
+}
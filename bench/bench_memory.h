@@ -0,0 +1,8 @@
+#ifndef BENCH_MEMORY_H
+#define BENCH_MEMORY_H
+
+#include "utils.h"
+
+void run_memory_bench(FILE *stream);
+
+#endif
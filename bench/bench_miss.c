@@ -0,0 +1,122 @@
+#include <stdlib.h>
+
+#include "../config.h"
+#include "bench_miss.h"
+
+#define MISS_KEYS 1024
+
+// Nine lookups in ten are for keys which aren't there
+static double
+time_lookups(Cfg *cfg, char (*keys)[16], int lookups)
+{
+    volatile int sink = 0;
+
+    double start = now();
+    for (int i = 0; i < lookups; i++)
+        sink += cfg_get_int(cfg, keys[i % MISS_KEYS], -1);
+    double elapsed = now() - start;
+
+    (void) sink;
+    return elapsed * 1e9 / lookups;
+}
+
+static double
+time_parse(const char *src, int len, Cfg *cfg)
+{
+    CfgError err;
+
+    double start = now();
+    if (cfg_parse(src, len, cfg, &err) != 0)
+        cfg_fprint_error(stderr, &err);
+    return (now() - start) * 1e3;
+}
+
+// Times the lookups with and without the Bloom filter
+static void
+time_both(Cfg *cfg, const char *src, int len, char (*keys)[16], int lookups,
+          double res[2])
+{
+    CfgBloom bloom = cfg->bloom;
+
+    cfg->bloom = (CfgBloom){0};
+    time_parse(src, len, cfg);
+    res[0] = time_lookups(cfg, keys, lookups);
+
+    cfg->bloom = bloom;
+    time_parse(src, len, cfg);
+    res[1] = time_lookups(cfg, keys, lookups);
+}
+
+static void
+bench_size(FILE *stream, int count)
+{
+    int len;
+    char *src = generate_config(count, &len);
+    CfgEntry *entries = malloc(count * sizeof(CfgEntry));
+    CfgSlot *slots = malloc(CFG_INDEX_CAPACITY(count) * sizeof(CfgSlot));
+    uint64_t *words = malloc(CFG_BLOOM_CAPACITY(count) * sizeof(uint64_t));
+    uint32_t *hashes = malloc(count * sizeof(uint32_t));
+    uint8_t *lens = malloc(count);
+    uint8_t *types = malloc(count);
+    char(*keys)[16] = malloc(MISS_KEYS * sizeof(*keys));
+    if (src == NULL || entries == NULL || slots == NULL || words == NULL ||
+        hashes == NULL || lens == NULL || types == NULL || keys == NULL) {
+        fprintf(stderr, "Error: memory allocation failed\n");
+        goto out;
+    }
+
+    for (int i = 0; i < MISS_KEYS; i++)
+        make_key(keys[i], i % 10 ? count + i : (i * 7919) % count);
+
+    Cfg cfg = {
+        .entries = entries,
+        .capacity = count,
+        .bloom = {.words = words, .capacity = CFG_BLOOM_CAPACITY(count)},
+    };
+
+    int lookups = 100000000 / count;
+    if (lookups > 1000000)
+        lookups = 1000000;
+
+    double linear[2], dense[2], indexed[2];
+    time_both(&cfg, src, len, keys, lookups, linear);
+
+    cfg.keys = (CfgKeys){
+        .hashes = hashes,
+        .lens = lens,
+        .types = types,
+        .capacity = count,
+    };
+    time_both(&cfg, src, len, keys, lookups, dense);
+
+    cfg.index = (CfgIndex){
+        .slots = slots,
+        .capacity = CFG_INDEX_CAPACITY(count),
+    };
+    time_both(&cfg, src, len, keys, 1000000, indexed);
+
+    fprintf(stream, "%8d %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f\n", count,
+            linear[0], linear[1], dense[0], dense[1], indexed[0], indexed[1]);
+
+out:
+    free(keys);
+    free(types);
+    free(lens);
+    free(hashes);
+    free(words);
+    free(slots);
+    free(entries);
+    free(src);
+}
+
+void
+run_miss_bench(FILE *stream)
+{
+    static const int sizes[] = {10, 100, 1000, 10000, 100000};
+
+    fprintf(stream, "Misses (ns per lookup, 90%% misses, without/with Bloom)\n");
+    fprintf(stream, "%8s %10s %10s %10s %10s %10s %10s\n", "entries",
+            "linear", "+bloom", "dense", "+bloom", "indexed", "+bloom");
+    for (int i = 0; i < (int) COUNT_OF(sizes); i++)
+        bench_size(stream, sizes[i]);
+}
@@ -0,0 +1,8 @@
+#ifndef BENCH_MISS_H
+#define BENCH_MISS_H
+
+#include "utils.h"
+
+void run_miss_bench(FILE *stream);
+
+#endif
@@ -0,0 +1,147 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "../config.h"
+#include "bench_number.h"
+
+#define NUMBER_ENTRIES 200000
+#define NUMBER_ROUNDS 10
+
+typedef struct {
+    const char *src;
+    int *values;  // Offsets of the float values
+    int count;
+} Numbers;
+
+static double
+time_strtof(Numbers *numbers)
+{
+    volatile float sink = 0;
+
+    double start = now();
+    for (int r = 0; r < NUMBER_ROUNDS; r++) {
+        for (int i = 0; i < numbers->count; i++)
+            sink += strtof(numbers->src + numbers->values[i], NULL);
+    }
+    double elapsed = now() - start;
+
+    (void) sink;
+    return elapsed * 1e9 / ((double) numbers->count * NUMBER_ROUNDS);
+}
+
+static double
+time_read_float(Numbers *numbers)
+{
+    volatile float sink = 0;
+
+    double start = now();
+    for (int r = 0; r < NUMBER_ROUNDS; r++) {
+        for (int i = 0; i < numbers->count; i++) {
+            float number = 0;
+            cfg_read_float(numbers->src + numbers->values[i], 32, &number);
+            sink += number;
+        }
+    }
+    double elapsed = now() - start;
+
+    (void) sink;
+    return elapsed * 1e9 / ((double) numbers->count * NUMBER_ROUNDS);
+}
+
+static double
+time_strtod(Numbers *numbers)
+{
+    volatile double sink = 0;
+
+    double start = now();
+    for (int r = 0; r < NUMBER_ROUNDS; r++) {
+        for (int i = 0; i < numbers->count; i++)
+            sink += strtod(numbers->src + numbers->values[i], NULL);
+    }
+    double elapsed = now() - start;
+
+    (void) sink;
+    return elapsed * 1e9 / ((double) numbers->count * NUMBER_ROUNDS);
+}
+
+static double
+time_read_double(Numbers *numbers)
+{
+    volatile double sink = 0;
+
+    double start = now();
+    for (int r = 0; r < NUMBER_ROUNDS; r++) {
+        for (int i = 0; i < numbers->count; i++) {
+            double number = 0;
+            cfg_read_double(numbers->src + numbers->values[i], 32, &number);
+            sink += number;
+        }
+    }
+    double elapsed = now() - start;
+
+    (void) sink;
+    return elapsed * 1e9 / ((double) numbers->count * NUMBER_ROUNDS);
+}
+
+static int
+count_mismatches(Numbers *numbers)
+{
+    int mismatches = 0;
+    for (int i = 0; i < numbers->count; i++) {
+        const char *value = numbers->src + numbers->values[i];
+        float number = 0, expected = strtof(value, NULL);
+        cfg_read_float(value, 32, &number);
+        mismatches += memcmp(&number, &expected, sizeof(number)) != 0;
+    }
+    return mismatches;
+}
+
+void
+run_number_bench(FILE *stream)
+{
+    int len;
+    char *src = generate_number_config(NUMBER_ENTRIES, &len);
+    int *values = malloc(NUMBER_ENTRIES * sizeof(int));
+    CfgEntry *entries = malloc(NUMBER_ENTRIES * sizeof(CfgEntry));
+    if (src == NULL || values == NULL || entries == NULL) {
+        fprintf(stderr, "Error: memory allocation failed\n");
+        goto cleanup;
+    }
+
+    // The source is NUL-terminated and every value ends with a newline, so
+    // reading 32 characters past the start of a value is safe
+    Numbers numbers = {.src = src, .values = values};
+    for (const char *p = src; (p = strstr(p, ": ")) != NULL; p += 2)
+        values[numbers.count++] = p + 2 - src;
+
+    if (count_mismatches(&numbers) != 0)
+        fprintf(stderr, "Error: cfg_read_float() differs from strtof()\n");
+
+    fprintf(stream, "Numbers (ns per number, %d numbers)\n", numbers.count);
+    fprintf(stream, "%12s %10s\n", "method", "ns/number");
+    fprintf(stream, "%12s %10.1f\n", "strtof", time_strtof(&numbers));
+    fprintf(stream, "%12s %10.1f\n", "read_float", time_read_float(&numbers));
+    fprintf(stream, "%12s %10.1f\n", "strtod", time_strtod(&numbers));
+    fprintf(stream, "%12s %10.1f\n", "read_double",
+            time_read_double(&numbers));
+
+    CfgError err;
+    Cfg cfg = {.entries = entries, .capacity = NUMBER_ENTRIES};
+
+    double start = now();
+    for (int r = 0; r < NUMBER_ROUNDS; r++) {
+        if (cfg_parse(src, len, &cfg, &err) != 0) {
+            cfg_fprint_error(stderr, &err);
+            goto cleanup;
+        }
+    }
+    double elapsed = (now() - start) / NUMBER_ROUNDS;
+
+    fprintf(stream, "Numbers config (%.1f MB): %.1f MB/s\n",
+            (double) len / (1 << 20), (double) len / (1 << 20) / elapsed);
+
+cleanup:
+    free(entries);
+    free(values);
+    free(src);
+}
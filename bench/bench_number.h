@@ -0,0 +1,8 @@
+#ifndef BENCH_NUMBER_H
+#define BENCH_NUMBER_H
+
+#include "utils.h"
+
+void run_number_bench(FILE *stream);
+
+#endif
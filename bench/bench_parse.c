@@ -0,0 +1,104 @@
+#include <stdlib.h>
+
+#include "../config.h"
+#include "bench_parse.h"
+
+#define PARSE_ENTRIES 200000
+#define PARSE_ROUNDS 10
+
+static void
+bench_source(FILE *stream, const char *name, char *src, int len)
+{
+    CfgEntry *entries = malloc(PARSE_ENTRIES * sizeof(CfgEntry));
+    CfgViewEntry *views = malloc(PARSE_ENTRIES * sizeof(CfgViewEntry));
+    if (src == NULL || entries == NULL || views == NULL) {
+        fprintf(stderr, "Error: memory allocation failed\n");
+        goto out;
+    }
+
+    CfgError err;
+    Cfg cfg = {.entries = entries, .capacity = PARSE_ENTRIES};
+    CfgView view = {.entries = views, .capacity = PARSE_ENTRIES};
+
+    double start = now();
+    for (int i = 0; i < PARSE_ROUNDS; i++) {
+        if (cfg_parse(src, len, &cfg, &err) != 0) {
+            cfg_fprint_error(stderr, &err);
+            goto out;
+        }
+    }
+    double copy = now() - start;
+
+    start = now();
+    for (int i = 0; i < PARSE_ROUNDS; i++) {
+        if (cfg_parse_view(src, len, &view, &err) != 0) {
+            cfg_fprint_error(stderr, &err);
+            goto out;
+        }
+    }
+    double slice = now() - start;
+
+    double mb = (double) len * PARSE_ROUNDS / (1 << 20);
+    fprintf(stream, "%8s %8.1f %10.1f %10.1f\n", name,
+            (double) len / (1 << 20), mb / copy, mb / slice);
+
+out:
+    free(views);
+    free(entries);
+    free(src);
+}
+
+void
+run_parse_bench(FILE *stream)
+{
+    int len;
+    char *src;
+
+    fprintf(stream, "Parse (MB/s, %d entries)\n", PARSE_ENTRIES);
+    fprintf(stream, "%8s %8s %10s %10s\n", "source", "MB", "copy", "view");
+
+    src = generate_mixed_config(PARSE_ENTRIES, &len);
+    bench_source(stream, "mixed", src, len);
+
+    src = generate_text_config(PARSE_ENTRIES, &len);
+    bench_source(stream, "text", src, len);
+}
+
+void
+run_parallel_bench(FILE *stream)
+{
+    static const int threads[] = {1, 2, 4, 8};
+
+    int len;
+    char *src = generate_text_config(PARSE_ENTRIES, &len);
+    CfgEntry *entries = malloc(PARSE_ENTRIES * sizeof(CfgEntry));
+    if (src == NULL || entries == NULL) {
+        fprintf(stderr, "Error: memory allocation failed\n");
+        goto out;
+    }
+
+    fprintf(stream, "Parallel parse (MB/s, %.1f MB)\n",
+            (double) len / (1 << 20));
+    fprintf(stream, "%8s %10s\n", "threads", "MB/s");
+
+    for (int i = 0; i < (int) COUNT_OF(threads); i++) {
+        CfgError err;
+        Cfg cfg = {.entries = entries, .capacity = PARSE_ENTRIES};
+
+        double start = now();
+        for (int j = 0; j < PARSE_ROUNDS; j++) {
+            if (cfg_parse_parallel(src, len, &cfg, threads[i], &err) != 0) {
+                cfg_fprint_error(stderr, &err);
+                goto out;
+            }
+        }
+        double elapsed = now() - start;
+
+        double mb = (double) len * PARSE_ROUNDS / (1 << 20);
+        fprintf(stream, "%8d %10.1f\n", threads[i], mb / elapsed);
+    }
+
+out:
+    free(entries);
+    free(src);
+}
@@ -0,0 +1,9 @@
+#ifndef BENCH_PARSE_H
+#define BENCH_PARSE_H
+
+#include "utils.h"
+
+void run_parse_bench(FILE *stream);
+void run_parallel_bench(FILE *stream);
+
+#endif
@@ -0,0 +1,98 @@
+#include <stdlib.h>
+
+#include "../config.h"
+#include "bench_prefix.h"
+
+static void
+visit(const char *key, CfgValType type, const void *val, void *user)
+{
+    (void) key;
+    (void) type;
+    *(long *) user += *(const int *) val;
+}
+
+static double
+time_iter(Cfg *cfg, const char *prefix, int iters)
+{
+    long sum = 0;
+
+    double start = now();
+    for (int i = 0; i < iters; i++)
+        cfg_iter_prefix(cfg, prefix, visit, &sum);
+    double elapsed = now() - start;
+
+    volatile long sink = sum;
+    (void) sink;
+    return elapsed * 1e6 / iters;
+}
+
+static double
+time_parse(const char *src, int len, Cfg *cfg)
+{
+    CfgError err;
+
+    double start = now();
+    if (cfg_parse(src, len, cfg, &err) != 0)
+        cfg_fprint_error(stderr, &err);
+    return (now() - start) * 1e3;
+}
+
+static void
+bench_size(FILE *stream, int count)
+{
+    int len;
+    char *src = generate_config(count, &len);
+    CfgEntry *entries = malloc(count * sizeof(CfgEntry));
+    CfgSlot *slots = malloc(CFG_INDEX_CAPACITY(count) * sizeof(CfgSlot));
+    int *sorted = malloc(CFG_SORTED_CAPACITY(count) * sizeof(int));
+    if (src == NULL || entries == NULL || slots == NULL || sorted == NULL) {
+        fprintf(stderr, "Error: memory allocation failed\n");
+        goto out;
+    }
+
+    Cfg cfg = {
+        .entries = entries,
+        .capacity = count,
+        .index = {.slots = slots, .capacity = CFG_INDEX_CAPACITY(count)},
+    };
+    double plain = time_parse(src, len, &cfg);
+
+    cfg.sorted = (CfgSorted){
+        .entries = sorted,
+        .capacity = CFG_SORTED_CAPACITY(count),
+    };
+    double with_sorted = time_parse(src, len, &cfg);
+
+    // Keys are "k." followed by the number in base 26, lowest digit first
+    const char *prefix = "k.ab";
+    int matches = cfg_count_prefix(&cfg, prefix);
+    double indexed = time_iter(&cfg, prefix, 10000);
+
+    // Scanning checks every match against the hash index
+    cfg.sorted.count = 0;
+    int iters = 10000000 / count;
+    if (iters > 10000)
+        iters = 10000;
+    double scan = time_iter(&cfg, prefix, iters);
+
+    fprintf(stream, "%8d %8d %10.2f %10.2f %10.2f %10.2f\n", count, matches,
+            plain, with_sorted, indexed, scan);
+
+out:
+    free(sorted);
+    free(slots);
+    free(entries);
+    free(src);
+}
+
+void
+run_prefix_bench(FILE *stream)
+{
+    static const int sizes[] = {100, 1000, 10000, 100000};
+
+    fprintf(stream, "Prefix (parse ms, us per cfg_iter_prefix)\n");
+    fprintf(stream, "%8s %8s %10s %10s %10s %10s\n", "entries", "matches",
+            "parse", "sorted", "indexed", "scan");
+    for (int i = 0; i < (int) COUNT_OF(sizes); i++)
+        bench_size(stream, sizes[i]);
+}
@@ -0,0 +1,8 @@
+#ifndef BENCH_PREFIX_H
+#define BENCH_PREFIX_H
+
+#include "utils.h"
+
+void run_prefix_bench(FILE *stream);
+
+#endif
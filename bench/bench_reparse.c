@@ -0,0 +1,126 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "../config.h"
+#include "bench_reparse.h"
+
+// Copies the source with 'line' inserted at the start of the middle line or,
+// if 'replace' is set, in place of it
+static char *
+edit_config(const char *src, int len, const char *line, bool replace,
+            int *new_len)
+{
+    const char *mid = strchr(src + len / 2, '\n') + 1;
+    const char *rest = replace ? strchr(mid, '\n') + 1 : mid;
+
+    int line_len = strlen(line);
+    char *dst = malloc(len + line_len + 1);
+    if (dst == NULL)
+        return NULL;
+
+    int head = mid - src;
+    memcpy(dst, src, head);
+    memcpy(dst + head, line, line_len);
+    memcpy(dst + head + line_len, rest, len - (rest - src));
+    *new_len = head + line_len + len - (rest - src);
+    return dst;
+}
+
+static double
+time_parse(const char *src, int len, Cfg *cfg, int iters)
+{
+    CfgError err;
+
+    double start = now();
+    for (int i = 0; i < iters; i++) {
+        if (cfg_parse(src, len, cfg, &err) != 0)
+            cfg_fprint_error(stderr, &err);
+    }
+    return (now() - start) * 1e6 / iters;
+}
+
+// Goes back and forth between the two versions
+static double
+time_reparse(const char *a, int a_len, const char *b, int b_len, Cfg *cfg,
+             int iters)
+{
+    CfgError err;
+
+    double start = now();
+    for (int i = 0; i < iters; i++) {
+        const char *old = i % 2 ? b : a;
+        const char *new = i % 2 ? a : b;
+        int old_len = i % 2 ? b_len : a_len;
+        int new_len = i % 2 ? a_len : b_len;
+        if (cfg_reparse_incremental(cfg, old, old_len, new, new_len, NULL,
+                                    NULL, &err) != 0)
+            cfg_fprint_error(stderr, &err);
+    }
+    return (now() - start) * 1e6 / iters;
+}
+
+static void
+bench_size(FILE *stream, int count)
+{
+    int len, value_len, insert_len;
+    char *value = NULL;
+    char *insert = NULL;
+    char *src = generate_config(count, &len);
+
+    // A full Cfg may be missing the last lines, which forces a full parse
+    int capacity = count + 16;
+    CfgEntry *entries = malloc(capacity * sizeof(CfgEntry));
+    CfgSlot *slots = malloc(CFG_INDEX_CAPACITY(capacity) * sizeof(CfgSlot));
+    if (src != NULL) {
+        // The value edit keeps the key of the line it replaces
+        char line[64];
+        const char *mid = strchr(src + len / 2, '\n') + 1;
+        snprintf(line, sizeof(line), "%.*s: -1\n",
+                 (int) (strchr(mid, ':') - mid), mid);
+        value = edit_config(src, len, line, true, &value_len);
+        insert = edit_config(src, len, "k.x: -1\n", false, &insert_len);
+    }
+    if (value == NULL || insert == NULL || entries == NULL || slots == NULL) {
+        fprintf(stderr, "Error: memory allocation failed\n");
+        goto out;
+    }
+
+    Cfg cfg = {
+        .entries = entries,
+        .capacity = capacity,
+        .index = {.slots = slots, .capacity = CFG_INDEX_CAPACITY(capacity)},
+    };
+
+    int iters = 10000000 / count;
+    if (iters > 10000)
+        iters = 10000;
+
+    double full = time_parse(value, value_len, &cfg, iters / 10 + 1);
+    time_parse(src, len, &cfg, 1);
+    double same_keys = time_reparse(src, len, value, value_len, &cfg, iters);
+    time_parse(src, len, &cfg, 1);
+    double inserted = time_reparse(src, len, insert, insert_len, &cfg,
+                                   iters / 10 + 1);
+
+    fprintf(stream, "%8d %10.2f %10.2f %10.2f\n", count, full, same_keys,
+            inserted);
+
+out:
+    free(slots);
+    free(entries);
+    free(insert);
+    free(value);
+    free(src);
+}
+
+void
+run_reparse_bench(FILE *stream)
+{
+    static const int sizes[] = {100, 1000, 10000, 100000};
+
+    fprintf(stream, "Reparse (us per edit of the middle line)\n");
+    fprintf(stream, "%8s %10s %10s %10s\n", "entries", "parse", "value",
+            "insert");
+    for (int i = 0; i < (int) COUNT_OF(sizes); i++)
+        bench_size(stream, sizes[i]);
+}
@@ -0,0 +1,8 @@
+#ifndef BENCH_REPARSE_H
+#define BENCH_REPARSE_H
+
+#include "utils.h"
+
+void run_reparse_bench(FILE *stream);
+
+#endif
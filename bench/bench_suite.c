@@ -0,0 +1,229 @@
+#include <stdlib.h>
+#include <sys/resource.h>
+
+#include "../config.h"
+#include "bench_suite.h"
+
+#define SUITE_KEYS 4096
+#define SUITE_LOOKUPS 2000000
+#define SUITE_BYTES (64 << 20)
+
+typedef struct {
+    char key[40];
+    GenType type;
+} Lookup;
+
+typedef struct {
+    Lookup *keys;
+    int count;
+} Lookups;
+
+static const char *const type_names[] = {
+    "string", "bool", "int", "float", "color",
+};
+
+// Best of several rounds, as MB/s
+static double
+time_parse(const char *src, int len, Cfg *cfg)
+{
+    CfgError err;
+
+    int rounds = SUITE_BYTES / (len + 1);
+    if (rounds < 3)
+        rounds = 3;
+    if (rounds > 100)
+        rounds = 100;
+
+    double best = 1e9;
+    for (int i = 0; i < rounds; i++) {
+        double start = now();
+        if (cfg_parse(src, len, cfg, &err) != 0) {
+            cfg_fprint_error(stderr, &err);
+            return 0;
+        }
+        double elapsed = now() - start;
+        if (elapsed < best)
+            best = elapsed;
+    }
+    return len / (1024.0 * 1024.0) / best;
+}
+
+// Lookups per second
+static double
+time_lookups(Cfg *cfg, Lookups *lookups, int iters)
+{
+    if (lookups->count == 0)
+        return 0;
+
+    static char fallback[] = "";
+    volatile long sink = 0;
+
+    double start = now();
+    for (int i = 0; i < iters; i++) {
+        Lookup *l = &lookups->keys[i % lookups->count];
+        switch (l->type) {
+        case GEN_STRING:
+            sink += *cfg_get_string(cfg, l->key, fallback);
+            break;
+        case GEN_BOOL:
+            sink += cfg_get_bool(cfg, l->key, false);
+            break;
+        case GEN_INT:
+            sink += cfg_get_int(cfg, l->key, 0);
+            break;
+        case GEN_FLOAT:
+            sink += cfg_get_float(cfg, l->key, 0);
+            break;
+        case GEN_COLOR:
+            sink += cfg_get_color(cfg, l->key, (CfgColor){0}).r;
+            break;
+        default:
+            break;
+        }
+    }
+    return iters / (now() - start);
+}
+
+static void
+add_lookup(Lookups *lookups, const GenOpts *opts, int id)
+{
+    if (lookups->count == SUITE_KEYS)
+        return;
+
+    Lookup *l = &lookups->keys[lookups->count++];
+    gen_key(l->key, opts, id);
+    l->type = gen_type(opts, id);
+}
+
+// Splits the keys into those defined once and those defined several times,
+// the misses being the keys which come after the last one
+static int
+pick_lookups(const GenOpts *opts, const int *ids, Lookups lookups[3])
+{
+    int *defs = calloc(opts->count, sizeof(int));
+    if (defs == NULL)
+        return -1;
+
+    int unique = 0;
+    for (int i = 0; i < opts->count; i++) {
+        defs[ids[i]]++;
+        if (ids[i] + 1 > unique)
+            unique = ids[i] + 1;
+    }
+
+    // Spread them over the whole config
+    int step = unique / SUITE_KEYS + 1;
+    for (int id = 0; id < unique; id++) {
+        if (defs[id] > 1)
+            add_lookup(&lookups[2], opts, id);
+        else if (id % step == 0)
+            add_lookup(&lookups[0], opts, id);
+    }
+    for (int id = unique; id < unique + SUITE_KEYS; id++)
+        add_lookup(&lookups[1], opts, id);
+
+    free(defs);
+    return 0;
+}
+
+static void
+print_lookups(FILE *stream, const char *name, Cfg *cfg, Lookups lookups[3],
+              int iters, bool last)
+{
+    fprintf(stream,
+            "    \"%s\": {\"hit\": %.0f, \"miss\": %.0f, "
+            "\"shadowed\": %.0f}%s\n",
+            name, time_lookups(cfg, &lookups[0], iters),
+            time_lookups(cfg, &lookups[1], iters),
+            time_lookups(cfg, &lookups[2], iters), last ? "" : ",");
+}
+
+int
+run_suite_bench(FILE *stream, const GenOpts *opts)
+{
+    int res = -1;
+    int len;
+    int count = opts->count;
+    int *ids = malloc(count * sizeof(int));
+    char *src = ids ? generate_suite_config(opts, ids, &len) : NULL;
+    CfgEntry *entries = malloc(count * sizeof(CfgEntry));
+    CfgSlot *slots = malloc(CFG_INDEX_CAPACITY(count) * sizeof(CfgSlot));
+    uint64_t *words = malloc(CFG_BLOOM_CAPACITY(count) * sizeof(uint64_t));
+    Lookup *keys = malloc(3 * SUITE_KEYS * sizeof(Lookup));
+    Lookups lookups[3] = {
+        {keys, 0},
+        {keys + SUITE_KEYS, 0},
+        {keys + 2 * SUITE_KEYS, 0},
+    };
+    if (src == NULL || entries == NULL || slots == NULL || words == NULL ||
+        keys == NULL || pick_lookups(opts, ids, lookups) != 0) {
+        fprintf(stderr, "Error: memory allocation failed\n");
+        goto out;
+    }
+
+    Cfg cfg = {.entries = entries, .capacity = count};
+    double plain = time_parse(src, len, &cfg);
+
+    cfg.index = (CfgIndex){
+        .slots = slots,
+        .capacity = CFG_INDEX_CAPACITY(count),
+    };
+    double indexed = time_parse(src, len, &cfg);
+    if (plain == 0 || indexed == 0)
+        goto out;
+
+    fprintf(stream, "{\n  \"config\": {\n");
+    fprintf(stream, "    \"entries\": %d,\n    \"bytes\": %d,\n", count, len);
+    fprintf(stream, "    \"seed\": %u,\n    \"mix\": {", opts->seed);
+    for (int i = 0; i < GEN_TYPES; i++)
+        fprintf(stream, "%s\"%s\": %d", i ? ", " : "", type_names[i],
+                opts->mix[i]);
+    fprintf(stream, "},\n");
+    fprintf(stream,
+            "    \"comments\": %d,\n    \"long_keys\": %d,\n"
+            "    \"shadowed\": %d\n  },\n",
+            opts->comments, opts->long_keys, opts->shadowed);
+
+    fprintf(stream, "  \"parse\": {\n");
+    fprintf(stream, "    \"mb_per_s\": %.1f,\n", plain);
+    fprintf(stream, "    \"indexed_mb_per_s\": %.1f\n  },\n", indexed);
+
+    // Lookups per second, the linear scan taking fewer of them
+    int linear = SUITE_LOOKUPS / (count / 64 + 1);
+    if (linear < 100)
+        linear = 100;
+
+    fprintf(stream, "  \"lookups_per_s\": {\n");
+    print_lookups(stream, "indexed", &cfg, lookups, SUITE_LOOKUPS, false);
+    cfg.index.size = 0;
+    print_lookups(stream, "linear", &cfg, lookups, linear, false);
+
+    // The Bloom filter lets most misses skip the scan
+    cfg.index = (CfgIndex){0};
+    cfg.bloom = (CfgBloom){
+        .words = words,
+        .capacity = CFG_BLOOM_CAPACITY(count),
+    };
+    if (time_parse(src, len, &cfg) == 0)
+        goto out;
+    print_lookups(stream, "linear_bloom", &cfg, lookups, linear, true);
+    fprintf(stream, "  },\n");
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    size_t bytes = count * sizeof(CfgEntry) +
+                   CFG_INDEX_CAPACITY(count) * sizeof(CfgSlot);
+    fprintf(stream, "  \"memory\": {\n");
+    fprintf(stream, "    \"cfg_bytes\": %zu,\n", bytes);
+    fprintf(stream, "    \"peak_rss_kb\": %ld\n  }\n}\n", usage.ru_maxrss);
+    res = 0;
+
+out:
+    free(keys);
+    free(words);
+    free(slots);
+    free(entries);
+    free(src);
+    free(ids);
+    return res;
+}
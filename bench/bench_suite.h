@@ -0,0 +1,9 @@
+#ifndef BENCH_SUITE_H
+#define BENCH_SUITE_H
+
+#include "utils.h"
+
+// Parse and lookup speed and memory on a generated config, as JSON
+int run_suite_bench(FILE *stream, const GenOpts *opts);
+
+#endif
@@ -0,0 +1,262 @@
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "utils.h"
+
+double
+now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void
+make_key(char *dst, int n)
+{
+    // Keys can only contain letters, dots and underscores,
+    // so the number is written in base 26
+    *dst++ = 'k';
+    *dst++ = '.';
+    do {
+        *dst++ = 'a' + n % 26;
+        n /= 26;
+    } while (n > 0);
+    *dst = '\0';
+}
+
+char *
+generate_config(int count, int *len)
+{
+    int capacity = count * 32 + 1;
+    char *src = malloc(capacity);
+    if (src == NULL)
+        return NULL;
+
+    int off = 0;
+    for (int i = 0; i < count; i++) {
+        char key[16];
+        make_key(key, i);
+        off += snprintf(src + off, capacity - off, "%s: %d\n", key, i);
+    }
+
+    *len = off;
+    return src;
+}
+
+char *
+generate_mixed_config(int count, int *len)
+{
+    int capacity = count * 64 + 1;
+    char *src = malloc(capacity);
+    if (src == NULL)
+        return NULL;
+
+    int off = 0;
+    for (int i = 0; i < count; i++) {
+        char key[16];
+        make_key(key, i);
+        off += snprintf(src + off, capacity - off, "%s: ", key);
+
+        switch (i % 5) {
+        case 0:
+            off += snprintf(src + off, capacity - off, "%d\n", i);
+            break;
+        case 1:
+            off += snprintf(src + off, capacity - off,
+                            "\"value number %d\" # comment\n", i);
+            break;
+        case 2:
+            off += snprintf(src + off, capacity - off, "%d.%d\n", i, i % 7);
+            break;
+        case 3:
+            off += snprintf(src + off, capacity - off, "%s\n",
+                            i % 2 ? "true" : "false");
+            break;
+        case 4:
+            off += snprintf(src + off, capacity - off,
+                            "rgba(%d, %d, %d, 0.5)\n", i % 256, (i / 2) % 256,
+                            (i / 3) % 256);
+            break;
+        }
+    }
+
+    *len = off;
+    return src;
+}
+
+char *
+generate_text_config(int count, int *len)
+{
+    // Long strings, comments and indentation
+    int capacity = count * 192 + 1;
+    char *src = malloc(capacity);
+    if (src == NULL)
+        return NULL;
+
+    int off = 0;
+    for (int i = 0; i < count; i++) {
+        char key[16];
+        make_key(key, i);
+        off += snprintf(src + off, capacity - off,
+                        "# Generated setting number %d, do not edit by hand\n"
+                        "        %s:    \"/usr/share/generated/files/"
+                        "settings/entry-%08d.dat\"    # Path\n",
+                        i, key, i);
+    }
+
+    *len = off;
+    return src;
+}
+
+char *
+generate_number_config(int count, int *len)
+{
+    // Floats with short, typical and full precision fractions and integers
+    int capacity = count * 64 + 1;
+    char *src = malloc(capacity);
+    if (src == NULL)
+        return NULL;
+
+    unsigned seed = 1;
+    int off = 0;
+    for (int i = 0; i < count; i++) {
+        char key[16];
+        make_key(key, i);
+        off += snprintf(src + off, capacity - off, "%s: ", key);
+
+        seed = seed * 1103515245 + 12345;
+        unsigned r = seed >> 8;
+        switch (i % 4) {
+        case 0:
+            off += snprintf(src + off, capacity - off, "%u.%u\n", r % 100,
+                            r % 10);
+            break;
+        case 1:
+            off += snprintf(src + off, capacity - off, "%u.%06u\n", r % 10000,
+                            r % 1000000);
+            break;
+        case 2:
+            off += snprintf(src + off, capacity - off, "-0.%09u%08u\n", r,
+                            r * 7 % 100000000);
+            break;
+        case 3:
+            off += snprintf(src + off, capacity - off, "%u\n", r);
+            break;
+        }
+    }
+
+    *len = off;
+    return src;
+}
+
+// Stateless hash of a number, so that the key and type of an entry only
+// depend on its id
+static unsigned
+mix(unsigned seed, unsigned n)
+{
+    unsigned x = seed ^ (n * 0x9e3779b9u);
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+void
+gen_key(char *dst, const GenOpts *opts, int id)
+{
+    make_key(dst, id);
+
+    // Long keys are padded up to the maximum length of 32 characters
+    if ((int) (mix(opts->seed + 1, id) % 100) < opts->long_keys) {
+        int len = strlen(dst);
+        dst[len++] = '_';
+        for (; len < 32; len++)
+            dst[len] = 'a' + len % 26;
+        dst[len] = '\0';
+    }
+}
+
+GenType
+gen_type(const GenOpts *opts, int id)
+{
+    int total = 0;
+    for (int i = 0; i < GEN_TYPES; i++)
+        total += opts->mix[i];
+    if (total == 0)
+        return GEN_INT;
+
+    int r = mix(opts->seed + 2, id) % total;
+    int type = 0;
+    while (r >= opts->mix[type])
+        r -= opts->mix[type++];
+    return type;
+}
+
+char *
+generate_suite_config(const GenOpts *opts, int *ids, int *len)
+{
+    int capacity = opts->count * 192 + 1;
+    char *src = malloc(capacity);
+    if (src == NULL)
+        return NULL;
+
+    unsigned state = opts->seed | 1;
+    int unique = 0;
+    int off = 0;
+    for (int i = 0; i < opts->count; i++) {
+        // Xorshift, for the choices which depend on the order of the entries
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        unsigned r = state;
+
+        int id = unique > 0 && (int) (r % 100) < opts->shadowed
+                     ? (int) (r / 100 % unique)
+                     : unique++;
+        if (ids != NULL)
+            ids[i] = id;
+
+        if ((int) (r / 7 % 100) < opts->comments)
+            off += snprintf(src + off, capacity - off,
+                            "# Setting %d, generated\n", id);
+
+        char key[40];
+        gen_key(key, opts, id);
+        off += snprintf(src + off, capacity - off, "%s: ", key);
+
+        unsigned v = mix(opts->seed + 3, i);
+        switch (gen_type(opts, id)) {
+        case GEN_STRING:
+            off += snprintf(src + off, capacity - off, "\"%.*s %u\"\n",
+                            (int) (v % 48), "/usr/share/generated/settings/"
+                            "values/entry.dat", v);
+            break;
+        case GEN_BOOL:
+            off += snprintf(src + off, capacity - off, "%s\n",
+                            v % 2 ? "true" : "false");
+            break;
+        case GEN_INT:
+            off += snprintf(src + off, capacity - off, "%d\n",
+                            (int) (v % 2000001) - 1000000);
+            break;
+        case GEN_FLOAT:
+            off += snprintf(src + off, capacity - off, "%d.%03u\n",
+                            (int) (v % 2001) - 1000, v / 2001 % 1000);
+            break;
+        case GEN_COLOR:
+            off += snprintf(src + off, capacity - off,
+                            "rgba(%u, %u, %u, 0.%02u)\n", v % 256,
+                            v / 256 % 256, v / 65536 % 256, v / 7 % 100);
+            break;
+        default:
+            break;
+        }
+    }
+
+    *len = off;
+    return src;
+}
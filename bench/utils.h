@@ -0,0 +1,43 @@
+#ifndef BENCH_UTILS_H
+#define BENCH_UTILS_H
+
+#include <stdio.h>
+
+#define COUNT_OF(X) (sizeof(X) / sizeof((X)[0]))
+
+double now(void);
+
+void make_key(char *dst, int n);
+char *generate_config(int count, int *len);
+char *generate_mixed_config(int count, int *len);
+char *generate_text_config(int count, int *len);
+char *generate_number_config(int count, int *len);
+
+typedef enum {
+    GEN_STRING,
+    GEN_BOOL,
+    GEN_INT,
+    GEN_FLOAT,
+    GEN_COLOR,
+    GEN_TYPES,
+} GenType;
+
+// Shape of a generated config. The types are mixed by relative weights, the
+// other fields are percentages of the entries.
+typedef struct {
+    int count;
+    unsigned seed;
+    int mix[GEN_TYPES];
+    int comments;
+    int long_keys;
+    int shadowed;
+} GenOpts;
+
+void gen_key(char *dst, const GenOpts *opts, int id);
+GenType gen_type(const GenOpts *opts, int id);
+
+// Same options, same config. The ids of the keys of the entries are stored
+// in 'ids' if it isn't NULL, shadowed entries reuse the id of an earlier one.
+char *generate_suite_config(const GenOpts *opts, int *ids, int *len);
+
+#endif
@@ -1,17 +1,57 @@
 #include <assert.h>
-#include <ctype.h>
+#include <float.h>
 #include <limits.h>
+#include <pthread.h>
+#include <sched.h>
 #include <stdarg.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "config.h"
 
+#if defined(__unix__) && !defined(CFG_NO_MMAP)
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CFG_MMAP
+#endif
+
+#ifdef __linux__
+#include <errno.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#define CFG_INOTIFY
+#endif
+
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(CFG_NO_SIMD)
+#include <immintrin.h>
+#define CFG_SIMD_X86
+#endif
+
+// Code which only exists to fill CfgStats
+#ifdef CFG_STATS
+#include <time.h>
+#define STAT(...) __VA_ARGS__
+#else
+#define STAT(...)
+#endif
+
 typedef struct {
     const char *src;
     int len;
     int cur;
+    int row;
+    int line;  // Offset of the current row
+    int max_key;
+    int max_val;
+#ifdef CFG_STATS
+    int comments;  // Bytes of comments skipped
+#endif
 } Scanner;
 
 static void
@@ -20,6 +60,11 @@ init_scanner(Scanner *s, const char *src, int src_len)
     s->src = src;
     s->len = src_len;
     s->cur = 0;
+    s->row = 1;
+    s->line = 0;
+    s->max_key = CFG_MAX_KEY;
+    s->max_val = CFG_MAX_VAL;
+    STAT(s->comments = 0);
 }
 
 static bool
@@ -69,33 +114,299 @@ advance2(Scanner *s, int n)
 }
 
 static void
-skip_whitespace(Scanner *s)
+advance_line(Scanner *s)
 {
-    while (!is_at_end(s) && isspace(peek(s)))
-        advance(s);
+    // Consume '\n'
+    s->cur++;
+    s->row++;
+    s->line = s->cur;
+}
+
+// Character classes of the grammar, independent of the current locale
+#define CC_ALPHA 0x01   // 'a' ... 'z' | 'A' ... 'Z'
+#define CC_DIGIT 0x02   // '0' ... '9'
+#define CC_KEY 0x04     // alpha | '.' | '_'
+#define CC_STRING 0x08  // alpha | digit | punct | blank, except '"'
+#define CC_BLANK 0x10   // ' ' | '\t' | '\v' | '\f' | '\r'
+#define CC_SPACE 0x20   // blank | '\n'
+
+static const uint8_t char_class[256] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 0x00
+    0x00, 0x38, 0x20, 0x30, 0x30, 0x30, 0x00, 0x00,  // 0x08
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 0x10
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 0x18
+    0x38, 0x08, 0x00, 0x08, 0x08, 0x08, 0x08, 0x08,  // 0x20
+    0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0C, 0x08,  // 0x28
+    0x0A, 0x0A, 0x0A, 0x0A, 0x0A, 0x0A, 0x0A, 0x0A,  // 0x30
+    0x0A, 0x0A, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08,  // 0x38
+    0x08, 0x0D, 0x0D, 0x0D, 0x0D, 0x0D, 0x0D, 0x0D,  // 0x40
+    0x0D, 0x0D, 0x0D, 0x0D, 0x0D, 0x0D, 0x0D, 0x0D,  // 0x48
+    0x0D, 0x0D, 0x0D, 0x0D, 0x0D, 0x0D, 0x0D, 0x0D,  // 0x50
+    0x0D, 0x0D, 0x0D, 0x08, 0x08, 0x08, 0x08, 0x0C,  // 0x58
+    0x08, 0x0D, 0x0D, 0x0D, 0x0D, 0x0D, 0x0D, 0x0D,  // 0x60
+    0x0D, 0x0D, 0x0D, 0x0D, 0x0D, 0x0D, 0x0D, 0x0D,  // 0x68
+    0x0D, 0x0D, 0x0D, 0x0D, 0x0D, 0x0D, 0x0D, 0x0D,  // 0x70
+    0x0D, 0x0D, 0x0D, 0x08, 0x08, 0x08, 0x08, 0x00,  // 0x78
+    // Bytes from 0x80 to 0xFF have no class
+};
+
+static bool
+has_class(char ch, uint8_t cls)
+{
+    return char_class[(uint8_t) ch] & cls;
+}
+
+static bool
+is_alpha(char ch)
+{
+    return has_class(ch, CC_ALPHA);
+}
+
+static bool
+is_digit(char ch)
+{
+    return has_class(ch, CC_DIGIT);
+}
+
+static bool
+is_key(char ch)
+{
+    return has_class(ch, CC_KEY);
+}
+
+static bool
+is_string(char ch)
+{
+    return has_class(ch, CC_STRING);
+}
+
+static bool
+is_blank(char ch)
+{
+    return has_class(ch, CC_BLANK);
+}
+
+static bool
+is_space(char ch)
+{
+    return has_class(ch, CC_SPACE);
+}
+
+// The scan_* functions return the offset of the first byte at or after
+// 'cur' which ends the run (or 'len'). The x86 versions look at 16 or 32
+// bytes at a time and finish the tail with the scalar loop.
+
+static int
+scan_blank_scalar(const char *src, int cur, int len)
+{
+    while (cur < len && is_blank(src[cur]))
+        cur++;
+    return cur;
+}
+
+static int
+scan_newline_scalar(const char *src, int cur, int len)
+{
+    while (cur < len && src[cur] != '\n')
+        cur++;
+    return cur;
+}
+
+static int
+scan_string_scalar(const char *src, int cur, int len)
+{
+    while (cur < len && is_string(src[cur]))
+        cur++;
+    return cur;
+}
+
+#ifdef CFG_SIMD_X86
+
+static int
+scan_blank_sse2(const char *src, int cur, int len)
+{
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t' - 1);
+    const __m128i cr = _mm_set1_epi8('\r' + 1);
+    const __m128i lf = _mm_set1_epi8('\n');
+
+    for (; cur + 16 <= len; cur += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *) (src + cur));
+        __m128i ctrl = _mm_and_si128(_mm_cmpgt_epi8(v, tab),
+                                     _mm_cmplt_epi8(v, cr));
+        __m128i blank = _mm_or_si128(_mm_cmpeq_epi8(v, space),
+                                     _mm_andnot_si128(_mm_cmpeq_epi8(v, lf),
+                                                      ctrl));
+        int mask = ~_mm_movemask_epi8(blank) & 0xFFFF;
+        if (mask)
+            return cur + __builtin_ctz(mask);
+    }
+    return scan_blank_scalar(src, cur, len);
+}
+
+static int
+scan_newline_sse2(const char *src, int cur, int len)
+{
+    const __m128i lf = _mm_set1_epi8('\n');
+
+    for (; cur + 16 <= len; cur += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *) (src + cur));
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(v, lf));
+        if (mask)
+            return cur + __builtin_ctz(mask);
+    }
+    return scan_newline_scalar(src, cur, len);
+}
+
+static int
+scan_string_sse2(const char *src, int cur, int len)
+{
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i del = _mm_set1_epi8(0x7F);
+    const __m128i quote = _mm_set1_epi8('"');
+
+    for (; cur + 16 <= len; cur += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *) (src + cur));
+        // Signed compare, so bytes >= 0x80 are below ' ' too
+        __m128i ctrl = _mm_andnot_si128(_mm_cmpeq_epi8(v, tab),
+                                        _mm_cmplt_epi8(v, space));
+        __m128i stop = _mm_or_si128(ctrl,
+                                    _mm_or_si128(_mm_cmpeq_epi8(v, del),
+                                                 _mm_cmpeq_epi8(v, quote)));
+        int mask = _mm_movemask_epi8(stop);
+        if (mask)
+            return cur + __builtin_ctz(mask);
+    }
+    return scan_string_scalar(src, cur, len);
+}
+
+__attribute__((target("avx2"))) static int
+scan_blank_avx2(const char *src, int cur, int len)
+{
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t' - 1);
+    const __m256i cr = _mm256_set1_epi8('\r' + 1);
+    const __m256i lf = _mm256_set1_epi8('\n');
+
+    for (; cur + 32 <= len; cur += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *) (src + cur));
+        __m256i ctrl = _mm256_and_si256(_mm256_cmpgt_epi8(v, tab),
+                                        _mm256_cmpgt_epi8(cr, v));
+        __m256i blank = _mm256_or_si256(
+            _mm256_cmpeq_epi8(v, space),
+            _mm256_andnot_si256(_mm256_cmpeq_epi8(v, lf), ctrl));
+        unsigned mask = ~(unsigned) _mm256_movemask_epi8(blank);
+        if (mask)
+            return cur + __builtin_ctz(mask);
+    }
+    return scan_blank_sse2(src, cur, len);
+}
+
+__attribute__((target("avx2"))) static int
+scan_newline_avx2(const char *src, int cur, int len)
+{
+    const __m256i lf = _mm256_set1_epi8('\n');
+
+    for (; cur + 32 <= len; cur += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *) (src + cur));
+        unsigned mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, lf));
+        if (mask)
+            return cur + __builtin_ctz(mask);
+    }
+    return scan_newline_sse2(src, cur, len);
+}
+
+__attribute__((target("avx2"))) static int
+scan_string_avx2(const char *src, int cur, int len)
+{
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i del = _mm256_set1_epi8(0x7F);
+    const __m256i quote = _mm256_set1_epi8('"');
+
+    for (; cur + 32 <= len; cur += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *) (src + cur));
+        __m256i ctrl = _mm256_andnot_si256(_mm256_cmpeq_epi8(v, tab),
+                                           _mm256_cmpgt_epi8(space, v));
+        __m256i stop = _mm256_or_si256(
+            ctrl, _mm256_or_si256(_mm256_cmpeq_epi8(v, del),
+                                  _mm256_cmpeq_epi8(v, quote)));
+        unsigned mask = _mm256_movemask_epi8(stop);
+        if (mask)
+            return cur + __builtin_ctz(mask);
+    }
+    return scan_string_sse2(src, cur, len);
+}
+
+#endif
+
+static int
+scan_blank(const char *src, int cur, int len)
+{
+#ifdef CFG_SIMD_X86
+    if (__builtin_cpu_supports("avx2"))
+        return scan_blank_avx2(src, cur, len);
+    return scan_blank_sse2(src, cur, len);
+#else
+    return scan_blank_scalar(src, cur, len);
+#endif
+}
+
+static int
+scan_newline(const char *src, int cur, int len)
+{
+#ifdef CFG_SIMD_X86
+    if (__builtin_cpu_supports("avx2"))
+        return scan_newline_avx2(src, cur, len);
+    return scan_newline_sse2(src, cur, len);
+#else
+    return scan_newline_scalar(src, cur, len);
+#endif
+}
+
+static int
+scan_string(const char *src, int cur, int len)
+{
+#ifdef CFG_SIMD_X86
+    if (__builtin_cpu_supports("avx2"))
+        return scan_string_avx2(src, cur, len);
+    return scan_string_sse2(src, cur, len);
+#else
+    return scan_string_scalar(src, cur, len);
+#endif
 }
 
 static void
 skip_blank(Scanner *s)
 {
-    while (!is_at_end(s) && isspace(peek(s)) && peek(s) != '\n')
-        advance(s);
+    s->cur = scan_blank(s->src, s->cur, s->len);
+}
+
+static void
+skip_whitespace(Scanner *s)
+{
+    skip_blank(s);
+    while (!is_at_end(s) && peek(s) == '\n') {
+        advance_line(s);
+        skip_blank(s);
+    }
 }
 
 static void
 skip_comment(Scanner *s)
 {
     while (!is_at_end(s) && peek(s) == '#') {
-        do
-            advance(s);
-        while (!is_at_end(s) && peek(s) != '\n');
+        STAT(int start = s->cur);
+        s->cur = scan_newline(s->src, s->cur + 1, s->len);
+        STAT(s->comments += s->cur - start);
     }
 }
 
 void
 skip_whitespace_and_comments(Scanner *s)
 {
-    while (!is_at_end(s) && (isspace(peek(s)) || peek(s) == '#')) {
+    while (!is_at_end(s) && (is_space(peek(s)) || peek(s) == '#')) {
         skip_whitespace(s);
         skip_comment(s);
     }
@@ -127,18 +438,6 @@ consume_literal(Scanner *s, int offset, const char *literal, int len)
     return false;
 }
 
-static bool
-is_key(char ch)
-{
-    return isalpha(ch) || ch == '.' || ch == '_';
-}
-
-static bool
-is_string(char ch)
-{
-    return isalnum(ch) || isblank(ch) || (ispunct(ch) && ch != '"');
-}
-
 static void
 init_error(CfgError *err)
 {
@@ -155,15 +454,8 @@ error(Scanner *s, CfgError *err, const char *fmt, ...)
     const int prefix_len = sizeof(prefix) - 1;
 
     err->off = cur(s);
-    err->row = 1;
-    err->col = 1;
-    for (int i = 0; i < cur(s); i++) {
-        err->col++;
-        if (s->src[i] == '\n') {
-            err->row++;
-            err->col = 1;
-        }
-    }
+    err->row = s->row;
+    err->col = cur(s) - s->line + 1;
 
     va_list vargs;
     va_start(vargs, fmt);
@@ -183,81 +475,1148 @@ cfg_fprint_error(FILE *stream, CfgError *err)
 }
 
 static int
-parse_string(Scanner *s, CfgEntry *entry, CfgError *err)
+parse_string(Scanner *s, CfgViewEntry *entry, CfgError *err)
 {
     // Consume opening '"'
     advance(s);
 
     // Consume string
     int val_offset = cur(s);
-    while (!is_at_end(s) && is_string(peek(s)))
-        advance(s);
+    s->cur = scan_string(s->src, s->cur, s->len);
 
     if (is_at_end(s) || peek(s) != '"')
         return error(s, err, "closing '\"' expected");
 
     int val_len = cur(s) - val_offset;
-    if (val_len > CFG_MAX_VAL)
+    if (val_len > s->max_val)
         return error(s, err, "value too long");
 
     // Consume closing '"'
     advance(s);
 
-    copy_slice_into(s, val_offset, val_len, entry->val.string,
-                    sizeof(entry->val.string));
+    entry->val.string = (CfgSlice){.off = val_offset, .len = val_len};
     entry->type = CFG_TYPE_STRING;
     return 0;
 }
 
+// Digits of a decimal number, without its sign. Only the first 19
+// significant digits fit the mantissa, the exponent accounts for the others.
+typedef struct {
+    uint64_t mantissa;
+    int exponent;  // Power of ten of the last digit of the mantissa
+    int digits;    // Digits in the mantissa, including inner zeros
+    bool truncated;  // Non-zero digits were left out of the mantissa
+    int start;       // Offset of the first digit
+    int end;         // Offset past the last digit
+} Decimal;
+
+#define MANTISSA_DIGITS 19
+
+static bool
+is_eight_digits(uint64_t chunk)
+{
+    return !(((chunk + 0x4646464646464646) | (chunk - 0x3030303030303030)) &
+             0x8080808080808080);
+}
+
+// Converts 8 digits at once: each step merges pairs of adjacent numbers,
+// from 8 of 1 digit to 4 of 2 digits and then to the final one
+static uint32_t
+parse_eight_digits(uint64_t chunk)
+{
+    const uint64_t mask = 0x000000FF000000FF;
+    const uint64_t mul1 = 100 + (1000000ULL << 32);
+    const uint64_t mul2 = 1 + (10000ULL << 32);
+
+    chunk -= 0x3030303030303030;
+    chunk = (chunk * 10) + (chunk >> 8);
+    chunk = (((chunk & mask) * mul1) + (((chunk >> 16) & mask) * mul2)) >> 32;
+    return (uint32_t) chunk;
+}
+
+static void
+consume_digits(Scanner *s, Decimal *dec, bool fraction)
+{
+    // Kept in registers, the stores of the loops could alias the source
+    const char *src = s->src;
+    int i = s->cur;
+    uint64_t mantissa = dec->mantissa;
+    int exponent = dec->exponent;
+    int digits = dec->digits;
+    bool truncated = dec->truncated;
+
+    if (digits == 0) {
+        // Leading zeros
+        for (; i < s->len && src[i] == '0'; i++)
+            exponent -= fraction;
+    }
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    for (; s->len - i >= 8 && digits + 8 <= MANTISSA_DIGITS; i += 8) {
+        uint64_t chunk;
+        memcpy(&chunk, src + i, 8);
+        if (!is_eight_digits(chunk))
+            break;
+
+        mantissa = mantissa * 100000000 + parse_eight_digits(chunk);
+        digits += 8;
+        exponent -= fraction ? 8 : 0;
+    }
+#endif
+
+    for (; i < s->len && is_digit(src[i]); i++) {
+        int digit = src[i] - '0';
+
+        if (digits < MANTISSA_DIGITS) {
+            mantissa = mantissa * 10 + digit;
+            digits++;
+            exponent -= fraction;
+        } else {
+            truncated |= digit != 0;
+            exponent += !fraction;
+        }
+    }
+
+    set_cur(s, i);
+    dec->mantissa = mantissa;
+    dec->exponent = exponent;
+    dec->digits = digits;
+    dec->truncated = truncated;
+}
+
 static int
 consume_int(Scanner *s, int *number, CfgError *err)
 {
-    int sign = 1;
-    int num = 0;
+    bool negative = false;
+    Decimal dec = {0};
 
-    if (!is_at_end(s) && peek(s) == '-' && isdigit(peek_next(s))) {
+    if (!is_at_end(s) && peek(s) == '-' && is_digit(peek_next(s))) {
         // Consume '-'
         advance(s);
-        sign = -1;
+        negative = true;
     }
 
-    if (!is_at_end(s) && !isdigit(peek(s)))
+    if (!is_at_end(s) && !is_digit(peek(s)))
         return error(s, err, "number expected");
 
-    while (!is_at_end(s) && isdigit(peek(s))) {
-        int digit = advance(s) - '0';
-        if (num > (INT_MAX - digit) / 10)
-            return error(s, err, "number too large");
+    consume_digits(s, &dec, false);
+
+    uint64_t max = negative ? -(int64_t) INT_MIN : INT_MAX;
+    if (dec.digits + dec.exponent > 10 || dec.mantissa > max)
+        return error(s, err, "number too large");
+
+    *number = negative ? (int) -(int64_t) dec.mantissa : (int) dec.mantissa;
+    return 0;
+}
+
+// Conversion of decimals to the nearest binary floating point number, see
+// "Number Parsing at a Gigabyte per Second" by D. Lemire. The mantissa is
+// multiplied by a 128-bit approximation of the power of ten, which is exact
+// enough to round correctly unless digits were truncated, in which case the
+// result is checked against the exact decimal with big integers.
+typedef struct {
+    int mantissa_bits;
+    int bias;
+    int infinite_power;
+    int min_power;  // Decimals below 10^min_power round to zero
+    int max_power;  // Decimals above 10^max_power round to infinity
+    int min_round_even;
+    int max_round_even;
+} BinaryFormat;
+
+static const BinaryFormat binary32 = {23, 127, 0xFF, -64, 38, -17, 10};
+static const BinaryFormat binary64 = {52, 1023, 0x7FF, -342, 308, -4, 23};
+
+#define POW5_MIN (-342)
+
+// Truncated 128-bit mantissas of the powers of five from 5^-342 to 5^308
+static const uint64_t pow5_128[] = {
+    0xeef453d6923bd65a, 0x113faa2906a13b3f,
+    0x9558b4661b6565f8, 0x4ac7ca59a424c507,
+    0xbaaee17fa23ebf76, 0x5d79bcf00d2df649,
+    0xe95a99df8ace6f53, 0xf4d82c2c107973dc,
+    0x91d8a02bb6c10594, 0x79071b9b8a4be869,
+    0xb64ec836a47146f9, 0x9748e2826cdee284,
+    0xe3e27a444d8d98b7, 0xfd1b1b2308169b25,
+    0x8e6d8c6ab0787f72, 0xfe30f0f5e50e20f7,
+    0xb208ef855c969f4f, 0xbdbd2d335e51a935,
+    0xde8b2b66b3bc4723, 0xad2c788035e61382,
+    0x8b16fb203055ac76, 0x4c3bcb5021afcc31,
+    0xaddcb9e83c6b1793, 0xdf4abe242a1bbf3d,
+    0xd953e8624b85dd78, 0xd71d6dad34a2af0d,
+    0x87d4713d6f33aa6b, 0x8672648c40e5ad68,
+    0xa9c98d8ccb009506, 0x680efdaf511f18c2,
+    0xd43bf0effdc0ba48, 0x0212bd1b2566def2,
+    0x84a57695fe98746d, 0x014bb630f7604b57,
+    0xa5ced43b7e3e9188, 0x419ea3bd35385e2d,
+    0xcf42894a5dce35ea, 0x52064cac828675b9,
+    0x818995ce7aa0e1b2, 0x7343efebd1940993,
+    0xa1ebfb4219491a1f, 0x1014ebe6c5f90bf8,
+    0xca66fa129f9b60a6, 0xd41a26e077774ef6,
+    0xfd00b897478238d0, 0x8920b098955522b4,
+    0x9e20735e8cb16382, 0x55b46e5f5d5535b0,
+    0xc5a890362fddbc62, 0xeb2189f734aa831d,
+    0xf712b443bbd52b7b, 0xa5e9ec7501d523e4,
+    0x9a6bb0aa55653b2d, 0x47b233c92125366e,
+    0xc1069cd4eabe89f8, 0x999ec0bb696e840a,
+    0xf148440a256e2c76, 0xc00670ea43ca250d,
+    0x96cd2a865764dbca, 0x380406926a5e5728,
+    0xbc807527ed3e12bc, 0xc605083704f5ecf2,
+    0xeba09271e88d976b, 0xf7864a44c633682e,
+    0x93445b8731587ea3, 0x7ab3ee6afbe0211d,
+    0xb8157268fdae9e4c, 0x5960ea05bad82964,
+    0xe61acf033d1a45df, 0x6fb92487298e33bd,
+    0x8fd0c16206306bab, 0xa5d3b6d479f8e056,
+    0xb3c4f1ba87bc8696, 0x8f48a4899877186c,
+    0xe0b62e2929aba83c, 0x331acdabfe94de87,
+    0x8c71dcd9ba0b4925, 0x9ff0c08b7f1d0b14,
+    0xaf8e5410288e1b6f, 0x07ecf0ae5ee44dd9,
+    0xdb71e91432b1a24a, 0xc9e82cd9f69d6150,
+    0x892731ac9faf056e, 0xbe311c083a225cd2,
+    0xab70fe17c79ac6ca, 0x6dbd630a48aaf406,
+    0xd64d3d9db981787d, 0x092cbbccdad5b108,
+    0x85f0468293f0eb4e, 0x25bbf56008c58ea5,
+    0xa76c582338ed2621, 0xaf2af2b80af6f24e,
+    0xd1476e2c07286faa, 0x1af5af660db4aee1,
+    0x82cca4db847945ca, 0x50d98d9fc890ed4d,
+    0xa37fce126597973c, 0xe50ff107bab528a0,
+    0xcc5fc196fefd7d0c, 0x1e53ed49a96272c8,
+    0xff77b1fcbebcdc4f, 0x25e8e89c13bb0f7a,
+    0x9faacf3df73609b1, 0x77b191618c54e9ac,
+    0xc795830d75038c1d, 0xd59df5b9ef6a2417,
+    0xf97ae3d0d2446f25, 0x4b0573286b44ad1d,
+    0x9becce62836ac577, 0x4ee367f9430aec32,
+    0xc2e801fb244576d5, 0x229c41f793cda73f,
+    0xf3a20279ed56d48a, 0x6b43527578c1110f,
+    0x9845418c345644d6, 0x830a13896b78aaa9,
+    0xbe5691ef416bd60c, 0x23cc986bc656d553,
+    0xedec366b11c6cb8f, 0x2cbfbe86b7ec8aa8,
+    0x94b3a202eb1c3f39, 0x7bf7d71432f3d6a9,
+    0xb9e08a83a5e34f07, 0xdaf5ccd93fb0cc53,
+    0xe858ad248f5c22c9, 0xd1b3400f8f9cff68,
+    0x91376c36d99995be, 0x23100809b9c21fa1,
+    0xb58547448ffffb2d, 0xabd40a0c2832a78a,
+    0xe2e69915b3fff9f9, 0x16c90c8f323f516c,
+    0x8dd01fad907ffc3b, 0xae3da7d97f6792e3,
+    0xb1442798f49ffb4a, 0x99cd11cfdf41779c,
+    0xdd95317f31c7fa1d, 0x40405643d711d583,
+    0x8a7d3eef7f1cfc52, 0x482835ea666b2572,
+    0xad1c8eab5ee43b66, 0xda3243650005eecf,
+    0xd863b256369d4a40, 0x90bed43e40076a82,
+    0x873e4f75e2224e68, 0x5a7744a6e804a291,
+    0xa90de3535aaae202, 0x711515d0a205cb36,
+    0xd3515c2831559a83, 0x0d5a5b44ca873e03,
+    0x8412d9991ed58091, 0xe858790afe9486c2,
+    0xa5178fff668ae0b6, 0x626e974dbe39a872,
+    0xce5d73ff402d98e3, 0xfb0a3d212dc8128f,
+    0x80fa687f881c7f8e, 0x7ce66634bc9d0b99,
+    0xa139029f6a239f72, 0x1c1fffc1ebc44e80,
+    0xc987434744ac874e, 0xa327ffb266b56220,
+    0xfbe9141915d7a922, 0x4bf1ff9f0062baa8,
+    0x9d71ac8fada6c9b5, 0x6f773fc3603db4a9,
+    0xc4ce17b399107c22, 0xcb550fb4384d21d3,
+    0xf6019da07f549b2b, 0x7e2a53a146606a48,
+    0x99c102844f94e0fb, 0x2eda7444cbfc426d,
+    0xc0314325637a1939, 0xfa911155fefb5308,
+    0xf03d93eebc589f88, 0x793555ab7eba27ca,
+    0x96267c7535b763b5, 0x4bc1558b2f3458de,
+    0xbbb01b9283253ca2, 0x9eb1aaedfb016f16,
+    0xea9c227723ee8bcb, 0x465e15a979c1cadc,
+    0x92a1958a7675175f, 0x0bfacd89ec191ec9,
+    0xb749faed14125d36, 0xcef980ec671f667b,
+    0xe51c79a85916f484, 0x82b7e12780e7401a,
+    0x8f31cc0937ae58d2, 0xd1b2ecb8b0908810,
+    0xb2fe3f0b8599ef07, 0x861fa7e6dcb4aa15,
+    0xdfbdcece67006ac9, 0x67a791e093e1d49a,
+    0x8bd6a141006042bd, 0xe0c8bb2c5c6d24e0,
+    0xaecc49914078536d, 0x58fae9f773886e18,
+    0xda7f5bf590966848, 0xaf39a475506a899e,
+    0x888f99797a5e012d, 0x6d8406c952429603,
+    0xaab37fd7d8f58178, 0xc8e5087ba6d33b83,
+    0xd5605fcdcf32e1d6, 0xfb1e4a9a90880a64,
+    0x855c3be0a17fcd26, 0x5cf2eea09a55067f,
+    0xa6b34ad8c9dfc06f, 0xf42faa48c0ea481e,
+    0xd0601d8efc57b08b, 0xf13b94daf124da26,
+    0x823c12795db6ce57, 0x76c53d08d6b70858,
+    0xa2cb1717b52481ed, 0x54768c4b0c64ca6e,
+    0xcb7ddcdda26da268, 0xa9942f5dcf7dfd09,
+    0xfe5d54150b090b02, 0xd3f93b35435d7c4c,
+    0x9efa548d26e5a6e1, 0xc47bc5014a1a6daf,
+    0xc6b8e9b0709f109a, 0x359ab6419ca1091b,
+    0xf867241c8cc6d4c0, 0xc30163d203c94b62,
+    0x9b407691d7fc44f8, 0x79e0de63425dcf1d,
+    0xc21094364dfb5636, 0x985915fc12f542e4,
+    0xf294b943e17a2bc4, 0x3e6f5b7b17b2939d,
+    0x979cf3ca6cec5b5a, 0xa705992ceecf9c42,
+    0xbd8430bd08277231, 0x50c6ff782a838353,
+    0xece53cec4a314ebd, 0xa4f8bf5635246428,
+    0x940f4613ae5ed136, 0x871b7795e136be99,
+    0xb913179899f68584, 0x28e2557b59846e3f,
+    0xe757dd7ec07426e5, 0x331aeada2fe589cf,
+    0x9096ea6f3848984f, 0x3ff0d2c85def7621,
+    0xb4bca50b065abe63, 0x0fed077a756b53a9,
+    0xe1ebce4dc7f16dfb, 0xd3e8495912c62894,
+    0x8d3360f09cf6e4bd, 0x64712dd7abbbd95c,
+    0xb080392cc4349dec, 0xbd8d794d96aacfb3,
+    0xdca04777f541c567, 0xecf0d7a0fc5583a0,
+    0x89e42caaf9491b60, 0xf41686c49db57244,
+    0xac5d37d5b79b6239, 0x311c2875c522ced5,
+    0xd77485cb25823ac7, 0x7d633293366b828b,
+    0x86a8d39ef77164bc, 0xae5dff9c02033197,
+    0xa8530886b54dbdeb, 0xd9f57f830283fdfc,
+    0xd267caa862a12d66, 0xd072df63c324fd7b,
+    0x8380dea93da4bc60, 0x4247cb9e59f71e6d,
+    0xa46116538d0deb78, 0x52d9be85f074e608,
+    0xcd795be870516656, 0x67902e276c921f8b,
+    0x806bd9714632dff6, 0x00ba1cd8a3db53b6,
+    0xa086cfcd97bf97f3, 0x80e8a40eccd228a4,
+    0xc8a883c0fdaf7df0, 0x6122cd128006b2cd,
+    0xfad2a4b13d1b5d6c, 0x796b805720085f81,
+    0x9cc3a6eec6311a63, 0xcbe3303674053bb0,
+    0xc3f490aa77bd60fc, 0xbedbfc4411068a9c,
+    0xf4f1b4d515acb93b, 0xee92fb5515482d44,
+    0x991711052d8bf3c5, 0x751bdd152d4d1c4a,
+    0xbf5cd54678eef0b6, 0xd262d45a78a0635d,
+    0xef340a98172aace4, 0x86fb897116c87c34,
+    0x9580869f0e7aac0e, 0xd45d35e6ae3d4da0,
+    0xbae0a846d2195712, 0x8974836059cca109,
+    0xe998d258869facd7, 0x2bd1a438703fc94b,
+    0x91ff83775423cc06, 0x7b6306a34627ddcf,
+    0xb67f6455292cbf08, 0x1a3bc84c17b1d542,
+    0xe41f3d6a7377eeca, 0x20caba5f1d9e4a93,
+    0x8e938662882af53e, 0x547eb47b7282ee9c,
+    0xb23867fb2a35b28d, 0xe99e619a4f23aa43,
+    0xdec681f9f4c31f31, 0x6405fa00e2ec94d4,
+    0x8b3c113c38f9f37e, 0xde83bc408dd3dd04,
+    0xae0b158b4738705e, 0x9624ab50b148d445,
+    0xd98ddaee19068c76, 0x3badd624dd9b0957,
+    0x87f8a8d4cfa417c9, 0xe54ca5d70a80e5d6,
+    0xa9f6d30a038d1dbc, 0x5e9fcf4ccd211f4c,
+    0xd47487cc8470652b, 0x7647c3200069671f,
+    0x84c8d4dfd2c63f3b, 0x29ecd9f40041e073,
+    0xa5fb0a17c777cf09, 0xf468107100525890,
+    0xcf79cc9db955c2cc, 0x7182148d4066eeb4,
+    0x81ac1fe293d599bf, 0xc6f14cd848405530,
+    0xa21727db38cb002f, 0xb8ada00e5a506a7c,
+    0xca9cf1d206fdc03b, 0xa6d90811f0e4851c,
+    0xfd442e4688bd304a, 0x908f4a166d1da663,
+    0x9e4a9cec15763e2e, 0x9a598e4e043287fe,
+    0xc5dd44271ad3cdba, 0x40eff1e1853f29fd,
+    0xf7549530e188c128, 0xd12bee59e68ef47c,
+    0x9a94dd3e8cf578b9, 0x82bb74f8301958ce,
+    0xc13a148e3032d6e7, 0xe36a52363c1faf01,
+    0xf18899b1bc3f8ca1, 0xdc44e6c3cb279ac1,
+    0x96f5600f15a7b7e5, 0x29ab103a5ef8c0b9,
+    0xbcb2b812db11a5de, 0x7415d448f6b6f0e7,
+    0xebdf661791d60f56, 0x111b495b3464ad21,
+    0x936b9fcebb25c995, 0xcab10dd900beec34,
+    0xb84687c269ef3bfb, 0x3d5d514f40eea742,
+    0xe65829b3046b0afa, 0x0cb4a5a3112a5112,
+    0x8ff71a0fe2c2e6dc, 0x47f0e785eaba72ab,
+    0xb3f4e093db73a093, 0x59ed216765690f56,
+    0xe0f218b8d25088b8, 0x306869c13ec3532c,
+    0x8c974f7383725573, 0x1e414218c73a13fb,
+    0xafbd2350644eeacf, 0xe5d1929ef90898fa,
+    0xdbac6c247d62a583, 0xdf45f746b74abf39,
+    0x894bc396ce5da772, 0x6b8bba8c328eb783,
+    0xab9eb47c81f5114f, 0x066ea92f3f326564,
+    0xd686619ba27255a2, 0xc80a537b0efefebd,
+    0x8613fd0145877585, 0xbd06742ce95f5f36,
+    0xa798fc4196e952e7, 0x2c48113823b73704,
+    0xd17f3b51fca3a7a0, 0xf75a15862ca504c5,
+    0x82ef85133de648c4, 0x9a984d73dbe722fb,
+    0xa3ab66580d5fdaf5, 0xc13e60d0d2e0ebba,
+    0xcc963fee10b7d1b3, 0x318df905079926a8,
+    0xffbbcfe994e5c61f, 0xfdf17746497f7052,
+    0x9fd561f1fd0f9bd3, 0xfeb6ea8bedefa633,
+    0xc7caba6e7c5382c8, 0xfe64a52ee96b8fc0,
+    0xf9bd690a1b68637b, 0x3dfdce7aa3c673b0,
+    0x9c1661a651213e2d, 0x06bea10ca65c084e,
+    0xc31bfa0fe5698db8, 0x486e494fcff30a62,
+    0xf3e2f893dec3f126, 0x5a89dba3c3efccfa,
+    0x986ddb5c6b3a76b7, 0xf89629465a75e01c,
+    0xbe89523386091465, 0xf6bbb397f1135823,
+    0xee2ba6c0678b597f, 0x746aa07ded582e2c,
+    0x94db483840b717ef, 0xa8c2a44eb4571cdc,
+    0xba121a4650e4ddeb, 0x92f34d62616ce413,
+    0xe896a0d7e51e1566, 0x77b020baf9c81d17,
+    0x915e2486ef32cd60, 0x0ace1474dc1d122e,
+    0xb5b5ada8aaff80b8, 0x0d819992132456ba,
+    0xe3231912d5bf60e6, 0x10e1fff697ed6c69,
+    0x8df5efabc5979c8f, 0xca8d3ffa1ef463c1,
+    0xb1736b96b6fd83b3, 0xbd308ff8a6b17cb2,
+    0xddd0467c64bce4a0, 0xac7cb3f6d05ddbde,
+    0x8aa22c0dbef60ee4, 0x6bcdf07a423aa96b,
+    0xad4ab7112eb3929d, 0x86c16c98d2c953c6,
+    0xd89d64d57a607744, 0xe871c7bf077ba8b7,
+    0x87625f056c7c4a8b, 0x11471cd764ad4972,
+    0xa93af6c6c79b5d2d, 0xd598e40d3dd89bcf,
+    0xd389b47879823479, 0x4aff1d108d4ec2c3,
+    0x843610cb4bf160cb, 0xcedf722a585139ba,
+    0xa54394fe1eedb8fe, 0xc2974eb4ee658828,
+    0xce947a3da6a9273e, 0x733d226229feea32,
+    0x811ccc668829b887, 0x0806357d5a3f525f,
+    0xa163ff802a3426a8, 0xca07c2dcb0cf26f7,
+    0xc9bcff6034c13052, 0xfc89b393dd02f0b5,
+    0xfc2c3f3841f17c67, 0xbbac2078d443ace2,
+    0x9d9ba7832936edc0, 0xd54b944b84aa4c0d,
+    0xc5029163f384a931, 0x0a9e795e65d4df11,
+    0xf64335bcf065d37d, 0x4d4617b5ff4a16d5,
+    0x99ea0196163fa42e, 0x504bced1bf8e4e45,
+    0xc06481fb9bcf8d39, 0xe45ec2862f71e1d6,
+    0xf07da27a82c37088, 0x5d767327bb4e5a4c,
+    0x964e858c91ba2655, 0x3a6a07f8d510f86f,
+    0xbbe226efb628afea, 0x890489f70a55368b,
+    0xeadab0aba3b2dbe5, 0x2b45ac74ccea842e,
+    0x92c8ae6b464fc96f, 0x3b0b8bc90012929d,
+    0xb77ada0617e3bbcb, 0x09ce6ebb40173744,
+    0xe55990879ddcaabd, 0xcc420a6a101d0515,
+    0x8f57fa54c2a9eab6, 0x9fa946824a12232d,
+    0xb32df8e9f3546564, 0x47939822dc96abf9,
+    0xdff9772470297ebd, 0x59787e2b93bc56f7,
+    0x8bfbea76c619ef36, 0x57eb4edb3c55b65a,
+    0xaefae51477a06b03, 0xede622920b6b23f1,
+    0xdab99e59958885c4, 0xe95fab368e45eced,
+    0x88b402f7fd75539b, 0x11dbcb0218ebb414,
+    0xaae103b5fcd2a881, 0xd652bdc29f26a119,
+    0xd59944a37c0752a2, 0x4be76d3346f0495f,
+    0x857fcae62d8493a5, 0x6f70a4400c562ddb,
+    0xa6dfbd9fb8e5b88e, 0xcb4ccd500f6bb952,
+    0xd097ad07a71f26b2, 0x7e2000a41346a7a7,
+    0x825ecc24c873782f, 0x8ed400668c0c28c8,
+    0xa2f67f2dfa90563b, 0x728900802f0f32fa,
+    0xcbb41ef979346bca, 0x4f2b40a03ad2ffb9,
+    0xfea126b7d78186bc, 0xe2f610c84987bfa8,
+    0x9f24b832e6b0f436, 0x0dd9ca7d2df4d7c9,
+    0xc6ede63fa05d3143, 0x91503d1c79720dbb,
+    0xf8a95fcf88747d94, 0x75a44c6397ce912a,
+    0x9b69dbe1b548ce7c, 0xc986afbe3ee11aba,
+    0xc24452da229b021b, 0xfbe85badce996168,
+    0xf2d56790ab41c2a2, 0xfae27299423fb9c3,
+    0x97c560ba6b0919a5, 0xdccd879fc967d41a,
+    0xbdb6b8e905cb600f, 0x5400e987bbc1c920,
+    0xed246723473e3813, 0x290123e9aab23b68,
+    0x9436c0760c86e30b, 0xf9a0b6720aaf6521,
+    0xb94470938fa89bce, 0xf808e40e8d5b3e69,
+    0xe7958cb87392c2c2, 0xb60b1d1230b20e04,
+    0x90bd77f3483bb9b9, 0xb1c6f22b5e6f48c2,
+    0xb4ecd5f01a4aa828, 0x1e38aeb6360b1af3,
+    0xe2280b6c20dd5232, 0x25c6da63c38de1b0,
+    0x8d590723948a535f, 0x579c487e5a38ad0e,
+    0xb0af48ec79ace837, 0x2d835a9df0c6d851,
+    0xdcdb1b2798182244, 0xf8e431456cf88e65,
+    0x8a08f0f8bf0f156b, 0x1b8e9ecb641b58ff,
+    0xac8b2d36eed2dac5, 0xe272467e3d222f3f,
+    0xd7adf884aa879177, 0x5b0ed81dcc6abb0f,
+    0x86ccbb52ea94baea, 0x98e947129fc2b4e9,
+    0xa87fea27a539e9a5, 0x3f2398d747b36224,
+    0xd29fe4b18e88640e, 0x8eec7f0d19a03aad,
+    0x83a3eeeef9153e89, 0x1953cf68300424ac,
+    0xa48ceaaab75a8e2b, 0x5fa8c3423c052dd7,
+    0xcdb02555653131b6, 0x3792f412cb06794d,
+    0x808e17555f3ebf11, 0xe2bbd88bbee40bd0,
+    0xa0b19d2ab70e6ed6, 0x5b6aceaeae9d0ec4,
+    0xc8de047564d20a8b, 0xf245825a5a445275,
+    0xfb158592be068d2e, 0xeed6e2f0f0d56712,
+    0x9ced737bb6c4183d, 0x55464dd69685606b,
+    0xc428d05aa4751e4c, 0xaa97e14c3c26b886,
+    0xf53304714d9265df, 0xd53dd99f4b3066a8,
+    0x993fe2c6d07b7fab, 0xe546a8038efe4029,
+    0xbf8fdb78849a5f96, 0xde98520472bdd033,
+    0xef73d256a5c0f77c, 0x963e66858f6d4440,
+    0x95a8637627989aad, 0xdde7001379a44aa8,
+    0xbb127c53b17ec159, 0x5560c018580d5d52,
+    0xe9d71b689dde71af, 0xaab8f01e6e10b4a6,
+    0x9226712162ab070d, 0xcab3961304ca70e8,
+    0xb6b00d69bb55c8d1, 0x3d607b97c5fd0d22,
+    0xe45c10c42a2b3b05, 0x8cb89a7db77c506a,
+    0x8eb98a7a9a5b04e3, 0x77f3608e92adb242,
+    0xb267ed1940f1c61c, 0x55f038b237591ed3,
+    0xdf01e85f912e37a3, 0x6b6c46dec52f6688,
+    0x8b61313bbabce2c6, 0x2323ac4b3b3da015,
+    0xae397d8aa96c1b77, 0xabec975e0a0d081a,
+    0xd9c7dced53c72255, 0x96e7bd358c904a21,
+    0x881cea14545c7575, 0x7e50d64177da2e54,
+    0xaa242499697392d2, 0xdde50bd1d5d0b9e9,
+    0xd4ad2dbfc3d07787, 0x955e4ec64b44e864,
+    0x84ec3c97da624ab4, 0xbd5af13bef0b113e,
+    0xa6274bbdd0fadd61, 0xecb1ad8aeacdd58e,
+    0xcfb11ead453994ba, 0x67de18eda5814af2,
+    0x81ceb32c4b43fcf4, 0x80eacf948770ced7,
+    0xa2425ff75e14fc31, 0xa1258379a94d028d,
+    0xcad2f7f5359a3b3e, 0x096ee45813a04330,
+    0xfd87b5f28300ca0d, 0x8bca9d6e188853fc,
+    0x9e74d1b791e07e48, 0x775ea264cf55347e,
+    0xc612062576589dda, 0x95364afe032a819e,
+    0xf79687aed3eec551, 0x3a83ddbd83f52205,
+    0x9abe14cd44753b52, 0xc4926a9672793543,
+    0xc16d9a0095928a27, 0x75b7053c0f178294,
+    0xf1c90080baf72cb1, 0x5324c68b12dd6339,
+    0x971da05074da7bee, 0xd3f6fc16ebca5e04,
+    0xbce5086492111aea, 0x88f4bb1ca6bcf585,
+    0xec1e4a7db69561a5, 0x2b31e9e3d06c32e6,
+    0x9392ee8e921d5d07, 0x3aff322e62439fd0,
+    0xb877aa3236a4b449, 0x09befeb9fad487c3,
+    0xe69594bec44de15b, 0x4c2ebe687989a9b4,
+    0x901d7cf73ab0acd9, 0x0f9d37014bf60a11,
+    0xb424dc35095cd80f, 0x538484c19ef38c95,
+    0xe12e13424bb40e13, 0x2865a5f206b06fba,
+    0x8cbccc096f5088cb, 0xf93f87b7442e45d4,
+    0xafebff0bcb24aafe, 0xf78f69a51539d749,
+    0xdbe6fecebdedd5be, 0xb573440e5a884d1c,
+    0x89705f4136b4a597, 0x31680a88f8953031,
+    0xabcc77118461cefc, 0xfdc20d2b36ba7c3e,
+    0xd6bf94d5e57a42bc, 0x3d32907604691b4d,
+    0x8637bd05af6c69b5, 0xa63f9a49c2c1b110,
+    0xa7c5ac471b478423, 0x0fcf80dc33721d54,
+    0xd1b71758e219652b, 0xd3c36113404ea4a9,
+    0x83126e978d4fdf3b, 0x645a1cac083126ea,
+    0xa3d70a3d70a3d70a, 0x3d70a3d70a3d70a4,
+    0xcccccccccccccccc, 0xcccccccccccccccd,
+    0x8000000000000000, 0x0000000000000000,
+    0xa000000000000000, 0x0000000000000000,
+    0xc800000000000000, 0x0000000000000000,
+    0xfa00000000000000, 0x0000000000000000,
+    0x9c40000000000000, 0x0000000000000000,
+    0xc350000000000000, 0x0000000000000000,
+    0xf424000000000000, 0x0000000000000000,
+    0x9896800000000000, 0x0000000000000000,
+    0xbebc200000000000, 0x0000000000000000,
+    0xee6b280000000000, 0x0000000000000000,
+    0x9502f90000000000, 0x0000000000000000,
+    0xba43b74000000000, 0x0000000000000000,
+    0xe8d4a51000000000, 0x0000000000000000,
+    0x9184e72a00000000, 0x0000000000000000,
+    0xb5e620f480000000, 0x0000000000000000,
+    0xe35fa931a0000000, 0x0000000000000000,
+    0x8e1bc9bf04000000, 0x0000000000000000,
+    0xb1a2bc2ec5000000, 0x0000000000000000,
+    0xde0b6b3a76400000, 0x0000000000000000,
+    0x8ac7230489e80000, 0x0000000000000000,
+    0xad78ebc5ac620000, 0x0000000000000000,
+    0xd8d726b7177a8000, 0x0000000000000000,
+    0x878678326eac9000, 0x0000000000000000,
+    0xa968163f0a57b400, 0x0000000000000000,
+    0xd3c21bcecceda100, 0x0000000000000000,
+    0x84595161401484a0, 0x0000000000000000,
+    0xa56fa5b99019a5c8, 0x0000000000000000,
+    0xcecb8f27f4200f3a, 0x0000000000000000,
+    0x813f3978f8940984, 0x4000000000000000,
+    0xa18f07d736b90be5, 0x5000000000000000,
+    0xc9f2c9cd04674ede, 0xa400000000000000,
+    0xfc6f7c4045812296, 0x4d00000000000000,
+    0x9dc5ada82b70b59d, 0xf020000000000000,
+    0xc5371912364ce305, 0x6c28000000000000,
+    0xf684df56c3e01bc6, 0xc732000000000000,
+    0x9a130b963a6c115c, 0x3c7f400000000000,
+    0xc097ce7bc90715b3, 0x4b9f100000000000,
+    0xf0bdc21abb48db20, 0x1e86d40000000000,
+    0x96769950b50d88f4, 0x1314448000000000,
+    0xbc143fa4e250eb31, 0x17d955a000000000,
+    0xeb194f8e1ae525fd, 0x5dcfab0800000000,
+    0x92efd1b8d0cf37be, 0x5aa1cae500000000,
+    0xb7abc627050305ad, 0xf14a3d9e40000000,
+    0xe596b7b0c643c719, 0x6d9ccd05d0000000,
+    0x8f7e32ce7bea5c6f, 0xe4820023a2000000,
+    0xb35dbf821ae4f38b, 0xdda2802c8a800000,
+    0xe0352f62a19e306e, 0xd50b2037ad200000,
+    0x8c213d9da502de45, 0x4526f422cc340000,
+    0xaf298d050e4395d6, 0x9670b12b7f410000,
+    0xdaf3f04651d47b4c, 0x3c0cdd765f114000,
+    0x88d8762bf324cd0f, 0xa5880a69fb6ac800,
+    0xab0e93b6efee0053, 0x8eea0d047a457a00,
+    0xd5d238a4abe98068, 0x72a4904598d6d880,
+    0x85a36366eb71f041, 0x47a6da2b7f864750,
+    0xa70c3c40a64e6c51, 0x999090b65f67d924,
+    0xd0cf4b50cfe20765, 0xfff4b4e3f741cf6d,
+    0x82818f1281ed449f, 0xbff8f10e7a8921a4,
+    0xa321f2d7226895c7, 0xaff72d52192b6a0d,
+    0xcbea6f8ceb02bb39, 0x9bf4f8a69f764490,
+    0xfee50b7025c36a08, 0x02f236d04753d5b4,
+    0x9f4f2726179a2245, 0x01d762422c946590,
+    0xc722f0ef9d80aad6, 0x424d3ad2b7b97ef5,
+    0xf8ebad2b84e0d58b, 0xd2e0898765a7deb2,
+    0x9b934c3b330c8577, 0x63cc55f49f88eb2f,
+    0xc2781f49ffcfa6d5, 0x3cbf6b71c76b25fb,
+    0xf316271c7fc3908a, 0x8bef464e3945ef7a,
+    0x97edd871cfda3a56, 0x97758bf0e3cbb5ac,
+    0xbde94e8e43d0c8ec, 0x3d52eeed1cbea317,
+    0xed63a231d4c4fb27, 0x4ca7aaa863ee4bdd,
+    0x945e455f24fb1cf8, 0x8fe8caa93e74ef6a,
+    0xb975d6b6ee39e436, 0xb3e2fd538e122b44,
+    0xe7d34c64a9c85d44, 0x60dbbca87196b616,
+    0x90e40fbeea1d3a4a, 0xbc8955e946fe31cd,
+    0xb51d13aea4a488dd, 0x6babab6398bdbe41,
+    0xe264589a4dcdab14, 0xc696963c7eed2dd1,
+    0x8d7eb76070a08aec, 0xfc1e1de5cf543ca2,
+    0xb0de65388cc8ada8, 0x3b25a55f43294bcb,
+    0xdd15fe86affad912, 0x49ef0eb713f39ebe,
+    0x8a2dbf142dfcc7ab, 0x6e3569326c784337,
+    0xacb92ed9397bf996, 0x49c2c37f07965404,
+    0xd7e77a8f87daf7fb, 0xdc33745ec97be906,
+    0x86f0ac99b4e8dafd, 0x69a028bb3ded71a3,
+    0xa8acd7c0222311bc, 0xc40832ea0d68ce0c,
+    0xd2d80db02aabd62b, 0xf50a3fa490c30190,
+    0x83c7088e1aab65db, 0x792667c6da79e0fa,
+    0xa4b8cab1a1563f52, 0x577001b891185938,
+    0xcde6fd5e09abcf26, 0xed4c0226b55e6f86,
+    0x80b05e5ac60b6178, 0x544f8158315b05b4,
+    0xa0dc75f1778e39d6, 0x696361ae3db1c721,
+    0xc913936dd571c84c, 0x03bc3a19cd1e38e9,
+    0xfb5878494ace3a5f, 0x04ab48a04065c723,
+    0x9d174b2dcec0e47b, 0x62eb0d64283f9c76,
+    0xc45d1df942711d9a, 0x3ba5d0bd324f8394,
+    0xf5746577930d6500, 0xca8f44ec7ee36479,
+    0x9968bf6abbe85f20, 0x7e998b13cf4e1ecb,
+    0xbfc2ef456ae276e8, 0x9e3fedd8c321a67e,
+    0xefb3ab16c59b14a2, 0xc5cfe94ef3ea101e,
+    0x95d04aee3b80ece5, 0xbba1f1d158724a12,
+    0xbb445da9ca61281f, 0x2a8a6e45ae8edc97,
+    0xea1575143cf97226, 0xf52d09d71a3293bd,
+    0x924d692ca61be758, 0x593c2626705f9c56,
+    0xb6e0c377cfa2e12e, 0x6f8b2fb00c77836c,
+    0xe498f455c38b997a, 0x0b6dfb9c0f956447,
+    0x8edf98b59a373fec, 0x4724bd4189bd5eac,
+    0xb2977ee300c50fe7, 0x58edec91ec2cb657,
+    0xdf3d5e9bc0f653e1, 0x2f2967b66737e3ed,
+    0x8b865b215899f46c, 0xbd79e0d20082ee74,
+    0xae67f1e9aec07187, 0xecd8590680a3aa11,
+    0xda01ee641a708de9, 0xe80e6f4820cc9495,
+    0x884134fe908658b2, 0x3109058d147fdcdd,
+    0xaa51823e34a7eede, 0xbd4b46f0599fd415,
+    0xd4e5e2cdc1d1ea96, 0x6c9e18ac7007c91a,
+    0x850fadc09923329e, 0x03e2cf6bc604ddb0,
+    0xa6539930bf6bff45, 0x84db8346b786151c,
+    0xcfe87f7cef46ff16, 0xe612641865679a63,
+    0x81f14fae158c5f6e, 0x4fcb7e8f3f60c07e,
+    0xa26da3999aef7749, 0xe3be5e330f38f09d,
+    0xcb090c8001ab551c, 0x5cadf5bfd3072cc5,
+    0xfdcb4fa002162a63, 0x73d9732fc7c8f7f6,
+    0x9e9f11c4014dda7e, 0x2867e7fddcdd9afa,
+    0xc646d63501a1511d, 0xb281e1fd541501b8,
+    0xf7d88bc24209a565, 0x1f225a7ca91a4226,
+    0x9ae757596946075f, 0x3375788de9b06958,
+    0xc1a12d2fc3978937, 0x0052d6b1641c83ae,
+    0xf209787bb47d6b84, 0xc0678c5dbd23a49a,
+    0x9745eb4d50ce6332, 0xf840b7ba963646e0,
+    0xbd176620a501fbff, 0xb650e5a93bc3d898,
+    0xec5d3fa8ce427aff, 0xa3e51f138ab4cebe,
+    0x93ba47c980e98cdf, 0xc66f336c36b10137,
+    0xb8a8d9bbe123f017, 0xb80b0047445d4184,
+    0xe6d3102ad96cec1d, 0xa60dc059157491e5,
+    0x9043ea1ac7e41392, 0x87c89837ad68db2f,
+    0xb454e4a179dd1877, 0x29babe4598c311fb,
+    0xe16a1dc9d8545e94, 0xf4296dd6fef3d67a,
+    0x8ce2529e2734bb1d, 0x1899e4a65f58660c,
+    0xb01ae745b101e9e4, 0x5ec05dcff72e7f8f,
+    0xdc21a1171d42645d, 0x76707543f4fa1f73,
+    0x899504ae72497eba, 0x6a06494a791c53a8,
+    0xabfa45da0edbde69, 0x0487db9d17636892,
+    0xd6f8d7509292d603, 0x45a9d2845d3c42b6,
+    0x865b86925b9bc5c2, 0x0b8a2392ba45a9b2,
+    0xa7f26836f282b732, 0x8e6cac7768d7141e,
+    0xd1ef0244af2364ff, 0x3207d795430cd926,
+    0x8335616aed761f1f, 0x7f44e6bd49e807b8,
+    0xa402b9c5a8d3a6e7, 0x5f16206c9c6209a6,
+    0xcd036837130890a1, 0x36dba887c37a8c0f,
+    0x802221226be55a64, 0xc2494954da2c9789,
+    0xa02aa96b06deb0fd, 0xf2db9baa10b7bd6c,
+    0xc83553c5c8965d3d, 0x6f92829494e5acc7,
+    0xfa42a8b73abbf48c, 0xcb772339ba1f17f9,
+    0x9c69a97284b578d7, 0xff2a760414536efb,
+    0xc38413cf25e2d70d, 0xfef5138519684aba,
+    0xf46518c2ef5b8cd1, 0x7eb258665fc25d69,
+    0x98bf2f79d5993802, 0xef2f773ffbd97a61,
+    0xbeeefb584aff8603, 0xaafb550ffacfd8fa,
+    0xeeaaba2e5dbf6784, 0x95ba2a53f983cf38,
+    0x952ab45cfa97a0b2, 0xdd945a747bf26183,
+    0xba756174393d88df, 0x94f971119aeef9e4,
+    0xe912b9d1478ceb17, 0x7a37cd5601aab85d,
+    0x91abb422ccb812ee, 0xac62e055c10ab33a,
+    0xb616a12b7fe617aa, 0x577b986b314d6009,
+    0xe39c49765fdf9d94, 0xed5a7e85fda0b80b,
+    0x8e41ade9fbebc27d, 0x14588f13be847307,
+    0xb1d219647ae6b31c, 0x596eb2d8ae258fc8,
+    0xde469fbd99a05fe3, 0x6fca5f8ed9aef3bb,
+    0x8aec23d680043bee, 0x25de7bb9480d5854,
+    0xada72ccc20054ae9, 0xaf561aa79a10ae6a,
+    0xd910f7ff28069da4, 0x1b2ba1518094da04,
+    0x87aa9aff79042286, 0x90fb44d2f05d0842,
+    0xa99541bf57452b28, 0x353a1607ac744a53,
+    0xd3fa922f2d1675f2, 0x42889b8997915ce8,
+    0x847c9b5d7c2e09b7, 0x69956135febada11,
+    0xa59bc234db398c25, 0x43fab9837e699095,
+    0xcf02b2c21207ef2e, 0x94f967e45e03f4bb,
+    0x8161afb94b44f57d, 0x1d1be0eebac278f5,
+    0xa1ba1ba79e1632dc, 0x6462d92a69731732,
+    0xca28a291859bbf93, 0x7d7b8f7503cfdcfe,
+    0xfcb2cb35e702af78, 0x5cda735244c3d43e,
+    0x9defbf01b061adab, 0x3a0888136afa64a7,
+    0xc56baec21c7a1916, 0x088aaa1845b8fdd0,
+    0xf6c69a72a3989f5b, 0x8aad549e57273d45,
+    0x9a3c2087a63f6399, 0x36ac54e2f678864b,
+    0xc0cb28a98fcf3c7f, 0x84576a1bb416a7dd,
+    0xf0fdf2d3f3c30b9f, 0x656d44a2a11c51d5,
+    0x969eb7c47859e743, 0x9f644ae5a4b1b325,
+    0xbc4665b596706114, 0x873d5d9f0dde1fee,
+    0xeb57ff22fc0c7959, 0xa90cb506d155a7ea,
+    0x9316ff75dd87cbd8, 0x09a7f12442d588f2,
+    0xb7dcbf5354e9bece, 0x0c11ed6d538aeb2f,
+    0xe5d3ef282a242e81, 0x8f1668c8a86da5fa,
+    0x8fa475791a569d10, 0xf96e017d694487bc,
+    0xb38d92d760ec4455, 0x37c981dcc395a9ac,
+    0xe070f78d3927556a, 0x85bbe253f47b1417,
+    0x8c469ab843b89562, 0x93956d7478ccec8e,
+    0xaf58416654a6babb, 0x387ac8d1970027b2,
+    0xdb2e51bfe9d0696a, 0x06997b05fcc0319e,
+    0x88fcf317f22241e2, 0x441fece3bdf81f03,
+    0xab3c2fddeeaad25a, 0xd527e81cad7626c3,
+    0xd60b3bd56a5586f1, 0x8a71e223d8d3b074,
+    0x85c7056562757456, 0xf6872d5667844e49,
+    0xa738c6bebb12d16c, 0xb428f8ac016561db,
+    0xd106f86e69d785c7, 0xe13336d701beba52,
+    0x82a45b450226b39c, 0xecc0024661173473,
+    0xa34d721642b06084, 0x27f002d7f95d0190,
+    0xcc20ce9bd35c78a5, 0x31ec038df7b441f4,
+    0xff290242c83396ce, 0x7e67047175a15271,
+    0x9f79a169bd203e41, 0x0f0062c6e984d386,
+    0xc75809c42c684dd1, 0x52c07b78a3e60868,
+    0xf92e0c3537826145, 0xa7709a56ccdf8a82,
+    0x9bbcc7a142b17ccb, 0x88a66076400bb691,
+    0xc2abf989935ddbfe, 0x6acff893d00ea435,
+    0xf356f7ebf83552fe, 0x0583f6b8c4124d43,
+    0x98165af37b2153de, 0xc3727a337a8b704a,
+    0xbe1bf1b059e9a8d6, 0x744f18c0592e4c5c,
+    0xeda2ee1c7064130c, 0x1162def06f79df73,
+    0x9485d4d1c63e8be7, 0x8addcb5645ac2ba8,
+    0xb9a74a0637ce2ee1, 0x6d953e2bd7173692,
+    0xe8111c87c5c1ba99, 0xc8fa8db6ccdd0437,
+    0x910ab1d4db9914a0, 0x1d9c9892400a22a2,
+    0xb54d5e4a127f59c8, 0x2503beb6d00cab4b,
+    0xe2a0b5dc971f303a, 0x2e44ae64840fd61d,
+    0x8da471a9de737e24, 0x5ceaecfed289e5d2,
+    0xb10d8e1456105dad, 0x7425a83e872c5f47,
+    0xdd50f1996b947518, 0xd12f124e28f77719,
+    0x8a5296ffe33cc92f, 0x82bd6b70d99aaa6f,
+    0xace73cbfdc0bfb7b, 0x636cc64d1001550b,
+    0xd8210befd30efa5a, 0x3c47f7e05401aa4e,
+    0x8714a775e3e95c78, 0x65acfaec34810a71,
+    0xa8d9d1535ce3b396, 0x7f1839a741a14d0d,
+    0xd31045a8341ca07c, 0x1ede48111209a050,
+    0x83ea2b892091e44d, 0x934aed0aab460432,
+    0xa4e4b66b68b65d60, 0xf81da84d5617853f,
+    0xce1de40642e3f4b9, 0x36251260ab9d668e,
+    0x80d2ae83e9ce78f3, 0xc1d72b7c6b426019,
+    0xa1075a24e4421730, 0xb24cf65b8612f81f,
+    0xc94930ae1d529cfc, 0xdee033f26797b627,
+    0xfb9b7cd9a4a7443c, 0x169840ef017da3b1,
+    0x9d412e0806e88aa5, 0x8e1f289560ee864e,
+    0xc491798a08a2ad4e, 0xf1a6f2bab92a27e2,
+    0xf5b5d7ec8acb58a2, 0xae10af696774b1db,
+    0x9991a6f3d6bf1765, 0xacca6da1e0a8ef29,
+    0xbff610b0cc6edd3f, 0x17fd090a58d32af3,
+    0xeff394dcff8a948e, 0xddfc4b4cef07f5b0,
+    0x95f83d0a1fb69cd9, 0x4abdaf101564f98e,
+    0xbb764c4ca7a4440f, 0x9d6d1ad41abe37f1,
+    0xea53df5fd18d5513, 0x84c86189216dc5ed,
+    0x92746b9be2f8552c, 0x32fd3cf5b4e49bb4,
+    0xb7118682dbb66a77, 0x3fbc8c33221dc2a1,
+    0xe4d5e82392a40515, 0x0fabaf3feaa5334a,
+    0x8f05b1163ba6832d, 0x29cb4d87f2a7400e,
+    0xb2c71d5bca9023f8, 0x743e20e9ef511012,
+    0xdf78e4b2bd342cf6, 0x914da9246b255416,
+    0x8bab8eefb6409c1a, 0x1ad089b6c2f7548e,
+    0xae9672aba3d0c320, 0xa184ac2473b529b1,
+    0xda3c0f568cc4f3e8, 0xc9e5d72d90a2741e,
+    0x8865899617fb1871, 0x7e2fa67c7a658892,
+    0xaa7eebfb9df9de8d, 0xddbb901b98feeab7,
+    0xd51ea6fa85785631, 0x552a74227f3ea565,
+    0x8533285c936b35de, 0xd53a88958f87275f,
+    0xa67ff273b8460356, 0x8a892abaf368f137,
+    0xd01fef10a657842c, 0x2d2b7569b0432d85,
+    0x8213f56a67f6b29b, 0x9c3b29620e29fc73,
+    0xa298f2c501f45f42, 0x8349f3ba91b47b8f,
+    0xcb3f2f7642717713, 0x241c70a936219a73,
+    0xfe0efb53d30dd4d7, 0xed238cd383aa0110,
+    0x9ec95d1463e8a506, 0xf4363804324a40aa,
+    0xc67bb4597ce2ce48, 0xb143c6053edcd0d5,
+    0xf81aa16fdc1b81da, 0xdd94b7868e94050a,
+    0x9b10a4e5e9913128, 0xca7cf2b4191c8326,
+    0xc1d4ce1f63f57d72, 0xfd1c2f611f63a3f0,
+    0xf24a01a73cf2dccf, 0xbc633b39673c8cec,
+    0x976e41088617ca01, 0xd5be0503e085d813,
+    0xbd49d14aa79dbc82, 0x4b2d8644d8a74e18,
+    0xec9c459d51852ba2, 0xddf8e7d60ed1219e,
+    0x93e1ab8252f33b45, 0xcabb90e5c942b503,
+    0xb8da1662e7b00a17, 0x3d6a751f3b936243,
+    0xe7109bfba19c0c9d, 0x0cc512670a783ad4,
+    0x906a617d450187e2, 0x27fb2b80668b24c5,
+    0xb484f9dc9641e9da, 0xb1f9f660802dedf6,
+    0xe1a63853bbd26451, 0x5e7873f8a0396973,
+    0x8d07e33455637eb2, 0xdb0b487b6423e1e8,
+    0xb049dc016abc5e5f, 0x91ce1a9a3d2cda62,
+    0xdc5c5301c56b75f7, 0x7641a140cc7810fb,
+    0x89b9b3e11b6329ba, 0xa9e904c87fcb0a9d,
+    0xac2820d9623bf429, 0x546345fa9fbdcd44,
+    0xd732290fbacaf133, 0xa97c177947ad4095,
+    0x867f59a9d4bed6c0, 0x49ed8eabcccc485d,
+    0xa81f301449ee8c70, 0x5c68f256bfff5a74,
+    0xd226fc195c6a2f8c, 0x73832eec6fff3111,
+    0x83585d8fd9c25db7, 0xc831fd53c5ff7eab,
+    0xa42e74f3d032f525, 0xba3e7ca8b77f5e55,
+    0xcd3a1230c43fb26f, 0x28ce1bd2e55f35eb,
+    0x80444b5e7aa7cf85, 0x7980d163cf5b81b3,
+    0xa0555e361951c366, 0xd7e105bcc332621f,
+    0xc86ab5c39fa63440, 0x8dd9472bf3fefaa7,
+    0xfa856334878fc150, 0xb14f98f6f0feb951,
+    0x9c935e00d4b9d8d2, 0x6ed1bf9a569f33d3,
+    0xc3b8358109e84f07, 0x0a862f80ec4700c8,
+    0xf4a642e14c6262c8, 0xcd27bb612758c0fa,
+    0x98e7e9cccfbd7dbd, 0x8038d51cb897789c,
+    0xbf21e44003acdd2c, 0xe0470a63e6bd56c3,
+    0xeeea5d5004981478, 0x1858ccfce06cac74,
+    0x95527a5202df0ccb, 0x0f37801e0c43ebc8,
+    0xbaa718e68396cffd, 0xd30560258f54e6ba,
+    0xe950df20247c83fd, 0x47c6b82ef32a2069,
+    0x91d28b7416cdd27e, 0x4cdc331d57fa5441,
+    0xb6472e511c81471d, 0xe0133fe4adf8e952,
+    0xe3d8f9e563a198e5, 0x58180fddd97723a6,
+    0x8e679c2f5e44ff8f, 0x570f09eaa7ea7648,
+};
+
+static void
+mul_128(uint64_t a, uint64_t b, uint64_t *high, uint64_t *low)
+{
+#ifdef __SIZEOF_INT128__
+    __extension__ unsigned __int128 product = (unsigned __int128) a * b;
+    *high = product >> 64;
+    *low = (uint64_t) product;
+#else
+    uint64_t a_lo = (uint32_t) a, a_hi = a >> 32;
+    uint64_t b_lo = (uint32_t) b, b_hi = b >> 32;
+    uint64_t lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo;
+    uint64_t lo_hi = a_lo * b_hi, hi_hi = a_hi * b_hi;
+    uint64_t cross = (lo_lo >> 32) + (uint32_t) hi_lo + lo_hi;
+    *high = hi_hi + (hi_lo >> 32) + (cross >> 32);
+    *low = (cross << 32) | (uint32_t) lo_lo;
+#endif
+}
+
+static int
+leading_zeros(uint64_t n)
+{
+#ifdef __GNUC__
+    return __builtin_clzll(n);
+#else
+    int zeros = 0;
+    while (!(n & (1ULL << 63))) {
+        n <<= 1;
+        zeros++;
+    }
+    return zeros;
+#endif
+}
+
+// Returns the bits of the nearest binary number to w * 10^q, w > 0
+static uint64_t
+eisel_lemire(const BinaryFormat *fmt, uint64_t w, int q)
+{
+    if (q < fmt->min_power)
+        return 0;
+    if (q > fmt->max_power)
+        return (uint64_t) fmt->infinite_power << fmt->mantissa_bits;
+
+    int lz = leading_zeros(w);
+    w <<= lz;
+
+    // Only the bits needed for rounding must be exact, the second half of
+    // the power is required only if they may be affected by a carry
+    const uint64_t *pow5 = pow5_128 + 2 * (q - POW5_MIN);
+    uint64_t high, low;
+    mul_128(w, pow5[0], &high, &low);
+
+    uint64_t precision_mask = UINT64_MAX >> (fmt->mantissa_bits + 3);
+    if ((high & precision_mask) == precision_mask) {
+        uint64_t high2, low2;
+        mul_128(w, pow5[1], &high2, &low2);
+        low += high2;
+        high += high2 > low;
+    }
+
+    int upper = high >> 63;
+    int shift = upper + 64 - fmt->mantissa_bits - 3;
+    uint64_t mantissa = high >> shift;
+    // floor(q * log2(10)) + 63, exact for the range of the table
+    int power = (((152170 + 65536) * q) >> 16) + 63 + upper - lz + fmt->bias;
+
+    if (power <= 0) {
+        // Subnormal, or zero if too small
+        if (-power + 1 >= 64)
+            return 0;
+
+        mantissa >>= -power + 1;
+        mantissa += mantissa & 1;
+        mantissa >>= 1;
+        power = mantissa < (1ULL << fmt->mantissa_bits) ? 0 : 1;
+        return ((uint64_t) power << fmt->mantissa_bits) |
+               (mantissa & ((1ULL << fmt->mantissa_bits) - 1));
+    }
+
+    // Exactly halfway between two numbers, round to even
+    if (low <= 1 && q >= fmt->min_round_even && q <= fmt->max_round_even &&
+        (mantissa & 3) == 1 && (mantissa << shift) == high)
+        mantissa &= ~1ULL;
+
+    mantissa += mantissa & 1;
+    mantissa >>= 1;
+    if (mantissa >= (2ULL << fmt->mantissa_bits)) {
+        mantissa = 1ULL << fmt->mantissa_bits;
+        power++;
+    }
+    mantissa &= ~(1ULL << fmt->mantissa_bits);
+
+    if (power >= fmt->infinite_power)
+        return (uint64_t) fmt->infinite_power << fmt->mantissa_bits;
+
+    return ((uint64_t) power << fmt->mantissa_bits) | mantissa;
+}
+
+#define BIG_LIMBS 128
+
+// Unsigned big integer, large enough for 800 decimal digits scaled by the
+// powers of two and five within the range of doubles
+typedef struct {
+    uint32_t limbs[BIG_LIMBS];
+    int len;
+} BigInt;
+
+static void
+big_mul_add(BigInt *n, uint32_t mul, uint32_t add)
+{
+    uint64_t carry = add;
+    for (int i = 0; i < n->len; i++) {
+        uint64_t product = (uint64_t) n->limbs[i] * mul + carry;
+        n->limbs[i] = (uint32_t) product;
+        carry = product >> 32;
+    }
+
+    if (carry != 0) {
+        assert(n->len < BIG_LIMBS);
+        n->limbs[n->len++] = (uint32_t) carry;
+    }
+}
+
+static void
+big_mul_pow5(BigInt *n, int exp)
+{
+    static const uint32_t pow5[] = {
+        1, 5, 25, 125, 625, 3125, 15625, 78125, 390625, 1953125, 9765625,
+        48828125, 244140625, 1220703125,
+    };
 
-        num = num * 10 + digit;
+    for (; exp >= 13; exp -= 13)
+        big_mul_add(n, pow5[13], 0);
+    big_mul_add(n, pow5[exp], 0);
+}
+
+static void
+big_shift_left(BigInt *n, int bits)
+{
+    if (n->len == 0)
+        return;
+
+    int limbs = bits / 32;
+    bits %= 32;
+    assert(n->len + limbs + 1 <= BIG_LIMBS);
+
+    n->limbs[n->len] = 0;
+    for (int i = n->len; i >= 0; i--) {
+        uint32_t hi = n->limbs[i] << bits;
+        uint32_t lo = bits && i > 0 ? n->limbs[i - 1] >> (32 - bits) : 0;
+        n->limbs[i + limbs] = hi | lo;
     }
+    memset(n->limbs, 0, limbs * sizeof(uint32_t));
+
+    n->len += limbs + 1;
+    while (n->len > 0 && n->limbs[n->len - 1] == 0)
+        n->len--;
+}
+
+static int
+big_compare(const BigInt *a, const BigInt *b)
+{
+    if (a->len != b->len)
+        return a->len < b->len ? -1 : 1;
 
-    *number = sign * num;
+    for (int i = a->len - 1; i >= 0; i--) {
+        if (a->limbs[i] != b->limbs[i])
+            return a->limbs[i] < b->limbs[i] ? -1 : 1;
+    }
     return 0;
 }
 
+#define MAX_DIGITS 800
+
+// Compares the decimal with the number halfway between the given binary
+// number and the next one, using at most MAX_DIGITS significant digits
+static int
+compare_halfway(const BinaryFormat *fmt,
+                const char *src,
+                const Decimal *dec,
+                uint64_t bits)
+{
+    BigInt n = {0};
+    int exp = 0;
+    int digits = 0;
+    bool truncated = false;
+    bool fraction = false;
+
+    uint32_t chunk = 0;
+    int chunk_len = 0;
+    for (int i = dec->start; i < dec->end; i++) {
+        if (src[i] == '.') {
+            fraction = true;
+            continue;
+        }
+
+        int digit = src[i] - '0';
+        if (digits == 0 && digit == 0) {
+            exp -= fraction;
+        } else if (digits < MAX_DIGITS) {
+            chunk = chunk * 10 + digit;
+            if (++chunk_len == 9) {
+                big_mul_add(&n, 1000000000, chunk);
+                chunk = chunk_len = 0;
+            }
+            digits++;
+            exp -= fraction;
+        } else {
+            truncated |= digit != 0;
+            exp += !fraction;
+        }
+    }
+
+    static const uint32_t pow10[] = {
+        1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000,
+    };
+    big_mul_add(&n, pow10[chunk_len], chunk);
+
+    // The halfway number is (2 * mantissa + 1) * 2^(power - 1)
+    uint64_t mask = (1ULL << fmt->mantissa_bits) - 1;
+    int biased = bits >> fmt->mantissa_bits;
+    uint64_t mantissa = bits & mask;
+    int power = 1 - fmt->bias - fmt->mantissa_bits;
+    if (biased != 0) {
+        mantissa |= mask + 1;
+        power = biased - fmt->bias - fmt->mantissa_bits;
+    }
+
+    mantissa = 2 * mantissa + 1;
+    power--;
+
+    BigInt half = {.len = 1};
+    half.limbs[0] = (uint32_t) mantissa;
+    if (mantissa >> 32)
+        half.limbs[half.len++] = mantissa >> 32;
+
+    // n * 5^exp * 2^exp against half * 2^power
+    if (exp >= 0)
+        big_mul_pow5(&n, exp);
+    else
+        big_mul_pow5(&half, -exp);
+
+    if (exp > power)
+        big_shift_left(&n, exp - power);
+    else
+        big_shift_left(&half, power - exp);
+
+    int cmp = big_compare(&n, &half);
+    return cmp == 0 && truncated ? 1 : cmp;
+}
+
+static uint64_t
+decimal_to_binary(const BinaryFormat *fmt, const char *src, const Decimal *dec)
+{
+    if (dec->mantissa == 0)
+        return 0;
+
+    uint64_t bits = eisel_lemire(fmt, dec->mantissa, dec->exponent);
+    if (!dec->truncated)
+        return bits;
+
+    // The decimal lies between the mantissa and the next integer, if both
+    // round to the same number so does the decimal
+    if (bits == eisel_lemire(fmt, dec->mantissa + 1, dec->exponent))
+        return bits;
+
+    int cmp = compare_halfway(fmt, src, dec, bits);
+    if (cmp > 0 || (cmp == 0 && (bits & 1)))
+        bits++;
+    return bits;
+}
+
+static float
+decimal_to_float(const char *src, const Decimal *dec)
+{
+    static const float pow10[] = {1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f,
+                                  1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+
+#if FLT_EVAL_METHOD == 0
+    // Both operands are exact, so is the rounding of the result
+    if (!dec->truncated && dec->mantissa <= (1 << 24) &&
+        dec->exponent >= -10 && dec->exponent <= 10) {
+        float mantissa = (float) dec->mantissa;
+        return dec->exponent < 0 ? mantissa / pow10[-dec->exponent]
+                                 : mantissa * pow10[dec->exponent];
+    }
+#endif
+
+    uint32_t bits = (uint32_t) decimal_to_binary(&binary32, src, dec);
+    float number;
+    memcpy(&number, &bits, sizeof(number));
+    return number;
+}
+
+static double
+decimal_to_double(const char *src, const Decimal *dec)
+{
+    static const double pow10[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+    };
+
+#if FLT_EVAL_METHOD == 0
+    if (!dec->truncated && dec->mantissa <= (1ULL << 53) &&
+        dec->exponent >= -22 && dec->exponent <= 22) {
+        double mantissa = (double) dec->mantissa;
+        return dec->exponent < 0 ? mantissa / pow10[-dec->exponent]
+                                 : mantissa * pow10[dec->exponent];
+    }
+#endif
+
+    uint64_t bits = decimal_to_binary(&binary64, src, dec);
+    double number;
+    memcpy(&number, &bits, sizeof(number));
+    return number;
+}
+
 static int
 consume_float(Scanner *s, float *number, CfgError *err)
 {
-    int sign = 1;
-    int int_part = 0;
-    int fract_part = 0;
+    bool negative = false;
+    Decimal dec = {0};
 
-    if (!is_at_end(s) && peek(s) == '-' && isdigit(peek_next(s))) {
+    if (!is_at_end(s) && peek(s) == '-' && is_digit(peek_next(s))) {
         // Consume '-'
         advance(s);
-        sign = -1;
+        negative = true;
     }
 
-    if (!is_at_end(s) && !isdigit(peek(s)))
+    if (!is_at_end(s) && !is_digit(peek(s)))
         return error(s, err, "number expected");
 
-    while (!is_at_end(s) && isdigit(peek(s))) {
-        int digit = advance(s) - '0';
-        if (int_part > (INT_MAX - digit) / 10)
-            return error(s, err, "number too large");
-        int_part = int_part * 10 + digit;
-    }
+    dec.start = cur(s);
+    consume_digits(s, &dec, false);
 
     if (!is_at_end(s) && peek(s) != '.')
         return error(s, err, "float expected");
@@ -265,22 +1624,81 @@ consume_float(Scanner *s, float *number, CfgError *err)
     // Consume '.'
     advance(s);
 
-    int div = 1;
-    while (!is_at_end(s) && isdigit(peek(s))) {
-        int digit = advance(s) - '0';
-        if (fract_part > (INT_MAX - digit) / 10)
-            return error(s, err, "number too large");
+    consume_digits(s, &dec, true);
+    dec.end = cur(s);
+
+    float floating = decimal_to_float(s->src, &dec);
+    if (floating > FLT_MAX)
+        return error(s, err, "number too large");
+
+    *number = negative ? -floating : floating;
+    return 0;
+}
+
+// Consumes an optional '-', digits and an optional fraction
+static int
+read_decimal(const char *src, int src_len, Decimal *dec, bool *negative)
+{
+    Scanner s;
+    init_scanner(&s, src, src_len);
+
+    *negative = false;
+    if (!is_at_end(&s) && peek(&s) == '-' && is_digit(peek_next(&s))) {
+        // Consume '-'
+        advance(&s);
+        *negative = true;
+    }
+
+    if (is_at_end(&s) || !is_digit(peek(&s)))
+        return 0;
 
-        fract_part = fract_part * 10 + digit;
-        if (div > INT_MAX / 10)
-            return error(s, err, "number too large");
+    *dec = (Decimal){.start = cur(&s)};
+    consume_digits(&s, dec, false);
 
-        div *= 10;
+    if (!is_at_end(&s) && peek(&s) == '.') {
+        // Consume '.'
+        advance(&s);
+        consume_digits(&s, dec, true);
     }
 
-    float floating = int_part + ((float) fract_part / div);
-    *number = sign * floating;
-    return 0;
+    dec->end = cur(&s);
+    return dec->end;
+}
+
+int
+cfg_read_float(const char *src, int src_len, float *number)
+{
+    Decimal dec;
+    bool negative;
+
+    int len = read_decimal(src, src_len, &dec, &negative);
+    if (len == 0)
+        return 0;
+
+    float floating = decimal_to_float(src, &dec);
+    if (floating > FLT_MAX)
+        return 0;
+
+    *number = negative ? -floating : floating;
+    return len;
+}
+
+int
+cfg_read_double(const char *src, int src_len, double *number)
+{
+    Decimal dec;
+    bool negative;
+
+    int len = read_decimal(src, src_len, &dec, &negative);
+    if (len == 0)
+        return 0;
+
+    double floating = decimal_to_double(src, &dec);
+    if (floating > DBL_MAX)
+        return 0;
+
+    *number = negative ? -floating : floating;
+    return len;
 }
 
 static bool
@@ -289,10 +1707,10 @@ match_float(Scanner *s)
     int restore = cur(s);
     bool is_float = false;
 
-    if (!is_at_end(s) && peek(s) == '-' && isdigit(peek_next(s)))
+    if (!is_at_end(s) && peek(s) == '-' && is_digit(peek_next(s)))
         advance(s);  // Consume '-'
 
-    while (!is_at_end(s) && isdigit(peek(s)))
+    while (!is_at_end(s) && is_digit(peek(s)))
         advance(s);
 
     if (!is_at_end(s) && peek(s) == '.')
@@ -303,7 +1721,7 @@ match_float(Scanner *s)
 }
 
 static int
-parse_number(Scanner *s, CfgEntry *entry, CfgError *err)
+parse_number(Scanner *s, CfgViewEntry *entry, CfgError *err)
 {
     if (match_float(s)) {
         float number;
@@ -324,7 +1742,7 @@ parse_number(Scanner *s, CfgEntry *entry, CfgError *err)
 }
 
 static int
-parse_rgba(Scanner *s, CfgEntry *entry, CfgError *err)
+parse_rgba(Scanner *s, CfgViewEntry *entry, CfgError *err)
 {
     if (!consume_literal(s, cur(s), "rgba", 4))
         return error(s, err, "invalid literal");
@@ -413,7 +1831,7 @@ parse_rgba(Scanner *s, CfgEntry *entry, CfgError *err)
 }
 
 static int
-parse_true(Scanner *s, CfgEntry *entry, CfgError *err)
+parse_true(Scanner *s, CfgViewEntry *entry, CfgError *err)
 {
     if (!consume_literal(s, cur(s), "true", 4))
         return error(s, err, "invalid literal");
@@ -424,7 +1842,7 @@ parse_true(Scanner *s, CfgEntry *entry, CfgError *err)
 }
 
 static int
-parse_false(Scanner *s, CfgEntry *entry, CfgError *err)
+parse_false(Scanner *s, CfgViewEntry *entry, CfgError *err)
 {
     if (!consume_literal(s, cur(s), "false", 5))
         return error(s, err, "invalid literal");
@@ -435,7 +1853,7 @@ parse_false(Scanner *s, CfgEntry *entry, CfgError *err)
 }
 
 static int
-parse_literal(Scanner *s, CfgEntry *entry, CfgError *err)
+parse_literal(Scanner *s, CfgViewEntry *entry, CfgError *err)
 {
     switch (peek(s)) {
     case 't':
@@ -450,7 +1868,7 @@ parse_literal(Scanner *s, CfgEntry *entry, CfgError *err)
 }
 
 static int
-parse_value(Scanner *s, CfgEntry *entry, CfgError *err)
+parse_value(Scanner *s, CfgViewEntry *entry, CfgError *err)
 {
     // Skip blank space between ':' and the value
     skip_blank(s);
@@ -463,16 +1881,16 @@ parse_value(Scanner *s, CfgEntry *entry, CfgError *err)
 
     if (c == '"')
         return parse_string(s, entry, err);
-    else if (isalpha(c))
+    else if (is_alpha(c))
         return parse_literal(s, entry, err);
-    else if (isdigit(c) || (c == '-' && isdigit(peek_next(s))))
+    else if (is_digit(c) || (c == '-' && is_digit(peek_next(s))))
         return parse_number(s, entry, err);
     else
         return error(s, err, "invalid value");
 }
 
 static int
-parse_key(Scanner *s, CfgEntry *entry, CfgError *err)
+parse_key(Scanner *s, CfgViewEntry *entry, CfgError *err)
 {
     if (is_at_end(s) || !is_key(peek(s)))
         return error(s, err, "missing key");
@@ -484,10 +1902,10 @@ parse_key(Scanner *s, CfgEntry *entry, CfgError *err)
     while (!is_at_end(s) && is_key(peek(s)));
     int key_len = cur(s) - key_offset;
 
-    if (key_len > CFG_MAX_KEY)
+    if (key_len > s->max_key)
         return error(s, err, "key too long");
 
-    copy_slice_into(s, key_offset, key_len, entry->key, sizeof(entry->key));
+    entry->key = (CfgSlice){.off = key_offset, .len = key_len};
     return 0;
 }
 
@@ -506,7 +1924,7 @@ consume_colon(Scanner *s, CfgError *err)
 }
 
 static int
-parse_entry(Scanner *s, CfgEntry *entry, CfgError *err)
+parse_entry(Scanner *s, CfgViewEntry *entry, CfgError *err)
 {
     if (parse_key(s, entry, err) != 0)
         return -1;
@@ -528,214 +1946,3538 @@ parse_entry(Scanner *s, CfgEntry *entry, CfgError *err)
 
     // Consume '\n'
     if (!is_at_end(s))
-        advance(s);
+        advance_line(s);
 
     return 0;
 }
 
-int
-cfg_parse(const char *src, int src_len, Cfg *cfg, CfgError *err)
+static void
+copy_entry(Scanner *s, CfgViewEntry *view, CfgEntry *entry)
 {
-    Scanner s;
-    init_scanner(&s, src, src_len);
-    init_error(err);
+    copy_slice_into(s, view->key.off, view->key.len, entry->key,
+                    sizeof(entry->key));
+
+    entry->type = view->type;
+    switch (view->type) {
+    case CFG_TYPE_STRING:
+        copy_slice_into(s, view->val.string.off, view->val.string.len,
+                        entry->val.string, sizeof(entry->val.string));
+        break;
+    case CFG_TYPE_BOOL:
+        entry->val.boolean = view->val.boolean;
+        break;
+    case CFG_TYPE_INT:
+        entry->val.integer = view->val.integer;
+        break;
+    case CFG_TYPE_FLOAT:
+        entry->val.floating = view->val.floating;
+        break;
+    case CFG_TYPE_COLOR:
+        entry->val.color = view->val.color;
+        break;
+    }
+}
+
+_Static_assert(sizeof(CfgCompactEntry) == 16, "compact entries must be small");
+
+static int
+copy_to_pool(Scanner *s, CfgSlice slice, Cfg *cfg)
+{
+    int off = cfg->pool_len;
+    memcpy(cfg->pool + off, s->src + slice.off, slice.len);
+    cfg->pool[off + slice.len] = '\0';
+    cfg->pool_len += slice.len + 1;
+    return off;
+}
+
+// Returns the pool space taken by an entry in the compact layout
+static long long
+pool_size(CfgViewEntry *view)
+{
+    long long size = view->key.len + 1;
+    if (view->type == CFG_TYPE_STRING)
+        size += view->val.string.len + 1;
+    return size;
+}
+
+// Stores an entry at position i in the layout of the Cfg object, false if
+// there's no room for it in the pool
+static bool
+set_entry(Scanner *s, CfgViewEntry *view, Cfg *cfg, int i)
+{
+    if (cfg->compact == NULL) {
+        copy_entry(s, view, &cfg->entries[i]);
+        return true;
+    }
+
+    if (cfg->pool_len + pool_size(view) > cfg->pool_capacity)
+        return false;
+
+    CfgCompactEntry *entry = &cfg->compact[i];
+    entry->key = copy_to_pool(s, view->key, cfg);
+    entry->key_len = view->key.len;
+    entry->type = view->type;
+    entry->val = view->val;
+
+    if (view->type == CFG_TYPE_STRING)
+        entry->val.string.off = copy_to_pool(s, view->val.string, cfg);
+    return true;
+}
+
+// Appends an entry in the layout of the Cfg object, false if there's no room
+// for it in either the entries or the pool
+static bool
+push_entry(Scanner *s, CfgViewEntry *view, Cfg *cfg)
+{
+    if (cfg->count >= cfg->capacity || !set_entry(s, view, cfg, cfg->count))
+        return false;
+
+    STAT(cfg->stats.entries[view->type]++);
+    cfg->count++;
+    return true;
+}
+
+static const char *
+entry_key(Cfg *cfg, int i)
+{
+    if (cfg->compact != NULL)
+        return cfg->pool + cfg->compact[i].key;
+    return cfg->entries[i].key;
+}
+
+static CfgValType
+entry_type(Cfg *cfg, int i)
+{
+    if (cfg->compact != NULL)
+        return cfg->compact[i].type;
+    return cfg->entries[i].type;
+}
+
+// Returns the string itself for strings, the value in the entry otherwise
+static void *
+entry_val(Cfg *cfg, int i)
+{
+    if (cfg->compact == NULL)
+        return &cfg->entries[i].val;
+
+    CfgCompactEntry *entry = &cfg->compact[i];
+    if (entry->type == CFG_TYPE_STRING)
+        return cfg->pool + entry->val.string.off;
+    return &entry->val;
+}
+
+static uint32_t
+hash_key(const char *key, CfgValType type)
+{
+    // FNV-1a, seeded with the type so that the same key
+    // with different types lands in different slots
+    uint32_t hash = 2166136261u ^ (uint32_t) type;
+    while (*key) {
+        hash ^= (uint8_t) *key++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static int
+index_size(int count)
+{
+    int size = 1;
+    while (size < 2 * count)
+        size <<= 1;
+    return size;
+}
+
+// Returns the slot of the key and type, or the empty slot where it belongs
+static CfgSlot *
+probe(Cfg *cfg,
+      CfgSlot *slots,
+      int size,
+      uint32_t hash,
+      const char *key,
+      CfgValType type)
+{
+    int mask = size - 1;
+    int j = hash & mask;
+    while (slots[j].entry != -1) {
+        int other = slots[j].entry;
+        if (slots[j].hash == hash && entry_type(cfg, other) == type &&
+            !strcmp(entry_key(cfg, other), key))
+            break;
+        j = (j + 1) & mask;
+    }
+    return &slots[j];
+}
+
+static void
+fill_index(Cfg *cfg, CfgSlot *slots, int size)
+{
+    for (int i = 0; i < size; i++)
+        slots[i].entry = -1;
+
+    for (int i = 0; i < cfg->count; i++) {
+        const char *key = entry_key(cfg, i);
+        CfgValType type = entry_type(cfg, i);
+        uint32_t hash = hash_key(key, type);
+
+        // Later definitions replace earlier ones in the same slot
+        CfgSlot *slot = probe(cfg, slots, size, hash, key, type);
+        slot->hash = hash;
+        slot->entry = i;
+    }
+}
+
+static void
+index_keys(Cfg *cfg)
+{
+    CfgKeys *keys = &cfg->keys;
+
+    keys->count = 0;
+    if (keys->hashes == NULL || cfg->count > keys->capacity)
+        return;
+
+    for (int i = 0; i < cfg->count; i++) {
+        const char *key = entry_key(cfg, i);
+        CfgValType type = entry_type(cfg, i);
+        keys->hashes[i] = hash_key(key, type);
+        keys->lens[i] = strlen(key);
+        keys->types[i] = type;
+    }
+    keys->count = cfg->count;
+}
+
+static int
+compare_entries(Cfg *cfg, int a, int b)
+{
+    int res = strcmp(entry_key(cfg, a), entry_key(cfg, b));
+    if (res != 0)
+        return res;
+    return (int) entry_type(cfg, a) - (int) entry_type(cfg, b);
+}
+
+// Bottom-up merge sort of the entry numbers by key and type. It's stable, so
+// the definitions of the same key and type stay in file order.
+static int *
+sort_entries(Cfg *cfg, int *src, int *dst, int n)
+{
+    for (int width = 1; width < n; width *= 2) {
+        for (int lo = 0; lo < n; lo += 2 * width) {
+            int mid = lo + width < n ? lo + width : n;
+            int hi = lo + 2 * width < n ? lo + 2 * width : n;
+
+            int i = lo, j = mid, k = lo;
+            while (i < mid && j < hi) {
+                if (compare_entries(cfg, src[i], src[j]) <= 0)
+                    dst[k++] = src[i++];
+                else
+                    dst[k++] = src[j++];
+            }
+            while (i < mid)
+                dst[k++] = src[i++];
+            while (j < hi)
+                dst[k++] = src[j++];
+        }
+
+        int *tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+    return src;
+}
+
+static void
+index_sorted(Cfg *cfg)
+{
+    CfgSorted *sorted = &cfg->sorted;
+
+    sorted->count = 0;
+    if (sorted->entries == NULL ||
+        CFG_SORTED_CAPACITY(cfg->count) > sorted->capacity)
+        return;
+
+    int *entries = sorted->entries;
+    for (int i = 0; i < cfg->count; i++)
+        entries[i] = i;
+
+    int *res = sort_entries(cfg, entries, entries + cfg->count, cfg->count);
+
+    // Keep the last definition of each run of equal keys and types
+    int count = 0;
+    for (int i = 0; i < cfg->count; i++) {
+        if (i + 1 < cfg->count && compare_entries(cfg, res[i], res[i + 1]) == 0)
+            continue;
+        entries[count++] = res[i];
+    }
+    sorted->count = count;
+}
+
+// Smallest number of words giving at least 16 bits per entry
+static int
+bloom_size(int count)
+{
+    int size = 1;
+    while (size < count / 4)
+        size <<= 1;
+    return size;
+}
+
+// The word is picked by the high half of the mixed hash and the 3 bits by
+// its low bits
+static uint64_t
+bloom_bits(uint64_t mix)
+{
+    return 1ULL << (mix & 63) | 1ULL << (mix >> 6 & 63) |
+           1ULL << (mix >> 12 & 63);
+}
+
+static void
+add_bloom(CfgBloom *bloom, uint32_t hash)
+{
+    uint64_t mix = hash * 0x9e3779b97f4a7c15ULL;
+    bloom->words[(mix >> 32) & (bloom->size - 1)] |= bloom_bits(mix);
+}
+
+static bool
+has_bloom(CfgBloom *bloom, uint32_t hash)
+{
+    uint64_t mix = hash * 0x9e3779b97f4a7c15ULL;
+    uint64_t bits = bloom_bits(mix);
+    return (bloom->words[(mix >> 32) & (bloom->size - 1)] & bits) == bits;
+}
+
+// Reuses the hashes of the dense index if it was built
+static void
+index_bloom(Cfg *cfg)
+{
+    CfgBloom *bloom = &cfg->bloom;
+
+    bloom->size = 0;
+    if (bloom->words == NULL)
+        return;
+
+    int size = bloom_size(cfg->count);
+    while (size > bloom->capacity)
+        size >>= 1;
+    if (size == 0)
+        return;
+
+    bloom->size = size;
+    memset(bloom->words, 0, size * sizeof(uint64_t));
+
+    bool dense = cfg->keys.count == cfg->count;
+    for (int i = 0; i < cfg->count; i++) {
+        uint32_t hash = dense ? cfg->keys.hashes[i]
+                              : hash_key(entry_key(cfg, i), entry_type(cfg, i));
+        add_bloom(bloom, hash);
+    }
+}
+
+static void
+index_cfg(Cfg *cfg)
+{
+    CfgIndex *index = &cfg->index;
+
+    index_keys(cfg);
+    index_sorted(cfg);
+    index_bloom(cfg);
+
+    index->size = 0;
+    if (index->slots == NULL)
+        return;
+
+    int size = index_size(cfg->count);
+    while (size > index->capacity)
+        size >>= 1;
+
+    // The table must always have at least one empty slot
+    if (size <= cfg->count)
+        return;
+
+    fill_index(cfg, index->slots, size);
+    index->size = size;
+}
+
+static void
+move_entry(Cfg *cfg, int from, int to)
+{
+    if (cfg->compact != NULL)
+        cfg->compact[to] = cfg->compact[from];
+    else
+        cfg->entries[to] = cfg->entries[from];
+}
+
+// Drops the definitions overridden by a later one and keeps the others in
+// order. Returns the number of entries dropped, -1 if out of memory.
+static int
+dedup_entries(Cfg *cfg)
+{
+    int size = index_size(cfg->count);
+    CfgSlot *slots = cfg->index.slots;
+
+    // The index is rebuilt afterwards, so its slots can be borrowed
+    bool borrowed = slots != NULL && size <= cfg->index.capacity;
+    if (!borrowed) {
+        slots = malloc(size * sizeof(CfgSlot));
+        if (slots == NULL)
+            return -1;
+    }
+
+    // Every slot holds the last definition of a key and type. It follows the
+    // entry as it's moved down, so probing never looks at a stale position.
+    fill_index(cfg, slots, size);
+
+    int count = 0;
+    for (int i = 0; i < cfg->count; i++) {
+        const char *key = entry_key(cfg, i);
+        CfgValType type = entry_type(cfg, i);
+        uint32_t hash = hash_key(key, type);
+
+        CfgSlot *slot = probe(cfg, slots, size, hash, key, type);
+        if (slot->entry != i)
+            continue;
+
+        move_entry(cfg, i, count);
+        slot->entry = count++;
+    }
+
+    if (!borrowed)
+        free(slots);
+
+    int dropped = cfg->count - count;
+    cfg->count = count;
+    return dropped;
+}
+
+// Completes the Cfg object once all of its entries have been added
+static int
+finish_cfg(Cfg *cfg, CfgError *err)
+{
+    if ((cfg->flags & CFG_DEDUP) && dedup_entries(cfg) < 0) {
+        snprintf(err->msg, CFG_MAX_ERR, "memory allocation failed");
+        return -1;
+    }
+
+    index_cfg(cfg);
+    return 0;
+}
+
+int
+cfg_compact(Cfg *cfg)
+{
+    int dropped = dedup_entries(cfg);
+    if (dropped < 0)
+        return -1;
+
+    // The entries no longer map to the lines of the source
+    if (dropped > 0)
+        cfg->compacted = ++cfg->generation;
+    index_cfg(cfg);
+    return dropped;
+}
+
+#ifdef CFG_STATS
+static uint64_t
+now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Clears the parse statistics, the lookup counters are kept
+static void
+reset_stats(Cfg *cfg)
+{
+    CfgStats *stats = &cfg->stats;
+    stats->bytes = 0;
+    stats->comment_bytes = 0;
+    memset(stats->entries, 0, sizeof(stats->entries));
+    stats->io_ns = 0;
+    stats->parse_ns = 0;
+}
+
+static void
+count_lookup(Cfg *cfg, bool hit)
+{
+    __atomic_fetch_add(&cfg->stats.lookups, 1, __ATOMIC_RELAXED);
+    if (!hit)
+        __atomic_fetch_add(&cfg->stats.misses, 1, __ATOMIC_RELAXED);
+}
+#endif
+
+void
+cfg_get_stats(Cfg *cfg, CfgStats *stats)
+{
+    stats->bytes = cfg->stats.bytes;
+    stats->comment_bytes = cfg->stats.comment_bytes;
+    memcpy(stats->entries, cfg->stats.entries, sizeof(stats->entries));
+    stats->io_ns = cfg->stats.io_ns;
+    stats->parse_ns = cfg->stats.parse_ns;
+    stats->lookups = __atomic_load_n(&cfg->stats.lookups, __ATOMIC_RELAXED);
+    stats->misses = __atomic_load_n(&cfg->stats.misses, __ATOMIC_RELAXED);
+}
+
+// Invalidates the entries, the index and any key handle
+static void
+reset_cfg(Cfg *cfg)
+{
+    cfg->count = 0;
+    cfg->pool_len = 0;
+    cfg->index.size = 0;
+    cfg->keys.count = 0;
+    cfg->sorted.count = 0;
+    cfg->bloom.size = 0;
+    cfg->generation++;
+
+    STAT(reset_stats(cfg));
+}
+
+static int
+parse_entries(Scanner *s, Cfg *cfg, CfgError *err)
+{
+    skip_whitespace_and_comments(s);
+
+    while (!is_at_end(s) && cfg->count < cfg->capacity) {
+        CfgViewEntry view;
+        if (parse_entry(s, &view, err) != 0)
+            return -1;
+
+        if (!push_entry(s, &view, cfg))
+            break;
+        skip_whitespace_and_comments(s);
+    }
+
+    return 0;
+}
+
+int
+cfg_parse(const char *src, int src_len, Cfg *cfg, CfgError *err)
+{
+    STAT(uint64_t start = now_ns());
+
+    Scanner s;
+    init_scanner(&s, src, src_len);
+    init_error(err);
+
+    reset_cfg(cfg);
+
+    int res = parse_entries(&s, cfg, err);
+    if (res == 0)
+        res = finish_cfg(cfg, err);
+
+    STAT(cfg->stats.bytes = s.cur);
+    STAT(cfg->stats.comment_bytes = s.comments);
+    STAT(cfg->stats.parse_ns = now_ns() - start);
+    return res;
+}
+
+void
+cfg_stream_init(CfgStream *stream, Cfg *cfg)
+{
+    stream->cfg = cfg;
+    stream->buf = NULL;
+    stream->len = 0;
+    stream->capacity = 0;
+    stream->off = 0;
+    stream->row = 1;
+    stream->failed = false;
+
+    reset_cfg(cfg);
+}
+
+// Parses a sequence of complete lines starting at the current position
+// of the stream, errors are relocated from the lines to the whole stream
+static int
+parse_lines(CfgStream *stream, const char *src, int len, CfgError *err)
+{
+    Scanner s;
+    init_scanner(&s, src, len);
+
+    if (parse_entries(&s, stream->cfg, err) != 0) {
+        err->off += stream->off;
+        err->row += stream->row - 1;
+        stream->failed = true;
+        return -1;
+    }
+
+    // Rows are only counted up to the point where the Cfg became full,
+    // past that they aren't needed anymore
+    stream->row += s.row - 1;
+    stream->off += len;
+    return 0;
+}
+
+static int
+buffer_line(CfgStream *stream, const char *chunk, int len, CfgError *err)
+{
+    // Nothing to carry over, and the buffer may not even exist yet
+    if (len == 0)
+        return 0;
+
+    if (stream->len + len > stream->capacity) {
+        int capacity = stream->capacity ? stream->capacity : 256;
+        while (capacity < stream->len + len)
+            capacity *= 2;
+
+        char *buf = realloc(stream->buf, capacity);
+        if (buf == NULL) {
+            snprintf(err->msg, CFG_MAX_ERR, "memory allocation failed");
+            stream->failed = true;
+            return -1;
+        }
+        stream->buf = buf;
+        stream->capacity = capacity;
+    }
+
+    memcpy(stream->buf + stream->len, chunk, len);
+    stream->len += len;
+    return 0;
+}
+
+int
+cfg_stream_feed(CfgStream *stream, const char *chunk, int len, CfgError *err)
+{
+    init_error(err);
+
+    if (stream->failed) {
+        snprintf(err->msg, CFG_MAX_ERR, "stream failed");
+        return -1;
+    }
+
+    int line_end = scan_newline(chunk, 0, len);
+    if (line_end == len)
+        return buffer_line(stream, chunk, len, err);
+
+    // Complete the line carried over from the previous chunks
+    int start = 0;
+    if (stream->len > 0) {
+        start = line_end + 1;
+        if (buffer_line(stream, chunk, start, err) != 0)
+            return -1;
+        if (parse_lines(stream, stream->buf, stream->len, err) != 0)
+            return -1;
+        stream->len = 0;
+    }
+
+    // Parse the complete lines in place and carry over the rest
+    int end = len;
+    while (chunk[end - 1] != '\n')
+        end--;
+
+    if (parse_lines(stream, chunk + start, end - start, err) != 0)
+        return -1;
+
+    return buffer_line(stream, chunk + end, len - end, err);
+}
+
+int
+cfg_stream_finish(CfgStream *stream, CfgError *err)
+{
+    init_error(err);
+
+    int res = -1;
+    if (stream->failed)
+        snprintf(err->msg, CFG_MAX_ERR, "stream failed");
+    else
+        res = parse_lines(stream, stream->buf, stream->len, err);
+
+    free(stream->buf);
+    stream->buf = NULL;
+    stream->len = 0;
+    stream->capacity = 0;
+
+    if (res == 0)
+        res = finish_cfg(stream->cfg, err);
+    return res;
+}
+
+#define MAX_THREADS 64
+
+typedef struct {
+    const char *src;
+    int start;
+    int end;
+    int capacity;
+    CfgViewEntry *views;
+    int count;
+    int res;
+    CfgError err;
+    CfgEntry *entries;
+#ifdef CFG_STATS
+    int scanned;  // Bytes scanned, up to an error or a full shard
+    int comments;
+    uint64_t types[CFG_TYPE_COLOR + 1];
+#endif
+} Shard;
+
+static void *
+parse_shard(void *arg)
+{
+    Shard *shard = arg;
+
+    // Rows are relative to the start of the shard
+    Scanner s;
+    init_scanner(&s, shard->src, shard->end);
+    set_cur(&s, shard->start);
+    s.line = shard->start;
+    init_error(&shard->err);
+
+    shard->res = 0;
+    skip_whitespace_and_comments(&s);
+
+    while (!is_at_end(&s) && shard->count < shard->capacity) {
+        CfgViewEntry view;
+        if (parse_entry(&s, &view, &shard->err) != 0) {
+            shard->res = -1;
+            break;
+        }
+
+        // Large dumps overflow an int here, and a 32-bit size_t too
+        if (shard->count % 1024 == 0) {
+            size_t count = (size_t) shard->count + 1024;
+            CfgViewEntry *views = NULL;
+            if (count <= SIZE_MAX / sizeof(CfgViewEntry))
+                views = realloc(shard->views, count * sizeof(CfgViewEntry));
+            if (views == NULL) {
+                shard->res = error(&s, &shard->err, "memory allocation failed");
+                break;
+            }
+            shard->views = views;
+        }
+
+        shard->views[shard->count++] = view;
+        skip_whitespace_and_comments(&s);
+    }
+
+    STAT(shard->scanned = s.cur - shard->start);
+    STAT(shard->comments = s.comments);
+    return NULL;
+}
+
+static void *
+copy_shard(void *arg)
+{
+    Shard *shard = arg;
+
+    Scanner s;
+    init_scanner(&s, shard->src, shard->end);
+    for (int i = 0; i < shard->count; i++) {
+        copy_entry(&s, &shard->views[i], &shard->entries[i]);
+        STAT(shard->types[shard->views[i].type]++);
+    }
+
+    return NULL;
+}
+
+static void
+run_shards(Shard *shards, int count, void *(*fn)(void *))
+{
+    pthread_t threads[MAX_THREADS];
+    bool started[MAX_THREADS];
+
+    // The first shard runs on the calling thread
+    for (int i = 1; i < count; i++)
+        started[i] = !pthread_create(&threads[i], NULL, fn, &shards[i]);
+
+    fn(&shards[0]);
+
+    for (int i = 1; i < count; i++) {
+        if (started[i])
+            pthread_join(threads[i], NULL);
+        else
+            fn(&shards[i]);
+    }
+}
+
+int
+cfg_parse_parallel(const char *src,
+                   int src_len,
+                   Cfg *cfg,
+                   int nthreads,
+                   CfgError *err)
+{
+    // Shards can't know where their strings go in a shared pool
+    if (nthreads <= 1 || cfg->compact != NULL)
+        return cfg_parse(src, src_len, cfg, err);
+
+    if (nthreads > MAX_THREADS)
+        nthreads = MAX_THREADS;
+
+    STAT(uint64_t start_ns = now_ns());
+
+    init_error(err);
+    reset_cfg(cfg);
+
+    // Every line is a self-contained entry (comments and strings can't span
+    // lines), so the source can be split right after any newline
+    Shard shards[MAX_THREADS];
+    int start = 0;
+    for (int i = 0; i < nthreads; i++) {
+        int end = (int) ((long long) src_len * (i + 1) / nthreads);
+        if (end < start)
+            end = start;
+        if (end < src_len) {
+            end = scan_newline(src, end, src_len);
+            if (end < src_len)
+                end++;
+        }
+
+        shards[i] = (Shard){
+            .src = src,
+            .start = start,
+            .end = end,
+            .capacity = cfg->capacity,
+        };
+        start = end;
+    }
+
+    run_shards(shards, nthreads, parse_shard);
+
+    // Shards are concatenated in file order, so the last definition still
+    // wins. A sequential parse stops once the Cfg is full, so errors past
+    // that point are ignored.
+    int res = 0;
+    int count = 0;
+    STAT(int used = nthreads);
+    for (int i = 0; i < nthreads; i++) {
+        Shard *shard = &shards[i];
+        if (count + shard->count > cfg->capacity)
+            shard->count = cfg->capacity - count;
+
+        shard->entries = &cfg->entries[count];
+        count += shard->count;
+
+        if (shard->res != 0 && count < cfg->capacity) {
+            *err = shard->err;
+            for (int j = 0; j < shard->start; j++) {
+                if (src[j] == '\n')
+                    err->row++;
+            }
+            res = -1;
+        }
+
+        if (res != 0 || count == cfg->capacity) {
+            for (int j = i + 1; j < nthreads; j++)
+                shards[j].count = 0;
+            STAT(used = i + 1);
+            break;
+        }
+    }
+
+    run_shards(shards, nthreads, copy_shard);
+    cfg->count = count;
+
+    // Like a sequential parse, stop counting at the shard which ends it
+#ifdef CFG_STATS
+    for (int i = 0; i < used; i++) {
+        cfg->stats.bytes += shards[i].scanned;
+        cfg->stats.comment_bytes += shards[i].comments;
+        for (int type = 0; type <= CFG_TYPE_COLOR; type++)
+            cfg->stats.entries[type] += shards[i].types[type];
+    }
+#endif
+
+    for (int i = 0; i < nthreads; i++)
+        free(shards[i].views);
+
+    if (res == 0)
+        res = finish_cfg(cfg, err);
+
+    STAT(cfg->stats.parse_ns = now_ns() - start_ns);
+    return res;
+}
+
+int
+cfg_parse_view(const char *src, int src_len, CfgView *view, CfgError *err)
+{
+    Scanner s;
+    init_scanner(&s, src, src_len);
+    init_error(err);
+
+    // Slices have no fixed-size buffer to fit in
+    s.max_key = INT_MAX;
+    s.max_val = INT_MAX;
+
+    view->src = src;
+    view->count = 0;
+    skip_whitespace_and_comments(&s);
+
+    while (!is_at_end(&s) && view->count < view->capacity) {
+        CfgViewEntry *entry = &view->entries[view->count];
+
+        if (parse_entry(&s, entry, err) != 0)
+            return -1;
+
+        view->count++;
+        skip_whitespace_and_comments(&s);
+    }
+
+    return 0;
+}
+
+struct CfgBlock {
+    CfgBlock *next;
+    int size;
+    int used;
+    char data[];
+};
+
+static CfgBlock *
+new_block(CfgArena *arena, int size)
+{
+    CfgBlock *block = malloc(sizeof(CfgBlock) + size);
+    if (block == NULL)
+        return NULL;
+
+    block->next = arena->blocks;
+    block->size = size;
+    block->used = 0;
+
+    arena->blocks = block;
+    arena->allocs++;
+    return block;
+}
+
+static void
+free_blocks(CfgArena *arena)
+{
+    CfgBlock *block = arena->blocks;
+    while (block != NULL) {
+        CfgBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->blocks = NULL;
+}
+
+static void
+reset_arena(CfgArena *arena)
+{
+    if (arena->blocks == NULL)
+        return;
+
+    if (arena->blocks->next == NULL) {
+        arena->blocks->used = 0;
+        return;
+    }
+
+    // Merge the blocks, so that parsing the same
+    // source again doesn't need any allocation
+    int total = 0;
+    for (CfgBlock *block = arena->blocks; block; block = block->next)
+        total += block->size;
+
+    free_blocks(arena);
+    new_block(arena, total);
+}
+
+static void *
+arena_alloc(CfgArena *arena, int size)
+{
+    // Keep every allocation pointer-aligned
+    size = (size + 7) & ~7;
+
+    CfgBlock *block = arena->blocks;
+    if (block == NULL || block->size - block->used < size) {
+        if (arena->block_size <= 0)
+            arena->block_size = CFG_ARENA_BLOCK_SIZE;
+
+        block = new_block(arena, size > arena->block_size ? size
+                                                          : arena->block_size);
+        if (block == NULL)
+            return NULL;
+    }
+
+    void *ptr = block->data + block->used;
+    block->used += size;
+    return ptr;
+}
+
+static char *
+arena_copy_slice(Scanner *s, CfgArena *arena, CfgSlice slice)
+{
+    char *dst = arena_alloc(arena, slice.len + 1);
+    if (dst == NULL)
+        return NULL;
+
+    copy_slice_into(s, slice.off, slice.len, dst, slice.len + 1);
+    return dst;
+}
+
+static CfgArenaEntry *
+push_arena_entry(CfgArena *arena)
+{
+    if (arena->count == arena->capacity) {
+        // The old array is left in the arena, growing
+        // geometrically bounds the waste to the final size
+        int capacity = arena->capacity ? 2 * arena->capacity : 16;
+        CfgArenaEntry *entries =
+            arena_alloc(arena, capacity * sizeof(CfgArenaEntry));
+        if (entries == NULL)
+            return NULL;
+
+        if (arena->count > 0)
+            memcpy(entries, arena->entries,
+                   arena->count * sizeof(CfgArenaEntry));
+
+        arena->entries = entries;
+        arena->capacity = capacity;
+    }
+    return &arena->entries[arena->count++];
+}
+
+int
+cfg_parse_arena(const char *src, int src_len, CfgArena *arena, CfgError *err)
+{
+    Scanner s;
+    init_scanner(&s, src, src_len);
+    init_error(err);
+
+    s.max_key = INT_MAX;
+    s.max_val = INT_MAX;
+
+    reset_arena(arena);
+    arena->entries = NULL;
+    arena->count = 0;
+    arena->capacity = 0;
+    skip_whitespace_and_comments(&s);
+
+    while (!is_at_end(&s)) {
+        CfgViewEntry view;
+        if (parse_entry(&s, &view, err) != 0)
+            return -1;
+
+        CfgArenaEntry *entry = push_arena_entry(arena);
+        if (entry == NULL)
+            return error(&s, err, "memory allocation failed");
+
+        entry->type = view.type;
+        entry->key = arena_copy_slice(&s, arena, view.key);
+        if (entry->key == NULL)
+            return error(&s, err, "memory allocation failed");
+
+        switch (view.type) {
+        case CFG_TYPE_STRING:
+            entry->val.string = arena_copy_slice(&s, arena, view.val.string);
+            if (entry->val.string == NULL)
+                return error(&s, err, "memory allocation failed");
+            break;
+        case CFG_TYPE_BOOL:
+            entry->val.boolean = view.val.boolean;
+            break;
+        case CFG_TYPE_INT:
+            entry->val.integer = view.val.integer;
+            break;
+        case CFG_TYPE_FLOAT:
+            entry->val.floating = view.val.floating;
+            break;
+        case CFG_TYPE_COLOR:
+            entry->val.color = view.val.color;
+            break;
+        }
+
+        skip_whitespace_and_comments(&s);
+    }
+
+    return 0;
+}
+
+void
+cfg_arena_free(CfgArena *arena)
+{
+    free_blocks(arena);
+    arena->entries = NULL;
+    arena->count = 0;
+    arena->capacity = 0;
+}
+
+typedef struct {
+    char *src;
+    int len;
+    bool mapped;
+} SrcFile;
+
+// The size is only a hint, as pipes and special files have none and regular
+// files can grow while they're read
+static int
+read_stream(FILE *stream, long long size, SrcFile *file, char *err)
+{
+    int capacity = size >= 4096 && size < INT_MAX ? size + 1 : 4096;
+    int len = 0;
+    char *src = malloc(capacity);
+    if (src == NULL) {
+        snprintf(err, CFG_MAX_ERR, "memory allocation failed");
+        return -1;
+    }
+
+    for (;;) {
+        if (len == capacity) {
+            if (capacity > INT_MAX / 2) {
+                free(src);
+                snprintf(err, CFG_MAX_ERR, "file too large");
+                return -1;
+            }
+
+            char *tmp = realloc(src, 2 * capacity);
+            if (tmp == NULL) {
+                free(src);
+                snprintf(err, CFG_MAX_ERR, "memory allocation failed");
+                return -1;
+            }
+            src = tmp;
+            capacity *= 2;
+        }
+
+        size_t bytes_read = fread(src + len, sizeof(char), capacity - len,
+                                  stream);
+        len += bytes_read;
+
+        if (bytes_read == 0) {
+            if (ferror(stream)) {
+                free(src);
+                snprintf(err, CFG_MAX_ERR, "failed to read file");
+                return -1;
+            }
+            break;
+        }
+    }
+
+    file->src = src;
+    file->len = len;
+    file->mapped = false;
+    return 0;
+}
+
+// Regular files are only mapped if 'map' is set: reading a mapping past the
+// end of a file truncated in the meantime raises SIGBUS, so the caller must
+// know that the file isn't rewritten while it's in use
+static int
+load_file(const char *filename, bool map, SrcFile *file, char *err)
+{
+#ifdef CFG_MMAP
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        snprintf(err, CFG_MAX_ERR, "failed to open file");
+        return -1;
+    }
+
+    struct stat st;
+    long long size = 0;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode))
+        size = st.st_size;
+
+    // Mapped files are parsed straight out of the page cache
+    if (map && size > 0) {
+        if (size > INT_MAX) {
+            close(fd);
+            snprintf(err, CFG_MAX_ERR, "file too large");
+            return -1;
+        }
+
+        void *src = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (src != MAP_FAILED) {
+            close(fd);
+            madvise(src, size, MADV_SEQUENTIAL);
+
+            file->src = src;
+            file->len = size;
+            file->mapped = true;
+            return 0;
+        }
+    }
+
+    FILE *stream = fdopen(fd, "rb");
+    if (stream == NULL) {
+        close(fd);
+        snprintf(err, CFG_MAX_ERR, "failed to open file");
+        return -1;
+    }
+#else
+    (void) map;
+    long long size = 0;
+
+    FILE *stream = fopen(filename, "rb");
+    if (stream == NULL) {
+        snprintf(err, CFG_MAX_ERR, "failed to open file");
+        return -1;
+    }
+#endif
+
+    int res = read_stream(stream, size, file, err);
+    fclose(stream);
+    return res;
+}
+
+static void
+unload_file(SrcFile *file)
+{
+#ifdef CFG_MMAP
+    if (file->mapped) {
+        munmap(file->src, file->len);
+        return;
+    }
+#endif
+    free(file->src);
+}
+
+static int
+check_filename(const char *filename, CfgError *err)
+{
+    size_t len = strlen(filename);
+    if (len < 5) {
+        snprintf(err->msg, CFG_MAX_ERR, "invalid filename");
+        return -1;
+    }
+
+    const char *ext = filename + (len - (sizeof(CFG_FILE_EXT) - 1));
+    if (strcmp(ext, CFG_FILE_EXT) != 0) {
+        snprintf(err->msg, CFG_MAX_ERR, "invalid file extension");
+        return -1;
+    }
+
+    return 0;
+}
+
+int
+cfg_parse_file(const char *filename, Cfg *cfg, CfgError *err)
+{
+    init_error(err);
+
+    if (check_filename(filename, err) != 0)
+        return -1;
+
+    // A mapped file is only read as it's parsed
+    STAT(uint64_t start = now_ns());
+
+    SrcFile file;
+    bool map = cfg->flags & CFG_MAP_FILE;
+    if (load_file(filename, map, &file, err->msg) != 0)
+        return -1;
+
+    STAT(uint64_t io_ns = now_ns() - start);
+    int res = cfg_parse(file.src, file.len, cfg, err);
+    STAT(cfg->stats.io_ns = io_ns);
+
+    unload_file(&file);
+    return res;
+}
+
+static int
+count_lines(const char *src, int len)
+{
+    int lines = 1;
+    for (int i = 0; i < len; i++)
+        lines += src[i] == '\n';
+    return lines;
+}
+
+// Reads a whole file into a buffer which is reused from file to file, so
+// loading many small files costs no allocation nor mapping per file
+static int
+read_file(const char *filename, char **buf, int *capacity, int *len, char *err)
+{
+#ifdef CFG_MMAP
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        snprintf(err, CFG_MAX_ERR, "failed to open file");
+        return -1;
+    }
+
+    // The size is only a hint, the file is read until the end anyway
+    struct stat st;
+    long long size = 0;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode))
+        size = st.st_size;
+
+    *len = 0;
+    for (;;) {
+        if (*len == *capacity || size >= *capacity) {
+            long long grown = *capacity ? 2LL * *capacity : 4096;
+            if (grown <= size)
+                grown = size + 1;
+            if (grown > INT_MAX) {
+                close(fd);
+                snprintf(err, CFG_MAX_ERR, "file too large");
+                return -1;
+            }
+
+            char *tmp = realloc(*buf, grown);
+            if (tmp == NULL) {
+                close(fd);
+                snprintf(err, CFG_MAX_ERR, "memory allocation failed");
+                return -1;
+            }
+            *buf = tmp;
+            *capacity = grown;
+        }
+
+        ssize_t bytes_read = read(fd, *buf + *len, *capacity - *len);
+        if (bytes_read < 0 && errno == EINTR)
+            continue;
+        if (bytes_read < 0) {
+            close(fd);
+            snprintf(err, CFG_MAX_ERR, "failed to read file");
+            return -1;
+        }
+        if (bytes_read == 0)
+            break;
+        *len += bytes_read;
+    }
+
+    close(fd);
+    return 0;
+#else
+    SrcFile file;
+    if (load_file(filename, false, &file, err) != 0)
+        return -1;
+
+    if (file.len > *capacity) {
+        char *tmp = realloc(*buf, file.len);
+        if (tmp == NULL) {
+            unload_file(&file);
+            snprintf(err, CFG_MAX_ERR, "memory allocation failed");
+            return -1;
+        }
+        *buf = tmp;
+        *capacity = file.len;
+    }
+
+    memcpy(*buf, file.src, file.len);
+    *len = file.len;
+    unload_file(&file);
+    return 0;
+#endif
+}
+
+typedef struct {
+    const char *const *paths;
+    int count;
+    Cfg *cfgs;
+    CfgError *errs;
+    CfgArena *arena;
+    unsigned flags;
+    pthread_mutex_t lock;  // Guards the arena
+    atomic_int next;
+    atomic_bool failed;
+} Batch;
+
+static int
+load_batch_file(Batch *batch, int i, char **buf, int *capacity)
+{
+    Cfg *cfg = &batch->cfgs[i];
+    CfgError *err = &batch->errs[i];
+
+    init_error(err);
+    *cfg = (Cfg){.flags = batch->flags};
+
+    if (check_filename(batch->paths[i], err) != 0)
+        return -1;
+
+    STAT(uint64_t start = now_ns());
+
+    int len;
+    if (read_file(batch->paths[i], buf, capacity, &len, err->msg) != 0)
+        return -1;
+
+    STAT(uint64_t io_ns = now_ns() - start);
+
+    // Room for an entry per line, so nothing is truncated
+    int lines = count_lines(*buf, len);
+
+    if (lines > (INT_MAX - len) / (int) sizeof(CfgCompactEntry)) {
+        snprintf(err->msg, CFG_MAX_ERR, "file too large");
+        return -1;
+    }
+    int entries = lines * sizeof(CfgCompactEntry);
+
+    pthread_mutex_lock(&batch->lock);
+    char *mem = arena_alloc(batch->arena, entries + len);
+    pthread_mutex_unlock(&batch->lock);
+
+    if (mem == NULL) {
+        snprintf(err->msg, CFG_MAX_ERR, "memory allocation failed");
+        return -1;
+    }
+
+    cfg->compact = (CfgCompactEntry *) mem;
+    cfg->capacity = lines;
+    cfg->pool = mem + entries;
+    cfg->pool_capacity = len;
+
+    int res = cfg_parse(*buf, len, cfg, err);
+    STAT(cfg->stats.io_ns = io_ns);
+    return res;
+}
+
+static void *
+load_batch(void *arg)
+{
+    Batch *batch = arg;
+    char *buf = NULL;
+    int capacity = 0;
+
+    // Files are handed out one at a time, so a slow one doesn't hold back
+    // the others
+    for (;;) {
+        int i = atomic_fetch_add_explicit(&batch->next, 1,
+                                          memory_order_relaxed);
+        if (i >= batch->count)
+            break;
+
+        if (load_batch_file(batch, i, &buf, &capacity) != 0)
+            atomic_store_explicit(&batch->failed, true, memory_order_relaxed);
+    }
+
+    free(buf);
+    return NULL;
+}
+
+static int
+default_threads(void)
+{
+#if defined(CFG_MMAP) && defined(_SC_NPROCESSORS_ONLN)
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n > 0)
+        return n < MAX_THREADS ? n : MAX_THREADS;
+#endif
+    return 1;
+}
+
+int
+cfg_parse_files(const char *const *paths,
+                int n,
+                Cfg *cfgs,
+                CfgError *errs,
+                const CfgFilesOpts *opts)
+{
+    Batch batch = {
+        .paths = paths,
+        .count = n,
+        .cfgs = cfgs,
+        .errs = errs,
+        .arena = opts->arena,
+        .flags = opts->flags,
+    };
+    atomic_init(&batch.next, 0);
+    atomic_init(&batch.failed, false);
+
+    int nthreads = opts->nthreads > 0 ? opts->nthreads : default_threads();
+    if (nthreads > MAX_THREADS)
+        nthreads = MAX_THREADS;
+    if (nthreads > n)
+        nthreads = n;
+
+    reset_arena(opts->arena);
+    opts->arena->entries = NULL;
+    opts->arena->count = 0;
+    opts->arena->capacity = 0;
+    pthread_mutex_init(&batch.lock, NULL);
+
+    // The calling thread loads files too, so it's fine if no thread starts
+    pthread_t threads[MAX_THREADS];
+    bool started[MAX_THREADS];
+    for (int i = 1; i < nthreads; i++)
+        started[i] = !pthread_create(&threads[i], NULL, load_batch, &batch);
+
+    load_batch(&batch);
+
+    for (int i = 1; i < nthreads; i++) {
+        if (started[i])
+            pthread_join(threads[i], NULL);
+    }
+
+    pthread_mutex_destroy(&batch.lock);
+    return atomic_load(&batch.failed) ? -1 : 0;
+}
+
+// Binary snapshots are little-endian regardless of the host:
+//
+//   header   "SCFG", version, entry count, slot count, string table size
+//   entries  key offset, type, two value words (16 bytes each)
+//   slots    hash, entry or 0xFFFFFFFF if empty (8 bytes each)
+//   strings  NUL-terminated keys and strings
+//
+// Strings are stored as offset and length, floats as their IEEE-754 bits
+// and colors as R, G, B, A bytes.
+
+#define BIN_MAGIC "SCFG"
+#define BIN_VERSION 1
+#define BIN_HEADER 20
+#define BIN_ENTRY 16
+#define BIN_SLOT 8
+
+static void
+put_u32(uint8_t *dst, uint32_t n)
+{
+    dst[0] = n;
+    dst[1] = n >> 8;
+    dst[2] = n >> 16;
+    dst[3] = n >> 24;
+}
+
+static uint32_t
+get_u32(const uint8_t *src)
+{
+    return (uint32_t) src[0] | (uint32_t) src[1] << 8 |
+           (uint32_t) src[2] << 16 | (uint32_t) src[3] << 24;
+}
+
+static uint32_t
+put_string(uint8_t *table, uint32_t *len, const char *str)
+{
+    uint32_t off = *len;
+    int n = strlen(str) + 1;
+    memcpy(table + off, str, n);
+    *len += n;
+    return off;
+}
+
+int
+cfg_save_binary(Cfg *cfg, const char *filename, CfgError *err)
+{
+    init_error(err);
+
+    int slots = index_size(cfg->count);
+    size_t strings = 0;
+    for (int i = 0; i < cfg->count; i++) {
+        strings += strlen(entry_key(cfg, i)) + 1;
+        if (entry_type(cfg, i) == CFG_TYPE_STRING)
+            strings += strlen(entry_val(cfg, i)) + 1;
+    }
+
+    size_t size = BIN_HEADER + (size_t) cfg->count * BIN_ENTRY +
+                  (size_t) slots * BIN_SLOT + strings;
+    uint8_t *buf = malloc(size);
+    CfgSlot *index = malloc(slots * sizeof(CfgSlot));
+    if (buf == NULL || index == NULL) {
+        free(buf);
+        free(index);
+        snprintf(err->msg, CFG_MAX_ERR, "memory allocation failed");
+        return -1;
+    }
+
+    memcpy(buf, BIN_MAGIC, 4);
+    put_u32(buf + 4, BIN_VERSION);
+    put_u32(buf + 8, cfg->count);
+    put_u32(buf + 12, slots);
+    put_u32(buf + 16, strings);
+
+    uint8_t *entries = buf + BIN_HEADER;
+    uint8_t *table = entries + cfg->count * BIN_ENTRY + slots * BIN_SLOT;
+    uint32_t table_len = 0;
+
+    for (int i = 0; i < cfg->count; i++) {
+        CfgValType type = entry_type(cfg, i);
+        void *entry_value = entry_val(cfg, i);
+        uint8_t *dst = entries + i * BIN_ENTRY;
+        uint32_t val[2] = {0, 0};
+
+        switch (type) {
+        case CFG_TYPE_STRING:
+            val[1] = strlen(entry_value);
+            val[0] = put_string(table, &table_len, entry_value);
+            break;
+        case CFG_TYPE_BOOL:
+            val[0] = *(bool *) entry_value;
+            break;
+        case CFG_TYPE_INT:
+            val[0] = (uint32_t) *(int *) entry_value;
+            break;
+        case CFG_TYPE_FLOAT:
+            memcpy(&val[0], entry_value, sizeof(uint32_t));
+            break;
+        case CFG_TYPE_COLOR:;
+            CfgColor c = *(CfgColor *) entry_value;
+            val[0] = c.r | c.g << 8 | c.b << 16 | (uint32_t) c.a << 24;
+            break;
+        }
+
+        put_u32(dst, put_string(table, &table_len, entry_key(cfg, i)));
+        put_u32(dst + 4, type);
+        put_u32(dst + 8, val[0]);
+        put_u32(dst + 12, val[1]);
+    }
+
+    fill_index(cfg, index, slots);
+    uint8_t *dst = entries + cfg->count * BIN_ENTRY;
+    for (int i = 0; i < slots; i++) {
+        put_u32(dst + i * BIN_SLOT, index[i].hash);
+        put_u32(dst + i * BIN_SLOT + 4, index[i].entry);
+    }
+    free(index);
+
+    FILE *file = fopen(filename, "wb");
+    if (file == NULL) {
+        free(buf);
+        snprintf(err->msg, CFG_MAX_ERR, "failed to open file");
+        return -1;
+    }
+
+    size_t written = fwrite(buf, 1, size, file);
+    int res = fclose(file);
+    free(buf);
+
+    if (written != size || res != 0) {
+        snprintf(err->msg, CFG_MAX_ERR, "failed to write file");
+        return -1;
+    }
+    return 0;
+}
+
+// Checks that the string at 'off' is NUL-terminated within the table
+// and no longer than 'max'
+static const char *
+get_string(const uint8_t *table, uint32_t table_len, uint32_t off, int max)
+{
+    if (off >= table_len)
+        return NULL;
+
+    const char *str = (const char *) table + off;
+    const char *end = memchr(str, '\0', table_len - off);
+    if (end == NULL || end - str > max)
+        return NULL;
+    return str;
+}
+
+static int
+decode_binary(const uint8_t *buf, int len, Cfg *cfg, CfgError *err)
+{
+    if (len < BIN_HEADER || memcmp(buf, BIN_MAGIC, 4) != 0) {
+        snprintf(err->msg, CFG_MAX_ERR, "invalid binary file");
+        return -1;
+    }
+
+    if (get_u32(buf + 4) != BIN_VERSION) {
+        snprintf(err->msg, CFG_MAX_ERR, "unsupported binary version");
+        return -1;
+    }
+
+    uint32_t count = get_u32(buf + 8);
+    uint32_t slots = get_u32(buf + 12);
+    uint32_t strings = get_u32(buf + 16);
+
+    if (count > INT_MAX / BIN_ENTRY || slots > INT_MAX / BIN_SLOT ||
+        (slots & (slots - 1)) != 0 || slots <= count ||
+        (uint64_t) BIN_HEADER + count * BIN_ENTRY + slots * BIN_SLOT +
+                strings !=
+            (uint64_t) len) {
+        snprintf(err->msg, CFG_MAX_ERR, "invalid binary file");
+        return -1;
+    }
+
+    const uint8_t *entries = buf + BIN_HEADER;
+    const uint8_t *index = entries + count * BIN_ENTRY;
+    const uint8_t *table = index + slots * BIN_SLOT;
+
+    reset_cfg(cfg);
+
+    // Keys and strings are copied out of the table like out of a source
+    Scanner s;
+    init_scanner(&s, (const char *) table, strings);
+
+    for (uint32_t i = 0; i < count; i++) {
+        const uint8_t *src = entries + i * BIN_ENTRY;
+        CfgViewEntry view;
+
+        const char *key = get_string(table, strings, get_u32(src), CFG_MAX_KEY);
+        if (key == NULL) {
+            snprintf(err->msg, CFG_MAX_ERR, "invalid binary file");
+            return -1;
+        }
+        view.key = (CfgSlice){get_u32(src), strlen(key)};
+
+        uint32_t val = get_u32(src + 8);
+        view.type = get_u32(src + 4);
+
+        switch (view.type) {
+        case CFG_TYPE_STRING:;
+            const char *str = get_string(table, strings, val, CFG_MAX_VAL);
+            if (str == NULL) {
+                snprintf(err->msg, CFG_MAX_ERR, "invalid binary file");
+                return -1;
+            }
+            view.val.string = (CfgSlice){val, strlen(str)};
+            break;
+        case CFG_TYPE_BOOL:
+            view.val.boolean = val != 0;
+            break;
+        case CFG_TYPE_INT:
+            view.val.integer = (int) val;
+            break;
+        case CFG_TYPE_FLOAT:
+            memcpy(&view.val.floating, &val, sizeof(float));
+            break;
+        case CFG_TYPE_COLOR:
+            view.val.color = (CfgColor){
+                .r = val,
+                .g = val >> 8,
+                .b = val >> 16,
+                .a = val >> 24,
+            };
+            break;
+        default:
+            snprintf(err->msg, CFG_MAX_ERR, "invalid binary file");
+            return -1;
+        }
+
+        if (!push_entry(&s, &view, cfg))
+            break;
+    }
+
+    // Use the prebuilt index if it fits and describes all the entries
+    CfgIndex *cfg_index = &cfg->index;
+    if (cfg_index->slots == NULL || (uint32_t) cfg->count != count ||
+        slots > (uint32_t) cfg_index->capacity || (cfg->flags & CFG_DEDUP))
+        return finish_cfg(cfg, err);
+
+    uint32_t empty = 0;
+    for (uint32_t i = 0; i < slots; i++) {
+        CfgSlot *slot = &cfg_index->slots[i];
+        slot->hash = get_u32(index + i * BIN_SLOT);
+        slot->entry = (int) get_u32(index + i * BIN_SLOT + 4);
+        if (slot->entry < -1 || slot->entry >= cfg->count) {
+            snprintf(err->msg, CFG_MAX_ERR, "invalid binary file");
+            return -1;
+        }
+        empty += slot->entry == -1;
+    }
+
+    // Probing must end, and must find the last definition of every entry.
+    // Lookups probe the same way, so then the index answers them all as if
+    // it had been built here, stray slots notwithstanding.
+    if (empty == 0) {
+        snprintf(err->msg, CFG_MAX_ERR, "invalid binary file");
+        return -1;
+    }
+
+    for (int i = 0; i < cfg->count; i++) {
+        const char *key = entry_key(cfg, i);
+        CfgValType type = entry_type(cfg, i);
+        uint32_t hash = hash_key(key, type);
+
+        CfgSlot *slot = probe(cfg, cfg_index->slots, slots, hash, key, type);
+        if (slot->entry < i) {
+            snprintf(err->msg, CFG_MAX_ERR, "invalid binary file");
+            return -1;
+        }
+    }
+    cfg_index->size = slots;
+    index_keys(cfg);
+    index_sorted(cfg);
+    index_bloom(cfg);
+    return 0;
+}
+
+int
+cfg_load_binary(const char *filename, Cfg *cfg, CfgError *err)
+{
+    init_error(err);
+
+    SrcFile file;
+    bool map = cfg->flags & CFG_MAP_FILE;
+    if (load_file(filename, map, &file, err->msg) != 0)
+        return -1;
+
+    int res = decode_binary((const uint8_t *) file.src, file.len, cfg, err);
+
+    unload_file(&file);
+    return res;
+}
+
+struct CfgSnapshot {
+    atomic_int refs;
+    Cfg cfg;
+};
+
+// Gives every snapshot its own generation, so that handles resolved against
+// one snapshot are rejected by the others
+static atomic_uint snapshot_generation;
+
+// Allocates a snapshot in one block along with its entries and index slots
+static CfgSnapshot *
+new_snapshot(int capacity)
+{
+    size_t entries = (size_t) capacity * sizeof(CfgEntry);
+    size_t slots = (size_t) CFG_INDEX_CAPACITY(capacity) * sizeof(CfgSlot);
+
+    CfgSnapshot *snapshot = malloc(sizeof(CfgSnapshot) + entries + slots);
+    if (snapshot == NULL)
+        return NULL;
+
+    atomic_init(&snapshot->refs, 1);
+    snapshot->cfg = (Cfg){
+        .entries = (CfgEntry *) (snapshot + 1),
+        .capacity = capacity,
+        .index = {
+            .slots = (CfgSlot *) ((char *) (snapshot + 1) + entries),
+            .capacity = CFG_INDEX_CAPACITY(capacity),
+        },
+        .generation = atomic_fetch_add(&snapshot_generation, 1),
+    };
+    return snapshot;
+}
+
+CfgSnapshot *
+cfg_snapshot_parse(const char *src, int src_len, CfgError *err)
+{
+    init_error(err);
+
+    // Room for an entry per line, so nothing is truncated
+    int lines = count_lines(src, src_len);
+
+    CfgSnapshot *snapshot = new_snapshot(lines);
+    if (snapshot == NULL) {
+        snprintf(err->msg, CFG_MAX_ERR, "out of memory");
+        return NULL;
+    }
+
+    if (cfg_parse(src, src_len, &snapshot->cfg, err) != 0) {
+        free(snapshot);
+        return NULL;
+    }
+    return snapshot;
+}
+
+CfgSnapshot *
+cfg_snapshot_parse_file(const char *filename, CfgError *err)
+{
+    init_error(err);
+
+    if (check_filename(filename, err) != 0)
+        return NULL;
+
+    SrcFile file;
+    if (load_file(filename, false, &file, err->msg) != 0)
+        return NULL;
+
+    CfgSnapshot *snapshot = cfg_snapshot_parse(file.src, file.len, err);
+
+    unload_file(&file);
+    return snapshot;
+}
+
+CfgSnapshot *
+cfg_snapshot_acquire(CfgSnapshot *snapshot)
+{
+    atomic_fetch_add_explicit(&snapshot->refs, 1, memory_order_relaxed);
+    return snapshot;
+}
+
+void
+cfg_snapshot_release(CfgSnapshot *snapshot)
+{
+    if (snapshot == NULL)
+        return;
+
+    // The last release must see the writes of all the others
+    if (atomic_fetch_sub_explicit(&snapshot->refs, 1,
+                                  memory_order_acq_rel) == 1)
+        free(snapshot);
+}
+
+Cfg *
+cfg_snapshot_cfg(CfgSnapshot *snapshot)
+{
+    return &snapshot->cfg;
+}
+
+struct CfgShared {
+    _Atomic(CfgSnapshot *) current;
+    atomic_uint epoch;
+    atomic_int readers[2];
+    pthread_mutex_t publish;
+};
+
+static void
+init_shared(CfgShared *shared, CfgSnapshot *snapshot)
+{
+    atomic_init(&shared->current, snapshot);
+    atomic_init(&shared->epoch, 0);
+    atomic_init(&shared->readers[0], 0);
+    atomic_init(&shared->readers[1], 0);
+    pthread_mutex_init(&shared->publish, NULL);
+}
+
+static void
+destroy_shared(CfgShared *shared)
+{
+    cfg_snapshot_release(atomic_load(&shared->current));
+    pthread_mutex_destroy(&shared->publish);
+}
+
+// Readers register in the counter of the current epoch parity before loading
+// the pointer, so the current snapshot can't be released while they're
+// inside a read-side section
+static CfgSnapshot *
+enter_shared(CfgShared *shared, int *epoch)
+{
+    *epoch = atomic_load(&shared->epoch) & 1;
+    atomic_fetch_add(&shared->readers[*epoch], 1);
+    return atomic_load(&shared->current);
+}
+
+static void
+exit_shared(CfgShared *shared, int epoch)
+{
+    atomic_fetch_sub(&shared->readers[epoch], 1);
+}
+
+// Once a new snapshot is published, any reader still holding the old one is
+// counted in either parity. Flipping the epoch and draining the old parity,
+// twice, waits for all of them, while readers arriving in the meantime
+// register in the other counter and can't starve the writer.
+static void
+wait_for_readers(CfgShared *shared)
+{
+    for (int i = 0; i < 2; i++) {
+        unsigned epoch = atomic_fetch_add(&shared->epoch, 1);
+        while (atomic_load(&shared->readers[epoch & 1]) != 0)
+            sched_yield();
+    }
+}
+
+CfgShared *
+cfg_shared_new(CfgSnapshot *snapshot)
+{
+    CfgShared *shared = malloc(sizeof(CfgShared));
+    if (shared == NULL)
+        return NULL;
+
+    init_shared(shared, snapshot);
+    return shared;
+}
+
+void
+cfg_shared_free(CfgShared *shared)
+{
+    if (shared == NULL)
+        return;
+
+    destroy_shared(shared);
+    free(shared);
+}
+
+CfgSnapshot *
+cfg_shared_acquire(CfgShared *shared)
+{
+    int epoch;
+    CfgSnapshot *snapshot = enter_shared(shared, &epoch);
+    cfg_snapshot_acquire(snapshot);
+    exit_shared(shared, epoch);
+    return snapshot;
+}
+
+void
+cfg_shared_publish(CfgShared *shared, CfgSnapshot *snapshot)
+{
+    pthread_mutex_lock(&shared->publish);
+    CfgSnapshot *old = atomic_exchange(&shared->current, snapshot);
+    wait_for_readers(shared);
+    pthread_mutex_unlock(&shared->publish);
+
+    cfg_snapshot_release(old);
+}
+
+#ifdef CFG_INOTIFY
+struct CfgWatcher {
+    const char *name;  // Last component of the filename
+    CfgReloadFn on_reload;
+    void *user;
+    int inotify;
+    int stop[2];
+    pthread_t thread;
+    CfgShared shared;
+    char filename[];
+};
+
+static void
+reload(CfgWatcher *watcher)
+{
+    CfgError err;
+
+    CfgSnapshot *snapshot = cfg_snapshot_parse_file(watcher->filename, &err);
+    if (snapshot == NULL) {
+        if (watcher->on_reload != NULL)
+            watcher->on_reload(-1, &err, watcher->user);
+        return;
+    }
+
+    cfg_shared_publish(&watcher->shared, snapshot);
+
+    if (watcher->on_reload != NULL)
+        watcher->on_reload(0, &err, watcher->user);
+}
+
+
+static void *
+watch_file(void *arg)
+{
+    CfgWatcher *watcher = arg;
+    struct pollfd fds[] = {
+        {.fd = watcher->inotify, .events = POLLIN},
+        {.fd = watcher->stop[0], .events = POLLIN},
+    };
+    char buf[4096]
+        __attribute__((aligned(__alignof__(struct inotify_event))));
+
+    for (;;) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+
+        if (fds[1].revents != 0)
+            break;
+
+        ssize_t len = read(watcher->inotify, buf, sizeof(buf));
+        if (len <= 0)
+            continue;
+
+        // Editors save either in place or by renaming a temporary file, a
+        // single reload covers a whole batch of events
+        bool changed = false;
+        for (char *p = buf; p < buf + len;) {
+            struct inotify_event *event = (struct inotify_event *) p;
+            if (event->mask & IN_Q_OVERFLOW)
+                changed = true;
+            else if (event->len > 0 && strcmp(event->name, watcher->name) == 0)
+                changed = true;
+            p += sizeof(*event) + event->len;
+        }
+
+        if (changed)
+            reload(watcher);
+    }
+
+    return NULL;
+}
+
+static void
+free_watcher(CfgWatcher *watcher)
+{
+    if (watcher->inotify >= 0)
+        close(watcher->inotify);
+    if (watcher->stop[0] >= 0)
+        close(watcher->stop[0]);
+    if (watcher->stop[1] >= 0)
+        close(watcher->stop[1]);
+    free(watcher);
+}
+
+CfgWatcher *
+cfg_watch(const char *filename,
+          CfgReloadFn on_reload,
+          void *user,
+          CfgError *err)
+{
+    init_error(err);
+
+    if (check_filename(filename, err) != 0)
+        return NULL;
+
+    size_t len = strlen(filename);
+    CfgWatcher *watcher = calloc(1, sizeof(CfgWatcher) + len + 1);
+    if (watcher == NULL) {
+        snprintf(err->msg, CFG_MAX_ERR, "out of memory");
+        return NULL;
+    }
+
+    memcpy(watcher->filename, filename, len + 1);
+    watcher->on_reload = on_reload;
+    watcher->user = user;
+    watcher->stop[0] = watcher->stop[1] = -1;
+
+    // The directory is watched rather than the file, which may be replaced
+    const char *slash = strrchr(filename, '/');
+    watcher->name = watcher->filename + (slash ? slash - filename + 1 : 0);
+
+    char dir[PATH_MAX];
+    if (slash == NULL)
+        snprintf(dir, sizeof(dir), ".");
+    else if (slash == filename)
+        snprintf(dir, sizeof(dir), "/");
+    else
+        snprintf(dir, sizeof(dir), "%.*s", (int) (slash - filename), filename);
+
+    // The watch is in place before the first load, so no change is missed
+    uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO;
+    watcher->inotify = inotify_init1(IN_CLOEXEC);
+    if (watcher->inotify < 0 ||
+        inotify_add_watch(watcher->inotify, dir, mask) < 0 ||
+        pipe(watcher->stop) != 0) {
+        free_watcher(watcher);
+        snprintf(err->msg, CFG_MAX_ERR, "failed to watch file");
+        return NULL;
+    }
+
+    CfgSnapshot *snapshot = cfg_snapshot_parse_file(filename, err);
+    if (snapshot == NULL) {
+        free_watcher(watcher);
+        return NULL;
+    }
+    init_shared(&watcher->shared, snapshot);
+
+    if (pthread_create(&watcher->thread, NULL, watch_file, watcher) != 0) {
+        destroy_shared(&watcher->shared);
+        free_watcher(watcher);
+        snprintf(err->msg, CFG_MAX_ERR, "failed to start watcher");
+        return NULL;
+    }
+
+    return watcher;
+}
+
+void
+cfg_unwatch(CfgWatcher *watcher)
+{
+    if (watcher == NULL)
+        return;
+
+    while (write(watcher->stop[1], "", 1) < 0 && errno == EINTR)
+        ;
+    pthread_join(watcher->thread, NULL);
+    destroy_shared(&watcher->shared);
+    free_watcher(watcher);
+}
+
+CfgSnapshot *
+cfg_watcher_acquire(CfgWatcher *watcher)
+{
+    return cfg_shared_acquire(&watcher->shared);
+}
+
+Cfg *
+cfg_watcher_enter(CfgWatcher *watcher, int *epoch)
+{
+    return &enter_shared(&watcher->shared, epoch)->cfg;
+}
+
+void
+cfg_watcher_exit(CfgWatcher *watcher, int epoch)
+{
+    exit_shared(&watcher->shared, epoch);
+}
+#else
+CfgWatcher *
+cfg_watch(const char *filename,
+          CfgReloadFn on_reload,
+          void *user,
+          CfgError *err)
+{
+    (void) filename;
+    (void) on_reload;
+    (void) user;
+
+    init_error(err);
+    snprintf(err->msg, CFG_MAX_ERR, "file watching not supported");
+    return NULL;
+}
+
+void
+cfg_unwatch(CfgWatcher *watcher)
+{
+    (void) watcher;
+}
+
+CfgSnapshot *
+cfg_watcher_acquire(CfgWatcher *watcher)
+{
+    (void) watcher;
+    return NULL;
+}
+
+Cfg *
+cfg_watcher_enter(CfgWatcher *watcher, int *epoch)
+{
+    (void) watcher;
+    *epoch = 0;
+    return NULL;
+}
+
+void
+cfg_watcher_exit(CfgWatcher *watcher, int epoch)
+{
+    (void) watcher;
+    (void) epoch;
+}
+#endif
+
+// The scan_hash_* functions return the position of the last hash equal to
+// 'hash' before 'end', or -1. The x86 versions compare 4 or 8 hashes at a
+// time, walking backwards so that later definitions are found first.
+
+static int
+scan_hash_scalar(const uint32_t *hashes, int end, uint32_t hash)
+{
+    while (end > 0) {
+        if (hashes[--end] == hash)
+            return end;
+    }
+    return -1;
+}
+
+#ifdef CFG_SIMD_X86
+
+static int
+scan_hash_sse2(const uint32_t *hashes, int end, uint32_t hash)
+{
+    const __m128i h = _mm_set1_epi32(hash);
+
+    for (; end >= 4; end -= 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *) (hashes + end - 4));
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, h)));
+        if (mask)
+            return end - 4 + 31 - __builtin_clz(mask);
+    }
+    return scan_hash_scalar(hashes, end, hash);
+}
+
+__attribute__((target("avx2"))) static int
+scan_hash_avx2(const uint32_t *hashes, int end, uint32_t hash)
+{
+    const __m256i h = _mm256_set1_epi32(hash);
+
+    for (; end >= 8; end -= 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i *) (hashes + end - 8));
+        int mask = _mm256_movemask_ps(
+            _mm256_castsi256_ps(_mm256_cmpeq_epi32(v, h)));
+        if (mask)
+            return end - 8 + 31 - __builtin_clz(mask);
+    }
+
+    // Calling the SSE2 version from here costs more than the whole scan of a
+    // small config, because of the switch between VEX and legacy encodings
+    if (end >= 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *) (hashes + end - 4));
+        __m128i eq = _mm_cmpeq_epi32(v, _mm256_castsi256_si128(h));
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(eq));
+        if (mask)
+            return end - 4 + 31 - __builtin_clz(mask);
+        end -= 4;
+    }
+    return scan_hash_scalar(hashes, end, hash);
+}
+
+#endif
+
+static int
+scan_hash(const uint32_t *hashes, int end, uint32_t hash)
+{
+#ifdef CFG_SIMD_X86
+    if (__builtin_cpu_supports("avx2"))
+        return scan_hash_avx2(hashes, end, hash);
+    return scan_hash_sse2(hashes, end, hash);
+#else
+    return scan_hash_scalar(hashes, end, hash);
+#endif
+}
+
+// Returns the last definition of the key and type before 'end'
+static int
+find_key(Cfg *cfg, const char *key, CfgValType type, int end)
+{
+    CfgKeys *keys = &cfg->keys;
+    uint32_t hash = hash_key(key, type);
+    size_t len = strlen(key);
+
+    int i = end;
+    while ((i = scan_hash(keys->hashes, i, hash)) != -1) {
+        if (keys->lens[i] == len && keys->types[i] == type &&
+            !memcmp(key, entry_key(cfg, i), len))
+            return i;
+    }
+    return -1;
+}
+
+static int
+find_entry(Cfg *cfg, const char *key, CfgValType type)
+{
+    CfgIndex *index = &cfg->index;
+    CfgBloom *bloom = &cfg->bloom;
+    if (index->size > 0 || bloom->size > 0) {
+        uint32_t hash = hash_key(key, type);
+        if (bloom->size > 0 && !has_bloom(bloom, hash))
+            return -1;
+        if (index->size > 0) {
+            CfgSlot *slot =
+                probe(cfg, index->slots, index->size, hash, key, type);
+            return slot->entry;
+        }
+    }
+
+    if (cfg->keys.count > 0 && cfg->keys.count == cfg->count)
+        return find_key(cfg, key, type, cfg->count);
+
+    for (int i = cfg->count - 1; i >= 0; i--) {
+        if (entry_type(cfg, i) == type && !strcmp(key, entry_key(cfg, i)))
+            return i;
+    }
+    return -1;
+}
+
+static void *
+get_val(Cfg *cfg, const char *key, void *fallback, CfgValType type)
+{
+    int i = find_entry(cfg, key, type);
+    STAT(count_lookup(cfg, i != -1));
+    if (i == -1)
+        return fallback;
+    return entry_val(cfg, i);
+}
+
+char *
+cfg_get_string(Cfg *cfg, const char *key, char *fallback)
+{
+    return (char *) get_val(cfg, key, fallback, CFG_TYPE_STRING);
+}
+
+bool
+cfg_get_bool(Cfg *cfg, const char *key, bool fallback)
+{
+    return *(bool *) get_val(cfg, key, &fallback, CFG_TYPE_BOOL);
+}
+
+int
+cfg_get_int(Cfg *cfg, const char *key, int fallback)
+{
+    return *(int *) get_val(cfg, key, &fallback, CFG_TYPE_INT);
+}
+
+int
+cfg_get_int_min(Cfg *cfg, const char *key, int fallback, int min)
+{
+    int value = cfg_get_int(cfg, key, fallback);
+    if (value < min)
+        value = fallback;
+    return value;
+}
+
+int
+cfg_get_int_max(Cfg *cfg, const char *key, int fallback, int max)
+{
+    int value = cfg_get_int(cfg, key, fallback);
+    if (value > max)
+        value = fallback;
+    return value;
+}
+
+int
+cfg_get_int_range(Cfg *cfg, const char *key, int fallback, int min, int max)
+{
+    int value = cfg_get_int(cfg, key, fallback);
+    if (value < min || value > max)
+        value = fallback;
+    return value;
+}
+
+float
+cfg_get_float(Cfg *cfg, const char *key, float fallback)
+{
+    return *(float *) get_val(cfg, key, &fallback, CFG_TYPE_FLOAT);
+}
+
+float
+cfg_get_float_min(Cfg *cfg, const char *key, float fallback, float min)
+{
+    float value = cfg_get_float(cfg, key, fallback);
+    if (value < min)
+        value = fallback;
+    return value;
+}
+
+float
+cfg_get_float_max(Cfg *cfg, const char *key, float fallback, float max)
+{
+    float value = cfg_get_float(cfg, key, fallback);
+    if (value > max)
+        value = fallback;
+    return value;
+}
+
+float
+cfg_get_float_range(Cfg *cfg,
+                    const char *key,
+                    float fallback,
+                    float min,
+                    float max)
+{
+    float value = cfg_get_float(cfg, key, fallback);
+    if (value < min || value > max)
+        value = fallback;
+    return value;
+}
+
+CfgColor
+cfg_get_color(Cfg *cfg, const char *key, CfgColor fallback)
+{
+    return *(CfgColor *) get_val(cfg, key, &fallback, CFG_TYPE_COLOR);
+}
+
+static void *
+get_view_val(CfgView *view, const char *key, void *fallback, CfgValType type)
+{
+    int key_len = strlen(key);
+
+    for (int i = view->count - 1; i >= 0; i--) {
+        CfgViewEntry *entry = &view->entries[i];
+        if (entry->type == type && entry->key.len == key_len &&
+            !memcmp(key, view->src + entry->key.off, key_len))
+            return &entry->val;
+    }
+    return fallback;
+}
+
+const char *
+cfg_view_get_string(CfgView *view,
+                    const char *key,
+                    const char *fallback,
+                    int *len)
+{
+    CfgSlice *slice = get_view_val(view, key, NULL, CFG_TYPE_STRING);
+    if (slice == NULL) {
+        if (len != NULL)
+            *len = fallback ? strlen(fallback) : 0;
+        return fallback;
+    }
+
+    if (len != NULL)
+        *len = slice->len;
+    return view->src + slice->off;
+}
+
+bool
+cfg_view_get_bool(CfgView *view, const char *key, bool fallback)
+{
+    return *(bool *) get_view_val(view, key, &fallback, CFG_TYPE_BOOL);
+}
+
+int
+cfg_view_get_int(CfgView *view, const char *key, int fallback)
+{
+    return *(int *) get_view_val(view, key, &fallback, CFG_TYPE_INT);
+}
+
+float
+cfg_view_get_float(CfgView *view, const char *key, float fallback)
+{
+    return *(float *) get_view_val(view, key, &fallback, CFG_TYPE_FLOAT);
+}
+
+CfgColor
+cfg_view_get_color(CfgView *view, const char *key, CfgColor fallback)
+{
+    return *(CfgColor *) get_view_val(view, key, &fallback, CFG_TYPE_COLOR);
+}
+
+static void *
+get_arena_val(CfgArena *arena,
+              const char *key,
+              void *fallback,
+              CfgValType type)
+{
+    for (int i = arena->count - 1; i >= 0; i--) {
+        CfgArenaEntry *entry = &arena->entries[i];
+        if (entry->type == type && !strcmp(key, entry->key))
+            return &entry->val;
+    }
+    return fallback;
+}
+
+char *
+cfg_arena_get_string(CfgArena *arena, const char *key, char *fallback)
+{
+    char **string = get_arena_val(arena, key, NULL, CFG_TYPE_STRING);
+    return string ? *string : fallback;
+}
+
+bool
+cfg_arena_get_bool(CfgArena *arena, const char *key, bool fallback)
+{
+    return *(bool *) get_arena_val(arena, key, &fallback, CFG_TYPE_BOOL);
+}
+
+int
+cfg_arena_get_int(CfgArena *arena, const char *key, int fallback)
+{
+    return *(int *) get_arena_val(arena, key, &fallback, CFG_TYPE_INT);
+}
+
+float
+cfg_arena_get_float(CfgArena *arena, const char *key, float fallback)
+{
+    return *(float *) get_arena_val(arena, key, &fallback, CFG_TYPE_FLOAT);
+}
+
+CfgColor
+cfg_arena_get_color(CfgArena *arena, const char *key, CfgColor fallback)
+{
+    return *(CfgColor *) get_arena_val(arena, key, &fallback,
+                                       CFG_TYPE_COLOR);
+}
+
+CfgKey
+cfg_key_resolve(Cfg *cfg, const char *key, CfgValType type)
+{
+    return (CfgKey){
+        .entry = find_entry(cfg, key, type),
+        .generation = cfg->generation,
+    };
+}
+
+static void *
+get_val_h(Cfg *cfg, CfgKey key, void *fallback, CfgValType type)
+{
+    bool hit = key.generation == cfg->generation && key.entry >= 0 &&
+               key.entry < cfg->count && entry_type(cfg, key.entry) == type;
+    STAT(count_lookup(cfg, hit));
+    if (!hit)
+        return fallback;
+    return entry_val(cfg, key.entry);
+}
+
+char *
+cfg_get_string_h(Cfg *cfg, CfgKey key, char *fallback)
+{
+    return (char *) get_val_h(cfg, key, fallback, CFG_TYPE_STRING);
+}
+
+bool
+cfg_get_bool_h(Cfg *cfg, CfgKey key, bool fallback)
+{
+    return *(bool *) get_val_h(cfg, key, &fallback, CFG_TYPE_BOOL);
+}
+
+int
+cfg_get_int_h(Cfg *cfg, CfgKey key, int fallback)
+{
+    return *(int *) get_val_h(cfg, key, &fallback, CFG_TYPE_INT);
+}
+
+float
+cfg_get_float_h(Cfg *cfg, CfgKey key, float fallback)
+{
+    return *(float *) get_val_h(cfg, key, &fallback, CFG_TYPE_FLOAT);
+}
+
+CfgColor
+cfg_get_color_h(Cfg *cfg, CfgKey key, CfgColor fallback)
+{
+    return *(CfgColor *) get_val_h(cfg, key, &fallback, CFG_TYPE_COLOR);
+}
+
+int
+cfg_layers_set(CfgLayers *layers, int layer, Cfg *cfg)
+{
+    if (layer < 0 || layer >= CFG_MAX_LAYERS)
+        return -1;
+
+    layers->layers[layer] = cfg;
+    if (layer >= layers->count)
+        layers->count = layer + 1;
+    while (layers->count > 0 && layers->layers[layers->count - 1] == NULL)
+        layers->count--;
+
+    layers->built = false;
+    return 0;
+}
+
+static CfgLayerSlot *
+probe_layers(CfgLayers *layers,
+             int size,
+             uint32_t hash,
+             const char *key,
+             CfgValType type)
+{
+    int mask = size - 1;
+    int j = hash & mask;
+    while (layers->slots[j].entry != -1) {
+        CfgLayerSlot *slot = &layers->slots[j];
+        Cfg *cfg = layers->layers[slot->layer];
+        if (slot->hash == hash && entry_type(cfg, slot->entry) == type &&
+            !strcmp(entry_key(cfg, slot->entry), key))
+            break;
+        j = (j + 1) & mask;
+    }
+    return &layers->slots[j];
+}
+
+static void
+build_layers(CfgLayers *layers)
+{
+    layers->size = 0;
+    layers->built = true;
+    if (layers->slots == NULL)
+        return;
+
+    int count = 0;
+    for (int l = 0; l < layers->count; l++) {
+        if (layers->layers[l] != NULL)
+            count += layers->layers[l]->count;
+    }
+
+    int size = index_size(count);
+    while (size > layers->capacity)
+        size >>= 1;
+
+    // The table must always have at least one empty slot
+    if (size <= count)
+        return;
+
+    for (int i = 0; i < size; i++)
+        layers->slots[i].entry = -1;
+
+    // Layers and entries are visited by increasing priority, so the ones
+    // which win replace the others in the same slot
+    for (int l = 0; l < layers->count; l++) {
+        Cfg *cfg = layers->layers[l];
+        for (int i = 0; cfg != NULL && i < cfg->count; i++) {
+            const char *key = entry_key(cfg, i);
+            CfgValType type = entry_type(cfg, i);
+            uint32_t hash = hash_key(key, type);
+
+            CfgLayerSlot *slot = probe_layers(layers, size, hash, key, type);
+            slot->hash = hash;
+            slot->layer = l;
+            slot->entry = i;
+        }
+    }
+    layers->size = size;
+}
+
+static void *
+get_layers_val(CfgLayers *layers,
+               const char *key,
+               void *fallback,
+               CfgValType type)
+{
+    if (!layers->built)
+        build_layers(layers);
+
+    if (layers->size > 0) {
+        uint32_t hash = hash_key(key, type);
+        CfgLayerSlot *slot = probe_layers(layers, layers->size, hash, key,
+                                          type);
+        if (slot->entry == -1)
+            return fallback;
+        return entry_val(layers->layers[slot->layer], slot->entry);
+    }
+
+    for (int l = layers->count - 1; l >= 0; l--) {
+        Cfg *cfg = layers->layers[l];
+        if (cfg == NULL)
+            continue;
+
+        int i = find_entry(cfg, key, type);
+        if (i != -1)
+            return entry_val(cfg, i);
+    }
+    return fallback;
+}
+
+char *
+cfg_layers_get_string(CfgLayers *layers, const char *key, char *fallback)
+{
+    return (char *) get_layers_val(layers, key, fallback, CFG_TYPE_STRING);
+}
+
+bool
+cfg_layers_get_bool(CfgLayers *layers, const char *key, bool fallback)
+{
+    return *(bool *) get_layers_val(layers, key, &fallback, CFG_TYPE_BOOL);
+}
+
+int
+cfg_layers_get_int(CfgLayers *layers, const char *key, int fallback)
+{
+    return *(int *) get_layers_val(layers, key, &fallback, CFG_TYPE_INT);
+}
+
+float
+cfg_layers_get_float(CfgLayers *layers, const char *key, float fallback)
+{
+    return *(float *) get_layers_val(layers, key, &fallback, CFG_TYPE_FLOAT);
+}
+
+CfgColor
+cfg_layers_get_color(CfgLayers *layers, const char *key, CfgColor fallback)
+{
+    return *(CfgColor *) get_layers_val(layers, key, &fallback,
+                                        CFG_TYPE_COLOR);
+}
+
+// The sorted index is missing if it couldn't be built or the entries were
+// added without indexing them, as by cfg_stream_feed()
+static bool
+has_sorted(Cfg *cfg)
+{
+    return cfg->sorted.count > 0 || cfg->count == 0;
+}
+
+// Returns the position of the first sorted key which isn't below the prefix
+// or, if 'past' is set, the first one after those starting with the prefix
+static int
+search_prefix(Cfg *cfg, const char *prefix, size_t len, bool past)
+{
+    int lo = 0;
+    int hi = cfg->sorted.count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        const char *key = entry_key(cfg, cfg->sorted.entries[mid]);
+        int res = strncmp(key, prefix, len);
+        if (res < 0 || (past && res == 0))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+static bool
+is_effective(Cfg *cfg, int i)
+{
+    return find_entry(cfg, entry_key(cfg, i), entry_type(cfg, i)) == i;
+}
+
+int
+cfg_iter_prefix(Cfg *cfg, const char *prefix, CfgPrefixFn fn, void *user)
+{
+    size_t len = strlen(prefix);
+    int count = 0;
+
+    if (has_sorted(cfg)) {
+        int end = search_prefix(cfg, prefix, len, true);
+        for (int j = search_prefix(cfg, prefix, len, false); j < end; j++) {
+            int i = cfg->sorted.entries[j];
+            fn(entry_key(cfg, i), entry_type(cfg, i), entry_val(cfg, i), user);
+            count++;
+        }
+        return count;
+    }
+
+    for (int i = 0; i < cfg->count; i++) {
+        const char *key = entry_key(cfg, i);
+        if (strncmp(key, prefix, len) == 0 && is_effective(cfg, i)) {
+            fn(key, entry_type(cfg, i), entry_val(cfg, i), user);
+            count++;
+        }
+    }
+    return count;
+}
+
+int
+cfg_count_prefix(Cfg *cfg, const char *prefix)
+{
+    size_t len = strlen(prefix);
+
+    if (has_sorted(cfg)) {
+        return search_prefix(cfg, prefix, len, true) -
+               search_prefix(cfg, prefix, len, false);
+    }
 
-    cfg->count = 0;
-    skip_whitespace_and_comments(&s);
+    int count = 0;
+    for (int i = 0; i < cfg->count; i++) {
+        if (strncmp(entry_key(cfg, i), prefix, len) == 0 &&
+            is_effective(cfg, i))
+            count++;
+    }
+    return count;
+}
 
-    while (!is_at_end(&s) && cfg->count < cfg->capacity) {
-        CfgEntry *entry = &cfg->entries[cfg->count];
+// Number of lines holding an entry, i.e. neither blank nor a comment
+static int
+count_entries(const char *src, int len)
+{
+    int count = 0;
+    for (int i = 0; i < len;) {
+        i = scan_blank(src, i, len);
+        if (i < len && src[i] != '\n' && src[i] != '#')
+            count++;
+        i = scan_newline(src, i, len) + 1;
+    }
+    return count;
+}
 
-        if (parse_entry(&s, entry, err) != 0)
-            return -1;
+// Lines from 'start' to the ends were edited, the rest is the same in both
+// versions of the source. All three are at the start of a line.
+typedef struct {
+    int start;
+    int old_end;
+    int new_end;
+} Edit;
 
-        cfg->count++;
-        skip_whitespace_and_comments(&s);
+static bool
+is_line_start(const char *src, int i, int start)
+{
+    return i == start || src[i - 1] == '\n';
+}
+
+static Edit
+find_edit(const char *old_src, int old_len, const char *new_src, int new_len)
+{
+    int min = old_len < new_len ? old_len : new_len;
+
+    int start = 0;
+    while (start + 64 <= min && !memcmp(old_src + start, new_src + start, 64))
+        start += 64;
+    while (start < min && old_src[start] == new_src[start])
+        start++;
+    while (start > 0 && old_src[start - 1] != '\n')
+        start--;
+
+    int suffix = 0;
+    int max = min - start;
+    while (suffix + 64 <= max &&
+           !memcmp(old_src + old_len - suffix - 64,
+                   new_src + new_len - suffix - 64, 64))
+        suffix += 64;
+    while (suffix < max &&
+           old_src[old_len - suffix - 1] == new_src[new_len - suffix - 1])
+        suffix++;
+
+    // The rest must start a line in both versions
+    Edit edit = {start, old_len - suffix, new_len - suffix};
+    while (edit.old_end < old_len &&
+           (!is_line_start(old_src, edit.old_end, start) ||
+            !is_line_start(new_src, edit.new_end, start))) {
+        edit.old_end++;
+        edit.new_end++;
+    }
+    return edit;
+}
+
+// A key which may have been changed by an edit, along with its effective
+// definition before the edit and its last one among the parsed entries
+typedef struct {
+    char key[CFG_MAX_KEY + 1];
+    CfgValType type;
+    int entry;
+    int last;
+    CfgVal val;
+} Touched;
+
+typedef struct {
+    Touched *keys;
+    int count;
+    CfgSlot *slots;
+    int size;
+} TouchedSet;
+
+static int
+init_touched(TouchedSet *set, int capacity)
+{
+    set->count = 0;
+    set->size = index_size(capacity);
+    set->keys = malloc(capacity * sizeof(Touched));
+    set->slots = malloc(set->size * sizeof(CfgSlot));
+    if ((set->keys == NULL && capacity > 0) || set->slots == NULL) {
+        free(set->keys);
+        free(set->slots);
+        return -1;
     }
 
+    for (int i = 0; i < set->size; i++)
+        set->slots[i].entry = -1;
     return 0;
 }
 
-static char *
-read_file(const char *filename, int *count, char *err)
+static void
+free_touched(TouchedSet *set)
 {
-    FILE *file = fopen(filename, "rb");
-    if (!file) {
-        snprintf(err, CFG_MAX_ERR, "failed to open file");
-        return NULL;
+    free(set->keys);
+    free(set->slots);
+}
+
+static Touched *
+touch(TouchedSet *set, const char *key, int key_len, CfgValType type)
+{
+    Touched *touched = &set->keys[set->count];
+    memcpy(touched->key, key, key_len);
+    touched->key[key_len] = '\0';
+    touched->type = type;
+    touched->last = -1;
+
+    uint32_t hash = hash_key(touched->key, type);
+    int mask = set->size - 1;
+    int j = hash & mask;
+    while (set->slots[j].entry != -1) {
+        Touched *other = &set->keys[set->slots[j].entry];
+        if (set->slots[j].hash == hash && other->type == type &&
+            !strcmp(other->key, touched->key))
+            return other;
+        j = (j + 1) & mask;
     }
 
-    fseek(file, 0, SEEK_END);
-    size_t file_size = (size_t) ftell(file);
-    rewind(file);
+    set->slots[j].hash = hash;
+    set->slots[j].entry = set->count++;
+    return touched;
+}
 
-    char *src = malloc(file_size + 1);
-    if (src == NULL) {
-        snprintf(err, CFG_MAX_ERR, "memory allocation failed");
-        return NULL;
+static void
+read_val(Cfg *cfg, int i, CfgVal *val)
+{
+    void *src = entry_val(cfg, i);
+    switch (entry_type(cfg, i)) {
+    case CFG_TYPE_STRING:
+        memcpy(val->string, src, strlen(src) + 1);
+        break;
+    case CFG_TYPE_BOOL:
+        val->boolean = *(bool *) src;
+        break;
+    case CFG_TYPE_INT:
+        val->integer = *(int *) src;
+        break;
+    case CFG_TYPE_FLOAT:
+        val->floating = *(float *) src;
+        break;
+    case CFG_TYPE_COLOR:
+        val->color = *(CfgColor *) src;
+        break;
     }
+}
 
-    size_t bytes_read = fread(src, sizeof(char), file_size, file);
-    fclose(file);
-
-    if (bytes_read != file_size) {
-        free(src);
-        snprintf(err, CFG_MAX_ERR, "failed to read file");
-        return NULL;
+// Compares the value of an entry with one of the same type, as returned by
+// entry_val()
+static bool
+is_same_val(Cfg *cfg, int i, const void *val)
+{
+    void *src = entry_val(cfg, i);
+    switch (entry_type(cfg, i)) {
+    case CFG_TYPE_STRING:
+        return !strcmp(src, val);
+    case CFG_TYPE_BOOL:
+        return *(bool *) src == *(const bool *) val;
+    case CFG_TYPE_INT:
+        return *(int *) src == *(const int *) val;
+    case CFG_TYPE_FLOAT:
+        return *(float *) src == *(const float *) val;
+    case CFG_TYPE_COLOR:;
+        CfgColor a = *(CfgColor *) src;
+        CfgColor b = *(const CfgColor *) val;
+        return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
     }
+    return false;
+}
 
-    *count = file_size;
-    return src;
+// True if the parsed entries have the same keys and types as the ones they
+// replace, so that every index stays valid
+static bool
+has_same_keys(Cfg *cfg, int first, Scanner *s, CfgViewEntry *views, int n)
+{
+    for (int j = 0; j < n; j++) {
+        const char *key = entry_key(cfg, first + j);
+        CfgSlice slice = views[j].key;
+        if (entry_type(cfg, first + j) != views[j].type ||
+            strlen(key) != (size_t) slice.len ||
+            memcmp(key, s->src + slice.off, slice.len) != 0)
+            return false;
+    }
+    return true;
 }
 
-int
-cfg_parse_file(const char *filename, Cfg *cfg, CfgError *err)
+// Edits touching more keys than this rebuild the indexes instead, as each one
+// costs a move of the sorted index
+#define MAX_PATCHED 64
+
+// True if the indexes built for the entries can hold 'count' of them, and
+// those which couldn't be built still can't
+static bool
+can_patch(Cfg *cfg, int count)
 {
-    init_error(err);
+    CfgIndex *index = &cfg->index;
+    CfgKeys *keys = &cfg->keys;
+    CfgSorted *sorted = &cfg->sorted;
 
-    size_t len = strlen(filename);
-    if (len < 5) {
-        snprintf(err->msg, CFG_MAX_ERR, "invalid filename");
-        return -1;
+    if (index->size > 0 ? index->size < index_size(count)
+                        : index->slots != NULL)
+        return false;
+
+    if (keys->hashes != NULL &&
+        (keys->count != cfg->count || count > keys->capacity))
+        return false;
+
+    if (sorted->entries != NULL &&
+        (!has_sorted(cfg) ||
+         CFG_SORTED_CAPACITY(count) > sorted->capacity))
+        return false;
+
+    return true;
+}
+
+// Empties a slot, moving back the ones after it which probing would no
+// longer reach
+static void
+remove_slot(CfgIndex *index, int i)
+{
+    int mask = index->size - 1;
+    for (int j = (i + 1) & mask; index->slots[j].entry != -1;
+         j = (j + 1) & mask) {
+        int home = index->slots[j].hash & mask;
+        bool reachable = i <= j ? (i < home && home <= j)
+                                : (i < home || home <= j);
+        if (!reachable) {
+            index->slots[i] = index->slots[j];
+            i = j;
+        }
     }
+    index->slots[i].entry = -1;
+}
 
-    const char *ext = filename + (len - (sizeof(CFG_FILE_EXT) - 1));
-    if (strcmp(ext, CFG_FILE_EXT) != 0) {
-        snprintf(err->msg, CFG_MAX_ERR, "invalid file extension");
-        return -1;
+// Returns whether the key and type are in the sorted index, along with their
+// position or the one where they belong
+static bool
+search_sorted(Cfg *cfg, const char *key, CfgValType type, int *pos)
+{
+    CfgSorted *sorted = &cfg->sorted;
+
+    int lo = 0;
+    int hi = sorted->count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        int entry = sorted->entries[mid];
+        int res = strcmp(entry_key(cfg, entry), key);
+        if (res == 0)
+            res = (int) entry_type(cfg, entry) - (int) type;
+        if (res < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
     }
 
-    int src_len;
-    char *src = read_file(filename, &src_len, err->msg);
-    if (src == NULL)
-        return -1;
+    *pos = lo;
+    if (lo == sorted->count)
+        return false;
+    int entry = sorted->entries[lo];
+    return entry_type(cfg, entry) == type &&
+           !strcmp(entry_key(cfg, entry), key);
+}
 
-    int res = cfg_parse(src, src_len, cfg, err);
+static void
+remove_sorted(CfgSorted *sorted, int pos)
+{
+    memmove(&sorted->entries[pos], &sorted->entries[pos + 1],
+            (sorted->count - pos - 1) * sizeof(int));
+    sorted->count--;
+}
 
-    free(src);
-    return res;
+static void
+insert_sorted(CfgSorted *sorted, int pos, int entry)
+{
+    memmove(&sorted->entries[pos + 1], &sorted->entries[pos],
+            (sorted->count - pos) * sizeof(int));
+    sorted->entries[pos] = entry;
+    sorted->count++;
 }
 
-static void *
-get_val(Cfg *cfg, const char *key, void *fallback, CfgValType type)
+// Drops the keys whose effective definition is among the entries about to be
+// removed from the hash and sorted indexes
+static void
+unindex_touched(Cfg *cfg, TouchedSet *touched, int first, int removed)
 {
-    for (int i = cfg->count - 1; i >= 0; i--) {
-        if (cfg->entries[i].type == type && !strcmp(key, cfg->entries[i].key))
-            return &(cfg->entries[i].val);
+    for (int i = 0; i < touched->count; i++) {
+        Touched *t = &touched->keys[i];
+        if (t->entry < first || t->entry >= first + removed)
+            continue;
+
+        CfgIndex *index = &cfg->index;
+        if (index->size > 0) {
+            uint32_t hash = hash_key(t->key, t->type);
+            CfgSlot *slot = probe(cfg, index->slots, index->size, hash,
+                                  t->key, t->type);
+            remove_slot(index, slot - index->slots);
+        }
+
+        int pos;
+        if (cfg->sorted.entries != NULL &&
+            search_sorted(cfg, t->key, t->type, &pos))
+            remove_sorted(&cfg->sorted, pos);
     }
-    return fallback;
 }
 
-char *
-cfg_get_string(Cfg *cfg, const char *key, char *fallback)
+// Moves the entries after the removed ones and their dense keys, then
+// renumbers them in the other indexes
+static void
+move_entries(Cfg *cfg, int first, int removed, int added, bool patch)
 {
-    return (char *) get_val(cfg, key, fallback, CFG_TYPE_STRING);
+    int from = first + removed;
+    int to = first + added;
+    int count = cfg->count - from;
+
+    if (cfg->compact != NULL)
+        memmove(&cfg->compact[to], &cfg->compact[from],
+                count * sizeof(CfgCompactEntry));
+    else
+        memmove(&cfg->entries[to], &cfg->entries[from],
+                count * sizeof(CfgEntry));
+
+    if (!patch)
+        return;
+
+    CfgKeys *keys = &cfg->keys;
+    if (keys->hashes != NULL) {
+        memmove(&keys->hashes[to], &keys->hashes[from],
+                count * sizeof(uint32_t));
+        memmove(&keys->lens[to], &keys->lens[from], count * sizeof(uint8_t));
+        memmove(&keys->types[to], &keys->types[from],
+                count * sizeof(uint8_t));
+        keys->count += added - removed;
+    }
+
+    if (to == from)
+        return;
+
+    CfgIndex *index = &cfg->index;
+    for (int i = 0; i < index->size; i++) {
+        if (index->slots[i].entry >= from)
+            index->slots[i].entry += to - from;
+    }
+
+    CfgSorted *sorted = &cfg->sorted;
+    if (sorted->entries != NULL) {
+        for (int i = 0; i < sorted->count; i++) {
+            if (sorted->entries[i] >= from)
+                sorted->entries[i] += to - from;
+        }
+    }
 }
 
-bool
-cfg_get_bool(Cfg *cfg, const char *key, bool fallback)
+// Last definition of the key and type before 'end', from the dense keys if
+// they're there
+static int
+find_before(Cfg *cfg, const char *key, CfgValType type, int end)
 {
-    return *(bool *) get_val(cfg, key, &fallback, CFG_TYPE_BOOL);
+    if (cfg->keys.hashes != NULL)
+        return find_key(cfg, key, type, end);
+
+    for (int i = end - 1; i >= 0; i--) {
+        if (entry_type(cfg, i) == type && !strcmp(key, entry_key(cfg, i)))
+            return i;
+    }
+    return -1;
 }
 
-int
-cfg_get_int(Cfg *cfg, const char *key, int fallback)
+// Adds the parsed entries to the indexes, along with the earlier definitions
+// which became effective again
+static void
+index_touched(Cfg *cfg, TouchedSet *touched, int first, int added)
 {
-    return *(int *) get_val(cfg, key, &fallback, CFG_TYPE_INT);
+    // The removed keys stay in the Bloom filter, which only costs a few
+    // more false positives until the next full parse
+    CfgKeys *keys = &cfg->keys;
+    for (int i = first; i < first + added; i++) {
+        const char *key = entry_key(cfg, i);
+        CfgValType type = entry_type(cfg, i);
+        uint32_t hash = hash_key(key, type);
+        if (keys->hashes != NULL) {
+            keys->hashes[i] = hash;
+            keys->lens[i] = strlen(key);
+            keys->types[i] = type;
+        }
+        if (cfg->bloom.size > 0)
+            add_bloom(&cfg->bloom, hash);
+    }
+
+    CfgIndex *index = &cfg->index;
+    CfgSorted *sorted = &cfg->sorted;
+    for (int i = 0; i < touched->count; i++) {
+        Touched *t = &touched->keys[i];
+        uint32_t hash = hash_key(t->key, t->type);
+
+        // The indexes still hold any definition outside the edit
+        CfgSlot *slot = NULL;
+        int pos = 0;
+        bool found = false;
+        int entry = -1;
+        if (index->size > 0) {
+            slot = probe(cfg, index->slots, index->size, hash, t->key,
+                         t->type);
+            entry = slot->entry;
+        }
+        if (sorted->entries != NULL) {
+            found = search_sorted(cfg, t->key, t->type, &pos);
+            if (found)
+                entry = sorted->entries[pos];
+        }
+
+        if (entry < first + added) {
+            if (t->last != -1)
+                entry = first + t->last;
+            else if (entry == -1 && t->entry != -1)
+                entry = find_before(cfg, t->key, t->type, first);
+        }
+        if (entry == -1)
+            continue;
+
+        if (slot != NULL) {
+            slot->hash = hash;
+            slot->entry = entry;
+        }
+        if (found)
+            sorted->entries[pos] = entry;
+        else if (sorted->entries != NULL)
+            insert_sorted(sorted, pos, entry);
+    }
 }
 
 int
-cfg_get_int_min(Cfg *cfg, const char *key, int fallback, int min)
+cfg_reparse_incremental(Cfg *cfg,
+                        const char *old_src,
+                        int old_len,
+                        const char *new_src,
+                        int new_len,
+                        CfgChangeFn on_change,
+                        void *user,
+                        CfgError *err)
 {
-    int value = cfg_get_int(cfg, key, fallback);
-    if (value < min)
-        value = fallback;
-    return value;
+    init_error(err);
+
+    // The entries map one to one to the lines of the old source which hold
+    // one, unless some were dropped or parsing may have stopped early
+    Edit edit = find_edit(old_src, old_len, new_src, new_len);
+    bool full = cfg->count == cfg->capacity || (cfg->flags & CFG_DEDUP) ||
+                cfg->compacted == cfg->generation ||
+                (cfg->compact != NULL && cfg->pool_capacity < old_len);
+    int first = 0;
+    int removed = cfg->count;
+
+    if (!full) {
+        removed = count_entries(old_src + edit.start,
+                                edit.old_end - edit.start);
+
+        // Count the entries on the shorter side of the edit
+        if (edit.start <= old_len - edit.old_end)
+            first = count_entries(old_src, edit.start);
+        else
+            first = cfg->count - removed -
+                    count_entries(old_src + edit.old_end,
+                                  old_len - edit.old_end);
+
+        int len = edit.new_end - edit.start;
+        int room = cfg->capacity - (cfg->count - removed);
+        full = first < 0 || first + removed > cfg->count ||
+               count_lines(new_src + edit.start, len) > room ||
+               (cfg->compact != NULL &&
+                cfg->pool_len + len > cfg->pool_capacity);
+    }
+
+    if (full) {
+        edit = (Edit){0, old_len, new_len};
+        first = 0;
+        removed = cfg->count;
+    }
+
+    int len = edit.new_end - edit.start;
+    int room = cfg->capacity - (cfg->count - removed);
+    int lines = count_lines(new_src + edit.start, len);
+    int max = lines < room ? lines : room;
+
+    CfgViewEntry *views = malloc(max * sizeof(CfgViewEntry));
+    if (views == NULL && max > 0) {
+        snprintf(err->msg, CFG_MAX_ERR, "memory allocation failed");
+        return -1;
+    }
+
+    // Parse the edited lines first, so that errors leave the Cfg unchanged
+    Scanner s;
+    init_scanner(&s, new_src + edit.start, len);
+    skip_whitespace_and_comments(&s);
+
+    int added = 0;
+    long long pool_len = full ? 0 : cfg->pool_len;
+    while (!is_at_end(&s) && added < max) {
+        if (parse_entry(&s, &views[added], err) != 0) {
+            err->off += edit.start;
+            err->row += count_lines(new_src, edit.start) - 1;
+            free(views);
+            return -1;
+        }
+
+        // Only a full parse can run out of pool, in which case it stops
+        // where cfg_parse() would, ignoring the lines which follow
+        if (cfg->compact != NULL) {
+            pool_len += pool_size(&views[added]);
+            if (pool_len > cfg->pool_capacity)
+                break;
+        }
+
+        added++;
+        skip_whitespace_and_comments(&s);
+    }
+
+    // Other edits patch the indexes rather than rebuilding them, as long as
+    // few keys are touched
+    bool same_keys = !full && added == removed &&
+                     has_same_keys(cfg, first, &s, views, added);
+    bool patch = !full && !same_keys &&
+                 can_patch(cfg, cfg->count + added - removed);
+
+    TouchedSet touched = {0};
+    if (on_change != NULL || patch) {
+        if (init_touched(&touched, removed + added) != 0) {
+            free(views);
+            snprintf(err->msg, CFG_MAX_ERR, "memory allocation failed");
+            return -1;
+        }
+
+        for (int i = first; i < first + removed; i++) {
+            const char *key = entry_key(cfg, i);
+            touch(&touched, key, strlen(key), entry_type(cfg, i));
+        }
+        for (int j = 0; j < added; j++) {
+            touch(&touched, s.src + views[j].key.off, views[j].key.len,
+                  views[j].type)->last = j;
+        }
+
+        for (int i = 0; i < touched.count; i++) {
+            Touched *t = &touched.keys[i];
+            t->entry = find_entry(cfg, t->key, t->type);
+            if (on_change != NULL && t->entry != -1)
+                read_val(cfg, t->entry, &t->val);
+        }
+
+        if (touched.count > MAX_PATCHED)
+            patch = false;
+    }
+
+    if (patch)
+        unindex_touched(cfg, &touched, first, removed);
+
+    if (full)
+        cfg->pool_len = 0;
+
+    move_entries(cfg, first, removed, added, patch);
+    cfg->count += added - removed;
+
+    // The views were counted against the pool as they were parsed
+    for (int j = 0; j < added; j++) {
+        if (!set_entry(&s, &views[j], cfg, first + j)) {
+            cfg->count = first + j;
+            break;
+        }
+    }
+    free(views);
+
+    cfg->generation++;
+
+    int res = 0;
+    if (full)
+        res = finish_cfg(cfg, err);
+    else if (patch)
+        index_touched(cfg, &touched, first, added);
+    else if (!same_keys)
+        index_cfg(cfg);
+
+    for (int i = 0; on_change != NULL && res == 0 && i < touched.count; i++) {
+        Touched *t = &touched.keys[i];
+        int entry = find_entry(cfg, t->key, t->type);
+        if (entry == -1 && t->entry != -1)
+            on_change(CFG_KEY_REMOVED, t->key, t->type, user);
+        else if (entry != -1 && t->entry == -1)
+            on_change(CFG_KEY_ADDED, t->key, t->type, user);
+        else if (entry != -1 && !is_same_val(cfg, entry, &t->val))
+            on_change(CFG_KEY_MODIFIED, t->key, t->type, user);
+    }
+
+    free_touched(&touched);
+    return res;
 }
 
-int
-cfg_get_int_max(Cfg *cfg, const char *key, int fallback, int max)
+// Hash index of a Cfg object, the one it has or a temporary one
+typedef struct {
+    CfgSlot *slots;
+    int size;
+    bool owned;
+} DiffIndex;
+
+static int
+init_diff_index(DiffIndex *index, Cfg *cfg)
 {
-    int value = cfg_get_int(cfg, key, fallback);
-    if (value > max)
-        value = fallback;
-    return value;
+    index->owned = cfg->index.size == 0;
+    if (!index->owned) {
+        index->slots = cfg->index.slots;
+        index->size = cfg->index.size;
+        return 0;
+    }
+
+    index->size = index_size(cfg->count);
+    index->slots = malloc(index->size * sizeof(CfgSlot));
+    if (index->slots == NULL)
+        return -1;
+
+    fill_index(cfg, index->slots, index->size);
+    return 0;
+}
+
+static void
+free_diff_index(DiffIndex *index)
+{
+    if (index->owned)
+        free(index->slots);
+}
+
+static int
+find_diff(Cfg *cfg, DiffIndex *index, const char *key, CfgValType type)
+{
+    uint32_t hash = hash_key(key, type);
+    return probe(cfg, index->slots, index->size, hash, key, type)->entry;
 }
 
 int
-cfg_get_int_range(Cfg *cfg, const char *key, int fallback, int min, int max)
+cfg_diff(Cfg *old, Cfg *new, CfgChangeFn fn, void *user)
 {
-    int value = cfg_get_int(cfg, key, fallback);
-    if (value < min || value > max)
-        value = fallback;
-    return value;
+    DiffIndex old_index, new_index;
+    if (init_diff_index(&old_index, old) != 0)
+        return -1;
+    if (init_diff_index(&new_index, new) != 0) {
+        free_diff_index(&old_index);
+        return -1;
+    }
+
+    // Only the effective definitions are compared
+    int count = 0;
+    for (int i = 0; i < new->count; i++) {
+        const char *key = entry_key(new, i);
+        CfgValType type = entry_type(new, i);
+        if (find_diff(new, &new_index, key, type) != i)
+            continue;
+
+        int j = find_diff(old, &old_index, key, type);
+        if (j == -1) {
+            fn(CFG_KEY_ADDED, key, type, user);
+            count++;
+        } else if (!is_same_val(new, i, entry_val(old, j))) {
+            fn(CFG_KEY_MODIFIED, key, type, user);
+            count++;
+        }
+    }
+
+    for (int j = 0; j < old->count; j++) {
+        const char *key = entry_key(old, j);
+        CfgValType type = entry_type(old, j);
+        if (find_diff(old, &old_index, key, type) == j &&
+            find_diff(new, &new_index, key, type) == -1) {
+            fn(CFG_KEY_REMOVED, key, type, user);
+            count++;
+        }
+    }
+
+    free_diff_index(&new_index);
+    free_diff_index(&old_index);
+    return count;
 }
 
-float
-cfg_get_float(Cfg *cfg, const char *key, float fallback)
+int
+cfg_subscribe(CfgSubscribers *subs,
+              const char *prefix,
+              CfgChangeFn fn,
+              void *user)
 {
-    return *(float *) get_val(cfg, key, &fallback, CFG_TYPE_FLOAT);
+    if (subs->count == subs->capacity)
+        return -1;
+
+    subs->subs[subs->count++] = (CfgSubscription){prefix, fn, user};
+    return 0;
 }
 
-float
-cfg_get_float_min(Cfg *cfg, const char *key, float fallback, float min)
+void
+cfg_unsubscribe(CfgSubscribers *subs, CfgChangeFn fn, void *user)
 {
-    float value = cfg_get_float(cfg, key, fallback);
-    if (value < min)
-        value = fallback;
-    return value;
+    int count = 0;
+    for (int i = 0; i < subs->count; i++) {
+        CfgSubscription *sub = &subs->subs[i];
+        if (sub->fn != fn || sub->user != user)
+            subs->subs[count++] = *sub;
+    }
+    subs->count = count;
 }
 
-float
-cfg_get_float_max(Cfg *cfg, const char *key, float fallback, float max)
+void
+cfg_dispatch(CfgChange change, const char *key, CfgValType type, void *user)
 {
-    float value = cfg_get_float(cfg, key, fallback);
-    if (value > max)
-        value = fallback;
-    return value;
+    CfgSubscribers *subs = user;
+    for (int i = 0; i < subs->count; i++) {
+        CfgSubscription *sub = &subs->subs[i];
+        if (!strncmp(key, sub->prefix, strlen(sub->prefix)))
+            sub->fn(change, key, type, sub->user);
+    }
 }
 
-float
-cfg_get_float_range(Cfg *cfg,
-                    const char *key,
-                    float fallback,
-                    float min,
-                    float max)
+// Walks the keys starting with the prefix in both sorted indexes at once
+static void
+diff_prefix(Cfg *old, Cfg *new, CfgSubscription *sub)
 {
-    float value = cfg_get_float(cfg, key, fallback);
-    if (value < min || value > max)
-        value = fallback;
-    return value;
+    size_t len = strlen(sub->prefix);
+    int i = search_prefix(old, sub->prefix, len, false);
+    int old_end = search_prefix(old, sub->prefix, len, true);
+    int j = search_prefix(new, sub->prefix, len, false);
+    int new_end = search_prefix(new, sub->prefix, len, true);
+
+    while (i < old_end || j < new_end) {
+        int a = i < old_end ? old->sorted.entries[i] : -1;
+        int b = j < new_end ? new->sorted.entries[j] : -1;
+
+        int res;
+        if (a == -1 || b == -1) {
+            res = a == -1 ? 1 : -1;
+        } else {
+            res = strcmp(entry_key(old, a), entry_key(new, b));
+            if (res == 0)
+                res = (int) entry_type(old, a) - (int) entry_type(new, b);
+        }
+
+        if (res < 0) {
+            sub->fn(CFG_KEY_REMOVED, entry_key(old, a), entry_type(old, a),
+                    sub->user);
+            i++;
+        } else if (res > 0) {
+            sub->fn(CFG_KEY_ADDED, entry_key(new, b), entry_type(new, b),
+                    sub->user);
+            j++;
+        } else {
+            if (!is_same_val(new, b, entry_val(old, a))) {
+                sub->fn(CFG_KEY_MODIFIED, entry_key(new, b),
+                        entry_type(new, b), sub->user);
+            }
+            i++;
+            j++;
+        }
+    }
 }
 
-CfgColor
-cfg_get_color(Cfg *cfg, const char *key, CfgColor fallback)
+int
+cfg_notify(CfgSubscribers *subs, Cfg *old, Cfg *new)
 {
-    return *(CfgColor *) get_val(cfg, key, &fallback, CFG_TYPE_COLOR);
+    // The sorted indexes narrow the diff to the subscribed keys
+    if (!has_sorted(old) || !has_sorted(new))
+        return cfg_diff(old, new, cfg_dispatch, subs) < 0 ? -1 : 0;
+
+    for (int i = 0; i < subs->count; i++)
+        diff_prefix(old, new, &subs->subs[i]);
+    return 0;
 }
 
 void
 cfg_fprint(FILE *stream, Cfg *cfg)
 {
     for (int i = 0; i < cfg->count; i++) {
-        fprintf(stream, "%s: ", cfg->entries[i].key);
+        fprintf(stream, "%s: ", entry_key(cfg, i));
 
-        switch (cfg->entries[i].type) {
+        void *val = entry_val(cfg, i);
+        switch (entry_type(cfg, i)) {
         case CFG_TYPE_STRING:
-            fprintf(stream, "\"%s\"\n", cfg->entries[i].val.string);
+            fprintf(stream, "\"%s\"\n", (char *) val);
             break;
         case CFG_TYPE_BOOL:
-            fprintf(stream, "%s\n",
-                    cfg->entries[i].val.boolean ? "true" : "false");
+            fprintf(stream, "%s\n", *(bool *) val ? "true" : "false");
             break;
         case CFG_TYPE_INT:
-            fprintf(stream, "%d\n", cfg->entries[i].val.integer);
+            fprintf(stream, "%d\n", *(int *) val);
             break;
         case CFG_TYPE_FLOAT:
-            fprintf(stream, "%f\n", cfg->entries[i].val.floating);
+            fprintf(stream, "%f\n", *(float *) val);
             break;
         case CFG_TYPE_COLOR:;
-            CfgColor c = cfg->entries[i].val.color;
+            CfgColor c = *(CfgColor *) val;
             fprintf(stream, "rgba(%d, %d, %d, %d)\n", c.r, c.g, c.b, c.a);
             break;
         }
@@ -47,12 +47,182 @@ typedef struct {
     CfgVal val;
 } CfgEntry;
 
+typedef struct {
+    int off;
+    int len;
+} CfgSlice;
+
+// Same as CfgVal, except strings are slices of the source
+typedef union {
+    CfgSlice string;
+    bool boolean;
+    int integer;
+    float floating;
+    CfgColor color;
+} CfgViewVal;
+
+typedef struct {
+    CfgValType type;
+    CfgSlice key;
+    CfgViewVal val;
+} CfgViewEntry;
+
+// Entries of a CfgView point into the source, which must outlive the view
+typedef struct {
+    const char *src;
+    CfgViewEntry *entries;
+    int count;
+    int capacity;
+} CfgView;
+
+typedef union {
+    char *string;
+    bool boolean;
+    int integer;
+    float floating;
+    CfgColor color;
+} CfgArenaVal;
+
+typedef struct {
+    CfgValType type;
+    char *key;
+    CfgArenaVal val;
+} CfgArenaEntry;
+
+typedef struct CfgBlock CfgBlock;
+
+#define CFG_ARENA_BLOCK_SIZE (64 * 1024)
+
+// Entries, keys and strings are carved from a list of blocks which grows as
+// needed, so there is no capacity nor length limit. A zeroed CfgArena is
+// ready to use and block_size defaults to CFG_ARENA_BLOCK_SIZE.
+typedef struct {
+    CfgBlock *blocks;
+    int block_size;
+    int allocs;
+    CfgArenaEntry *entries;
+    int count;
+    int capacity;
+} CfgArena;
+
+typedef struct {
+    uint32_t hash;
+    int entry;
+} CfgSlot;
+
+// Open-addressing hash index over (key, type) pairs. The slots are provided
+// by the caller, the table is built at the end of cfg_parse() and only uses
+// as many slots as needed (a power of two, at least twice the entry count).
+typedef struct {
+    CfgSlot *slots;
+    int size;
+    int capacity;
+} CfgIndex;
+
+// Number of slots that guarantees an index for up to N entries
+#define CFG_INDEX_CAPACITY(N) (4 * (N))
+
+// Dense index of the keys for configs too small to be worth a hash table. The
+// hash, length and type of entry i are kept at position i of parallel arrays
+// provided by the caller, so a lookup compares 4 or 8 hashes at a time and
+// only looks at the keys whose hash matches. It's built at the end of
+// cfg_parse() if the arrays have room for all the entries, and it's only used
+// when there's no hash index.
+typedef struct {
+    uint32_t *hashes;
+    uint8_t *lens;
+    uint8_t *types;
+    int count;
+    int capacity;
+} CfgKeys;
+
+// Entries sorted by key and type for prefix queries, without the definitions
+// which are overridden by a later one. Built at the end of cfg_parse() if the
+// caller provides room for CFG_SORTED_CAPACITY(N) entry numbers, half of
+// which is scratch space for the sort.
+typedef struct {
+    int *entries;
+    int count;
+    int capacity;
+} CfgSorted;
+
+#define CFG_SORTED_CAPACITY(N) (2 * (N))
+
+// Bloom filter over the keys and types of the entries, so that most lookups
+// of a missing key return the fallback without touching the entries nor the
+// index. Each key sets 3 bits of a single 64-bit word. It's built at the end
+// of cfg_parse() in the words provided by the caller, smaller than it should
+// be if they're fewer than CFG_BLOOM_CAPACITY(N), which gives 16 to 32 bits
+// per entry. It pays off most without a hash index, which already makes
+// misses cheap.
+typedef struct {
+    uint64_t *words;
+    int size;
+    int capacity;
+} CfgBloom;
+
+#define CFG_BLOOM_CAPACITY(N) ((N) / 2 + 1)
+
+// Compact layout of an entry (16 bytes instead of ~104): keys and strings are
+// NUL-terminated in a pool and referenced by offset, other values are inline
+typedef struct {
+    uint32_t key;
+    uint16_t key_len;
+    uint8_t type;
+    CfgViewVal val;  // Strings are slices of the pool
+} CfgCompactEntry;
+
+// Flags of a Cfg object, applied whenever it's parsed or loaded
+#define CFG_DEDUP 0x1     // Keep only the last definition of each key and type
+#define CFG_MAP_FILE 0x2  // Map files rather than read them
+
+// Instrumentation of a Cfg object, only filled when the library is built with
+// CFG_STATS defined, otherwise it's left untouched. It's always part of the
+// Cfg, so that code built with and without the macro agrees on its layout. The
+// parse fields describe the last time the object was populated, while the
+// lookup counters accumulate over its lifetime.
+typedef struct {
+    uint64_t bytes;                        // Source bytes scanned
+    uint64_t comment_bytes;                // Bytes of comments skipped
+    uint64_t entries[CFG_TYPE_COLOR + 1];  // Entries parsed, by type
+    uint64_t io_ns;                        // Time spent reading the file
+    uint64_t parse_ns;                     // Time spent parsing and indexing
+    uint64_t lookups;
+    uint64_t misses;
+} CfgStats;
+
+// A Cfg object must be zero-initialized, e.g. with a designated initializer,
+// as every field which isn't set is read by the parser and the getters: an
+// uninitialized index or pool is followed as if the caller had provided it.
+//
+// Entries are stored in the compact layout if 'compact' is set, in which case
+// 'entries' is unused and 'capacity' applies to the compact entries. A pool as
+// large as the source is always enough for its keys and strings.
 typedef struct {
     CfgEntry *entries;
     int count;
     int capacity;
+    CfgIndex index;
+    CfgKeys keys;
+    CfgSorted sorted;
+    CfgBloom bloom;
+    unsigned generation;  // Incremented every time the entries are replaced
+    unsigned compacted;   // Generation at which cfg_compact() dropped entries
+    CfgCompactEntry *compact;
+    char *pool;
+    int pool_len;
+    int pool_capacity;
+    unsigned flags;
+    CfgStats stats;
 } Cfg;
 
+// A key resolved once with cfg_key_resolve(), reading it costs a bounds
+// check and a load. Handles of a previous generation yield the fallback.
+typedef struct {
+    int entry;
+    unsigned generation;
+} CfgKey;
+
 /**
  * @brief Parses the source data and populates the Cfg object
  *
@@ -65,9 +235,260 @@ typedef struct {
  */
 int cfg_parse(const char *src, int src_len, Cfg *cfg, CfgError *err);
 
+/**
+ * @brief Drops the definitions which are overridden by a later one
+ *
+ * Only the last definition of each key and type is kept, so lookups return
+ * the same values with fewer entries to scan. The other entries keep their
+ * order. Takes O(n) using the index slots, if there are enough of them, or a
+ * temporary hash table. Handles are invalidated if any entry is dropped. In
+ * the compact layout the pool space of the dropped entries isn't reclaimed.
+ *
+ * Parsing a Cfg object with the CFG_DEDUP flag does the same.
+ *
+ * @param[in,out] cfg The Cfg object
+ *
+ * @return Number of entries dropped, -1 if out of memory
+ */
+int cfg_compact(Cfg *cfg);
+
+/**
+ * @brief Parses the source data on multiple threads
+ *
+ * The source is split at line boundaries into one shard per thread and the
+ * entries are concatenated in file order. The result, including errors, is
+ * the same as cfg_parse(). Configs in the compact layout are parsed on the
+ * calling thread only.
+ *
+ * @param[in] src The source data
+ * @param[in] src_len Length of the source data
+ * @param[in,out] cfg The Cfg object to be populated
+ * @param[in] nthreads Number of threads, including the calling one
+ * @param[out] err Buffer to store error messages
+ *
+ * @return 0 if parsing is successful, -1 otherwise
+ */
+int cfg_parse_parallel(const char *src,
+                       int src_len,
+                       Cfg *cfg,
+                       int nthreads,
+                       CfgError *err);
+
+// Incremental parser for sources which arrive in chunks. Only the last,
+// incomplete line is buffered, so memory is bounded by the longest line.
+typedef struct {
+    Cfg *cfg;
+    char *buf;
+    int len;
+    int capacity;
+    int off;
+    int row;
+    bool failed;
+} CfgStream;
+
+/**
+ * @brief Starts parsing a source in chunks into the Cfg object
+ *
+ * @param[out] stream The CfgStream object to be initialized
+ * @param[in,out] cfg The Cfg object to be populated
+ */
+void cfg_stream_init(CfgStream *stream, Cfg *cfg);
+
+/**
+ * @brief Feeds the next chunk of the source
+ *
+ * Entries are added to the Cfg object as soon as their line is complete.
+ * Once an error has been reported, the stream rejects any other chunk.
+ *
+ * @param[in,out] stream The CfgStream object
+ * @param[in] chunk The next chunk of the source
+ * @param[in] len Length of the chunk
+ * @param[out] err Buffer to store error messages
+ *
+ * @return 0 if parsing is successful, -1 otherwise
+ */
+int cfg_stream_feed(CfgStream *stream,
+                    const char *chunk,
+                    int len,
+                    CfgError *err);
+
+/**
+ * @brief Parses the last line and releases the stream
+ *
+ * Must be called even if cfg_stream_feed() failed.
+ *
+ * @param[in,out] stream The CfgStream object
+ * @param[out] err Buffer to store error messages
+ *
+ * @return 0 if parsing is successful, -1 otherwise
+ */
+int cfg_stream_finish(CfgStream *stream, CfgError *err);
+
+typedef enum {
+    CFG_KEY_ADDED,
+    CFG_KEY_REMOVED,
+    CFG_KEY_MODIFIED,
+} CfgChange;
+
+// Called for every key and type whose effective value changed. The new value
+// can be read with the getters.
+typedef void (*CfgChangeFn)(CfgChange change,
+                            const char *key,
+                            CfgValType type,
+                            void *user);
+
+/**
+ * @brief Updates a Cfg object parsed from a source to a new version of it
+ *
+ * Only the lines between the common prefix and suffix of the two versions
+ * are parsed again, the other entries are kept or shifted. The indexes are
+ * kept as they are when the edit only changes values, otherwise they're
+ * patched, or rebuilt if the edit touches many keys. The whole source is
+ * parsed again if the entries may stop before the end of the old source,
+ * because the Cfg object is full or its pool is smaller than the source, if
+ * entries were dropped, by the CFG_DEDUP flag or cfg_compact(), or if the
+ * edit doesn't fit in the entries or the pool.
+ *
+ * As with cfg_parse(), a full pool silently ends the parse, so errors past
+ * that point are ignored. Otherwise, if the new version has an error the Cfg
+ * object is left unchanged.
+ *
+ * @param[in,out] cfg The Cfg object, populated from the old version
+ * @param[in] old_src The source data the Cfg object was populated from
+ * @param[in] old_len Length of the old source
+ * @param[in] new_src The new source data
+ * @param[in] new_len Length of the new source
+ * @param[in] on_change Callback invoked for every changed key, can be NULL
+ * @param[in] user Argument passed to the callback
+ * @param[out] err Buffer to store error messages
+ *
+ * @return 0 if parsing is successful, -1 otherwise
+ */
+int cfg_reparse_incremental(Cfg *cfg,
+                            const char *old_src,
+                            int old_len,
+                            const char *new_src,
+                            int new_len,
+                            CfgChangeFn on_change,
+                            void *user,
+                            CfgError *err);
+
+/**
+ * @brief Compares the effective values of two Cfg objects
+ *
+ * Invokes the callback for every key and type which is only defined in the
+ * new Cfg object (added), only in the old one (removed), or in both with a
+ * different value (modified), the last definition of a key being the one in
+ * effect. Keys with the same name but different types are distinct. Runs in
+ * linear time, indexing the Cfg objects which lack a hash index on the fly.
+ *
+ * @param[in] old The old Cfg object
+ * @param[in] new The new Cfg object
+ * @param[in] fn Callback invoked for every change
+ * @param[in] user Argument passed to the callback
+ *
+ * @return The number of changes, or -1 if memory allocation fails
+ */
+int cfg_diff(Cfg *old, Cfg *new, CfgChangeFn fn, void *user);
+
+typedef struct {
+    const char *prefix;
+    CfgChangeFn fn;
+    void *user;
+} CfgSubscription;
+
+// Caller-allocated list of subscriptions to the keys starting with a prefix
+typedef struct {
+    CfgSubscription *subs;
+    int count;
+    int capacity;
+} CfgSubscribers;
+
+/**
+ * @brief Subscribes a callback to the changes of the keys starting with a
+ * prefix
+ *
+ * The empty prefix matches every key. The prefix isn't copied.
+ *
+ * @return 0 on success, -1 if the list is full
+ */
+int cfg_subscribe(CfgSubscribers *subs,
+                  const char *prefix,
+                  CfgChangeFn fn,
+                  void *user);
+
+// Removes every subscription of the callback with that argument
+void cfg_unsubscribe(CfgSubscribers *subs, CfgChangeFn fn, void *user);
+
+/**
+ * @brief Passes a change to the subscriptions whose prefix matches the key
+ *
+ * It's a CfgChangeFn taking the CfgSubscribers as its argument, so it can be
+ * passed to cfg_diff() or cfg_reparse_incremental().
+ */
+void cfg_dispatch(CfgChange change,
+                  const char *key,
+                  CfgValType type,
+                  void *user);
+
+/**
+ * @brief Notifies the subscriptions of the changes between two Cfg objects
+ *
+ * If both Cfg objects have a sorted index, only the keys starting with the
+ * subscribed prefixes are compared, otherwise it uses cfg_diff().
+ *
+ * @return 0 on success, -1 if memory allocation fails
+ */
+int cfg_notify(CfgSubscribers *subs, Cfg *old, Cfg *new);
+
+/**
+ * @brief Parses the source data without copying keys and strings
+ *
+ * Keys and strings are stored as slices of the source, so they aren't
+ * NUL-terminated and aren't subject to CFG_MAX_KEY and CFG_MAX_VAL.
+ *
+ * @param[in] src The source data, must outlive the view
+ * @param[in] src_len Length of the source data
+ * @param[in,out] view The CfgView object to be populated
+ * @param[out] err Buffer to store error messages
+ *
+ * @return 0 if parsing is successful, -1 otherwise
+ */
+int cfg_parse_view(const char *src, int src_len, CfgView *view, CfgError *err);
+
+/**
+ * @brief Parses the source data into an arena
+ *
+ * Entries from a previous parse are discarded, but the memory of the arena
+ * is reused.
+ *
+ * @param[in] src The source data
+ * @param[in] src_len Length of the source data
+ * @param[in,out] arena The CfgArena object to be populated
+ * @param[out] err Buffer to store error messages
+ *
+ * @return 0 if parsing is successful, -1 otherwise
+ */
+int cfg_parse_arena(const char *src,
+                    int src_len,
+                    CfgArena *arena,
+                    CfgError *err);
+
+/**
+ * @brief Releases all the memory owned by the arena
+ */
+void cfg_arena_free(CfgArena *arena);
+
 /**
  * @brief Loads and parses a config file
  *
+ * The file is read into a private buffer, unless the Cfg object has the
+ * CFG_MAP_FILE flag, in which case regular files are memory-mapped and parsed
+ * without being copied. Only set the flag for files which are never truncated
+ * or rewritten in place while they're parsed: reading a mapping past the end
+ * of its file raises SIGBUS and kills the process. Files replaced with
+ * rename() are safe, as the mapping keeps the old file alive.
+ *
  * @param[in] filename Path of the config file
  * @param[in,out] cfg The Cfg object to be populated
  * @param[out] err Buffer to store error messages
@@ -78,6 +499,235 @@ int cfg_parse(const char *src, int src_len, Cfg *cfg, CfgError *err);
  */
 int cfg_parse_file(const char *filename, Cfg *cfg, CfgError *err);
 
+typedef struct {
+    CfgArena *arena;  // Holds the entries of all the configs
+    int nthreads;     // Number of threads, one per CPU if 0
+    unsigned flags;   // Flags of the configs, e.g. CFG_DEDUP
+} CfgFilesOpts;
+
+/**
+ * @brief Loads and parses many config files on multiple threads
+ *
+ * Each thread reads and parses one file at a time, so reads overlap with
+ * each other and with parsing. The configs are in the compact layout, sized
+ * to their file, and their memory comes from the arena, which is reset
+ * first: configs loaded by a previous call with the same arena are
+ * discarded, but the memory is reused. The configs have no index.
+ *
+ * @param[in] paths Paths of the config files
+ * @param[in] n Number of files
+ * @param[out] cfgs The Cfg objects, one per file, empty if loading fails
+ * @param[out] errs Buffers to store error messages, one per file
+ * @param[in] opts Options, including the arena
+ *
+ * @return 0 if every file is loaded, -1 otherwise
+ */
+int cfg_parse_files(const char *const *paths,
+                    int n,
+                    Cfg *cfgs,
+                    CfgError *errs,
+                    const CfgFilesOpts *opts);
+
+/**
+ * @brief Saves a parsed Cfg object as a binary snapshot
+ *
+ * The snapshot is endian-independent and contains a prebuilt lookup index,
+ * so that loading it requires no parsing at all.
+ *
+ * @param[in] cfg The Cfg object to be saved
+ * @param[in] filename Path of the snapshot
+ * @param[out] err Buffer to store error messages
+ *
+ * @return 0 if saving is successful, -1 otherwise
+ */
+int cfg_save_binary(Cfg *cfg, const char *filename, CfgError *err);
+
+/**
+ * @brief Loads a binary snapshot saved by cfg_save_binary()
+ *
+ * The records are decoded into the entries of the Cfg object without any
+ * parsing, but they're still copied. The file is read into a buffer first,
+ * unless the Cfg object has the CFG_MAP_FILE flag, in which case it's
+ * decoded straight out of a mapping, with the same hazard as in
+ * cfg_parse_file().
+ *
+ * The prebuilt index is copied if the Cfg object has enough slots for it,
+ * and the snapshot is rejected if the index doesn't find every key.
+ *
+ * @param[in] filename Path of the snapshot
+ * @param[in,out] cfg The Cfg object to be populated
+ * @param[out] err Buffer to store error messages
+ *
+ * @return 0 if loading is successful, -1 otherwise
+ */
+int cfg_load_binary(const char *filename, Cfg *cfg, CfgError *err);
+
+// An immutable config shared between threads. A snapshot is freed when its
+// last reference is released and is never modified after parsing, so all the
+// cfg_get_*() getters are wait-free against it: they only read its entries
+// and take no lock.
+typedef struct CfgSnapshot CfgSnapshot;
+
+/**
+ * @brief Parses the source data into a new snapshot
+ *
+ * The snapshot is sized to the source, so no entry is ever truncated.
+ *
+ * @param[in] src The source data
+ * @param[in] src_len Length of the source data
+ * @param[out] err Buffer to store error messages
+ *
+ * @return A snapshot holding one reference or NULL if parsing fails
+ */
+CfgSnapshot *cfg_snapshot_parse(const char *src, int src_len, CfgError *err);
+
+/**
+ * @brief Loads and parses a config file into a new snapshot
+ *
+ * The file is read into a private buffer, never mapped, so it may be
+ * rewritten while it's loaded, e.g. by the editor a CfgWatcher reacts to.
+ *
+ * @see cfg_snapshot_parse()
+ */
+CfgSnapshot *cfg_snapshot_parse_file(const char *filename, CfgError *err);
+
+/**
+ * @brief Adds a reference to the snapshot
+ *
+ * @return The snapshot itself
+ */
+CfgSnapshot *cfg_snapshot_acquire(CfgSnapshot *snapshot);
+
+/**
+ * @brief Drops a reference and frees the snapshot if it was the last one
+ */
+void cfg_snapshot_release(CfgSnapshot *snapshot);
+
+/**
+ * @brief Returns the config of the snapshot, which must not be modified
+ */
+Cfg *cfg_snapshot_cfg(CfgSnapshot *snapshot);
+
+// The current snapshot of a config which is replaced while being read.
+// Acquiring it is lock-free and never waits for a publisher, which in turn
+// only waits for the readers which are in the middle of acquiring it.
+typedef struct CfgShared CfgShared;
+
+/**
+ * @brief Creates a CfgShared object holding the snapshot
+ *
+ * @param[in] snapshot The initial snapshot, whose reference is taken over
+ *
+ * @return The CfgShared object or NULL if out of memory
+ */
+CfgShared *cfg_shared_new(CfgSnapshot *snapshot);
+
+/**
+ * @brief Releases the current snapshot and frees the CfgShared object
+ */
+void cfg_shared_free(CfgShared *shared);
+
+/**
+ * @brief Acquires the current snapshot
+ *
+ * @return The snapshot, to be released with cfg_snapshot_release()
+ */
+CfgSnapshot *cfg_shared_acquire(CfgShared *shared);
+
+/**
+ * @brief Replaces the current snapshot
+ *
+ * Readers which already acquired the previous snapshot keep using it until
+ * they release it.
+ *
+ * @param[in,out] shared The CfgShared object
+ * @param[in] snapshot The new snapshot, whose reference is taken over
+ */
+void cfg_shared_publish(CfgShared *shared, CfgSnapshot *snapshot);
+
+// Watches a config file and reloads it on a background thread whenever it's
+// written or replaced. Readers never block: the current config is published
+// through an atomic pointer and an old one is freed only after every reader
+// which may still be using it has left.
+typedef struct CfgWatcher CfgWatcher;
+
+// Called on the watcher thread after every reload. If res is -1 the previous
+// config is kept and err describes the failure.
+typedef void (*CfgReloadFn)(int res, CfgError *err, void *user);
+
+/**
+ * @brief Loads a config file and starts watching it for changes
+ *
+ * The config is sized to the file, so no entry is ever truncated.
+ *
+ * @param[in] filename Path of the config file
+ * @param[in] on_reload Callback invoked after every reload, can be NULL
+ * @param[in] user Argument passed to the callback
+ * @param[out] err Buffer to store error messages
+ *
+ * @return The watcher or NULL if the file can't be watched or loaded
+ */
+CfgWatcher *cfg_watch(const char *filename,
+                      CfgReloadFn on_reload,
+                      void *user,
+                      CfgError *err);
+
+/**
+ * @brief Stops watching and releases the config
+ *
+ * No reader may be inside cfg_watcher_enter() and cfg_watcher_exit().
+ */
+void cfg_unwatch(CfgWatcher *watcher);
+
+/**
+ * @brief Acquires the current config of the watcher
+ *
+ * @return The snapshot, to be released with cfg_snapshot_release()
+ */
+CfgSnapshot *cfg_watcher_acquire(CfgWatcher *watcher);
+
+/**
+ * @brief Enters a read-side section and returns the current config
+ *
+ * The config stays valid until cfg_watcher_exit() and must not be modified.
+ * Sections are cheap, so they should be short: a reload can't release the
+ * previous config while a reader is still inside one.
+ *
+ * @param[in] watcher The CfgWatcher object
+ * @param[out] epoch Token to be passed to cfg_watcher_exit()
+ *
+ * @return The current config
+ */
+Cfg *cfg_watcher_enter(CfgWatcher *watcher, int *epoch);
+
+/**
+ * @brief Leaves a read-side section entered with cfg_watcher_enter()
+ */
+void cfg_watcher_exit(CfgWatcher *watcher, int epoch);
+
+/**
+ * @brief Converts a number to the nearest float
+ *
+ * The syntax is the same as the numbers of a config: an optional '-', digits
+ * and an optional fraction. The result is correctly rounded regardless of
+ * the number of digits.
+ *
+ * @param[in] src The number
+ * @param[in] src_len Length of the number
+ * @param[out] number The converted number
+ *
+ * @return Number of characters converted, 0 if there's no number or it's
+ *         too large
+ */
+int cfg_read_float(const char *src, int src_len, float *number);
+
+/**
+ * @brief Converts a number to the nearest double
+ *
+ * @see cfg_read_float()
+ */
+int cfg_read_double(const char *src, int src_len, double *number);
+
 char *cfg_get_string(Cfg *cfg, const char *key, char *fallback);
 bool cfg_get_bool(Cfg *cfg, const char *key, bool fallback);
 int cfg_get_int(Cfg *cfg, const char *key, int fallback);
@@ -100,6 +750,142 @@ float cfg_get_float_range(Cfg *cfg,
                           float min,
                           float max);
 
+/**
+ * @brief Looks up a string in a CfgView
+ *
+ * @param[out] len Length of the returned string, can be NULL
+ *
+ * @return A pointer into the source (not NUL-terminated) or the fallback
+ */
+const char *cfg_view_get_string(CfgView *view,
+                                const char *key,
+                                const char *fallback,
+                                int *len);
+bool cfg_view_get_bool(CfgView *view, const char *key, bool fallback);
+int cfg_view_get_int(CfgView *view, const char *key, int fallback);
+float cfg_view_get_float(CfgView *view, const char *key, float fallback);
+CfgColor cfg_view_get_color(CfgView *view, const char *key, CfgColor fallback);
+
+char *cfg_arena_get_string(CfgArena *arena, const char *key, char *fallback);
+bool cfg_arena_get_bool(CfgArena *arena, const char *key, bool fallback);
+int cfg_arena_get_int(CfgArena *arena, const char *key, int fallback);
+float cfg_arena_get_float(CfgArena *arena, const char *key, float fallback);
+CfgColor cfg_arena_get_color(CfgArena *arena,
+                             const char *key,
+                             CfgColor fallback);
+
+/**
+ * @brief Resolves a key to a handle for the cfg_get_*_h() getters
+ *
+ * The handle stays valid until the Cfg object is parsed or loaded again.
+ *
+ * @param[in] cfg The Cfg object
+ * @param[in] key The key to be resolved
+ * @param[in] type The type of the value
+ *
+ * @return The handle, which yields the fallback if the key doesn't exist
+ */
+CfgKey cfg_key_resolve(Cfg *cfg, const char *key, CfgValType type);
+
+char *cfg_get_string_h(Cfg *cfg, CfgKey key, char *fallback);
+bool cfg_get_bool_h(Cfg *cfg, CfgKey key, bool fallback);
+int cfg_get_int_h(Cfg *cfg, CfgKey key, int fallback);
+float cfg_get_float_h(Cfg *cfg, CfgKey key, float fallback);
+CfgColor cfg_get_color_h(Cfg *cfg, CfgKey key, CfgColor fallback);
+
+#define CFG_MAX_LAYERS 8
+
+typedef struct {
+    uint32_t hash;
+    int layer;
+    int entry;
+} CfgLayerSlot;
+
+// A stack of configs, e.g. defaults, site, host and runtime, where a key is
+// looked up in the layer with the highest priority which defines it. The
+// layers are referenced, not copied. On the first lookup a merged index of
+// all the layers is built into the slots provided by the caller, after which
+// lookups take O(1) regardless of the number of layers. CFG_INDEX_CAPACITY(N)
+// slots are enough for N entries in total, with fewer the layers are searched
+// one by one.
+typedef struct {
+    Cfg *layers[CFG_MAX_LAYERS];  // By increasing priority, can be NULL
+    int count;
+    CfgLayerSlot *slots;
+    int size;
+    int capacity;
+    bool built;
+} CfgLayers;
+
+/**
+ * @brief Sets or replaces a layer of a CfgLayers object
+ *
+ * The merged index is invalidated and rebuilt on the next lookup. A Cfg
+ * object which is parsed or compacted again after being set must be set
+ * again.
+ *
+ * @param[in,out] layers The CfgLayers object
+ * @param[in] layer Priority of the layer, from 0 to CFG_MAX_LAYERS - 1, the
+ *            higher one wins
+ * @param[in] cfg The config of the layer, NULL to remove it
+ *
+ * @return 0 if successful, -1 if the priority is out of range
+ */
+int cfg_layers_set(CfgLayers *layers, int layer, Cfg *cfg);
+
+// Lookups build the merged index if needed, so they mustn't run concurrently
+// with each other unless the index has already been built
+char *cfg_layers_get_string(CfgLayers *layers,
+                            const char *key,
+                            char *fallback);
+bool cfg_layers_get_bool(CfgLayers *layers, const char *key, bool fallback);
+int cfg_layers_get_int(CfgLayers *layers, const char *key, int fallback);
+float cfg_layers_get_float(CfgLayers *layers, const char *key, float fallback);
+CfgColor cfg_layers_get_color(CfgLayers *layers,
+                              const char *key,
+                              CfgColor fallback);
+
+// Called for every entry matching a prefix. val points to the value, except
+// for strings where it's the string itself, like the result of the getters.
+typedef void (*CfgPrefixFn)(const char *key,
+                            CfgValType type,
+                            const void *val,
+                            void *user);
+
+/**
+ * @brief Visits the entries whose key starts with the prefix
+ *
+ * Only the last definition of each key and type is visited. With the sorted
+ * index the entries are visited in key order in O(log n + k), otherwise all
+ * the entries are scanned and visited in file order.
+ *
+ * @param[in] cfg The Cfg object
+ * @param[in] prefix The prefix, e.g. "font." for the whole namespace
+ * @param[in] fn Callback invoked for every matching entry
+ * @param[in] user Argument passed to the callback
+ *
+ * @return Number of entries visited
+ */
+int cfg_iter_prefix(Cfg *cfg, const char *prefix, CfgPrefixFn fn, void *user);
+
+/**
+ * @brief Counts the entries whose key starts with the prefix
+ *
+ * Takes O(log n) with the sorted index.
+ *
+ * @see cfg_iter_prefix()
+ */
+int cfg_count_prefix(Cfg *cfg, const char *prefix);
+
+/**
+ * @brief Copies the statistics of a Cfg object
+ *
+ * The lookup counters are updated with relaxed atomics, so the statistics
+ * can be read while other threads use the getters. They're only updated if
+ * the library is built with CFG_STATS.
+ */
+void cfg_get_stats(Cfg *cfg, CfgStats *stats);
+
 void cfg_fprint(FILE *stream, Cfg *cfg);
 void cfg_fprint_error(FILE *stream, CfgError *err);
 
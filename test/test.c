@@ -1,7 +1,20 @@
+#include "test_arena.h"
+#include "test_binary.h"
+#include "test_dedup.h"
+#include "test_diff.h"
 #include "test_get.h"
+#include "test_layers.h"
 #include "test_load.h"
+#include "test_number.h"
 #include "test_parse.h"
+#include "test_prefix.h"
 #include "test_print.h"
+#include "test_reparse.h"
+#include "test_snapshot.h"
+#include "test_stats.h"
+#include "test_stream.h"
+#include "test_view.h"
+#include "test_watch.h"
 
 int
 main(void)
@@ -18,9 +31,22 @@ main(void)
 
     Scoreboard sb = {0};
     run_parse_tests(&sb, stream);
+    run_number_tests(&sb, stream);
     run_load_tests(&sb, stream);
     run_get_tests(&sb, stream);
+    run_prefix_tests(&sb, stream);
+    run_dedup_tests(&sb, stream);
+    run_layers_tests(&sb, stream);
     run_print_tests(&sb, stream);
+    run_view_tests(&sb, stream);
+    run_arena_tests(&sb, stream);
+    run_stream_tests(&sb, stream);
+    run_reparse_tests(&sb, stream);
+    run_diff_tests(&sb, stream);
+    run_stats_tests(&sb, stream);
+    run_binary_tests(&sb, stream);
+    run_watch_tests(&sb, stream);
+    run_snapshot_tests(&sb, stream);
 
     int total = sb.passed + sb.failed + sb.aborted;
     fprintf(stream, "Total: %d Passed: %d Failed: %d Aborted: %d\n", total,
@@ -0,0 +1,62 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "../config.h"
+#include "test_arena.h"
+
+static TestResult
+run_arena_test(void)
+{
+    CfgError err;
+    CfgArena arena = {.block_size = 64};
+
+    // More entries than TEST_CAPACITY and a key longer than CFG_MAX_KEY
+    char src[4096];
+    int len = 0;
+    for (int i = 0; i < 4 * TEST_CAPACITY; i++)
+        len += snprintf(src + len, sizeof(src) - len, "key: %d\n", i);
+    len += snprintf(src + len, sizeof(src) - len,
+                    "a_very_long_key_that_does_not_fit_in_a_cfg_entry: "
+                    "\"foo\"\n");
+
+    ASSERT(0 == cfg_parse_arena(src, len, &arena, &err));
+    ASSERT(4 * TEST_CAPACITY + 1 == arena.count);
+    ASSERT(arena.allocs > 1);
+
+    ASSERT(4 * TEST_CAPACITY - 1 == cfg_arena_get_int(&arena, "key", -1));
+    ASSERT(-1 == cfg_arena_get_int(&arena, "foo", -1));
+    ASSERT(0 == strcmp("foo", cfg_arena_get_string(
+                                  &arena,
+                                  "a_very_long_key_that_does_not_fit_in_a_"
+                                  "cfg_entry",
+                                  "bar")));
+
+    // Parsing again reuses the memory of the arena
+    int allocs = arena.allocs;
+    ASSERT(0 == cfg_parse_arena(src, len, &arena, &err));
+    ASSERT(0 == cfg_parse_arena(src, len, &arena, &err));
+    ASSERT(allocs + 1 == arena.allocs);
+
+    static const char bad[] = "a: true\nb: 1.5\nc: rgba(1, 2, 3, 1)\nd:";
+    ASSERT(-1 == cfg_parse_arena(bad, strlen(bad), &arena, &err));
+    ASSERT(0 == strcmp("missing value", err.msg));
+
+    ASSERT(true == cfg_arena_get_bool(&arena, "a", false));
+    ASSERT(1.5 == cfg_arena_get_float(&arena, "b", 0));
+    CfgColor c = cfg_arena_get_color(&arena, "c", (CfgColor){0});
+    ASSERT(1 == c.r && 2 == c.g && 3 == c.b && 255 == c.a);
+
+    cfg_arena_free(&arena);
+    ASSERT(NULL == arena.blocks);
+    ASSERT(0 == arena.count);
+
+    return OK;
+}
+
+void
+run_arena_tests(Scoreboard *sb, FILE *stream)
+{
+    TestResult result = run_arena_test();
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+}
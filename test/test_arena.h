@@ -0,0 +1,8 @@
+#ifndef TEST_ARENA_H
+#define TEST_ARENA_H
+
+#include "utils.h"
+
+void run_arena_tests(Scoreboard *sb, FILE *stream);
+
+#endif
@@ -0,0 +1,292 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../config.h"
+#include "test_binary.h"
+
+static bool
+print_cfg(Cfg *cfg, char *buffer, size_t size)
+{
+    FILE *stream = fmemopen(buffer, size, "w");
+    if (stream == NULL)
+        return false;
+
+    cfg_fprint(stream, cfg);
+    fclose(stream);
+    return true;
+}
+
+static TestResult
+run_binary_test(void)
+{
+    CfgError err;
+    CfgEntry entries[TEST_CAPACITY];
+    Cfg cfg = {.entries = entries, .capacity = TEST_CAPACITY};
+
+    static const char src[] = "font: \"JetBrainsMono Nerd Font\"\n"
+                              "font.size: 14\n"
+                              "zoom: 1.5\n"
+                              "offset: -3\n"
+                              "line_numbers: true\n"
+                              "ruler: false\n"
+                              "bg.color: rgba(255, 128, 0, 0.5)\n"
+                              "empty: \"\"\n"
+                              "font.size: 16\n";
+
+    if (cfg_parse(src, strlen(src), &cfg, &err) != 0)
+        return ABORT;
+
+    char path[] = "/tmp/test-binary-XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0)
+        return ABORT;
+    close(fd);
+
+    int res = cfg_save_binary(&cfg, path, &err);
+
+    CfgEntry loaded_entries[TEST_CAPACITY];
+    CfgSlot slots[CFG_INDEX_CAPACITY(TEST_CAPACITY)];
+    Cfg loaded = {
+        .entries = loaded_entries,
+        .capacity = TEST_CAPACITY,
+        .index = {.slots = slots, .capacity = COUNT_OF(slots)},
+    };
+
+    CfgCompactEntry compact_entries[TEST_CAPACITY];
+    char pool[sizeof(src)];
+    Cfg compact = {
+        .compact = compact_entries,
+        .capacity = TEST_CAPACITY,
+        .pool = pool,
+        .pool_capacity = sizeof(pool),
+    };
+
+    if (res == 0)
+        res = cfg_load_binary(path, &loaded, &err);
+    if (res == 0)
+        res = cfg_load_binary(path, &compact, &err);
+
+    // Mapped rather than read
+    CfgEntry mapped_entries[TEST_CAPACITY];
+    Cfg mapped = {
+        .entries = mapped_entries,
+        .capacity = TEST_CAPACITY,
+        .flags = CFG_MAP_FILE,
+    };
+    if (res == 0)
+        res = cfg_load_binary(path, &mapped, &err);
+    unlink(path);
+    ASSERT(0 == res);
+
+    char expected[1024] = {0};
+    char actual[1024] = {0};
+    if (!print_cfg(&cfg, expected, sizeof(expected)) ||
+        !print_cfg(&loaded, actual, sizeof(actual)))
+        return ABORT;
+
+    ASSERT(cfg.count == loaded.count);
+    ASSERT(0 == strcmp(expected, actual));
+
+    // Snapshots can be loaded in the compact layout as well
+    memset(actual, 0, sizeof(actual));
+    if (!print_cfg(&compact, actual, sizeof(actual)))
+        return ABORT;
+
+    ASSERT(cfg.count == compact.count);
+    ASSERT(0 == strcmp(expected, actual));
+
+    memset(actual, 0, sizeof(actual));
+    if (!print_cfg(&mapped, actual, sizeof(actual)))
+        return ABORT;
+
+    ASSERT(cfg.count == mapped.count);
+    ASSERT(0 == strcmp(expected, actual));
+
+    // The prebuilt index is used
+    ASSERT(loaded.index.size > 0);
+    ASSERT(16 == cfg_get_int(&loaded, "font.size", 12));
+    ASSERT(12 == cfg_get_int(&loaded, "font", 12));
+    ASSERT(0 == strcmp("", cfg_get_string(&loaded, "empty", "x")));
+
+    return OK;
+}
+
+static TestResult
+run_binary_error_test(void)
+{
+    CfgError err;
+    CfgEntry entries[TEST_CAPACITY];
+    Cfg cfg = {.entries = entries, .capacity = TEST_CAPACITY};
+
+    static const char src[] = "key: \"value\"\n";
+    if (cfg_parse(src, strlen(src), &cfg, &err) != 0)
+        return ABORT;
+
+    char path[] = "/tmp/test-binary-XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0)
+        return ABORT;
+    close(fd);
+
+    if (cfg_save_binary(&cfg, path, &err) != 0) {
+        unlink(path);
+        return ABORT;
+    }
+
+    // Truncated snapshot
+    if (truncate(path, 30) != 0) {
+        unlink(path);
+        return ABORT;
+    }
+
+    int res = cfg_load_binary(path, &cfg, &err);
+    unlink(path);
+    ASSERT(-1 == res);
+    ASSERT(0 == strcmp("invalid binary file", err.msg));
+
+    // Not a snapshot at all
+    ASSERT(-1 == cfg_load_binary("sample.cfg", &cfg, &err));
+    ASSERT(0 == strcmp("invalid binary file", err.msg));
+
+    ASSERT(-1 == cfg_load_binary("sample2.cfg", &cfg, &err));
+    ASSERT(0 == strcmp("failed to open file", err.msg));
+
+    return OK;
+}
+
+static uint32_t
+read_u32(const uint8_t *src)
+{
+    return (uint32_t) src[0] | (uint32_t) src[1] << 8 |
+           (uint32_t) src[2] << 16 | (uint32_t) src[3] << 24;
+}
+
+static void
+write_u32(uint8_t *dst, uint32_t n)
+{
+    dst[0] = n;
+    dst[1] = n >> 8;
+    dst[2] = n >> 16;
+    dst[3] = n >> 24;
+}
+
+static TestResult
+run_binary_index_test(void)
+{
+    CfgError err;
+    CfgEntry entries[TEST_CAPACITY];
+    CfgSlot slots[CFG_INDEX_CAPACITY(TEST_CAPACITY)];
+    Cfg cfg = {
+        .entries = entries,
+        .capacity = TEST_CAPACITY,
+        .index = {.slots = slots, .capacity = COUNT_OF(slots)},
+    };
+
+    static const char src[] = "a: 1\nb: 2\na: 3\n";
+    if (cfg_parse(src, strlen(src), &cfg, &err) != 0)
+        return ABORT;
+
+    char path[] = "/tmp/test-binary-XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0)
+        return ABORT;
+    close(fd);
+
+    uint8_t saved[512];
+    size_t len = 0;
+    if (cfg_save_binary(&cfg, path, &err) == 0) {
+        FILE *file = fopen(path, "rb");
+        if (file != NULL) {
+            len = fread(saved, 1, sizeof(saved), file);
+            fclose(file);
+        }
+    }
+    if (len == 0 || len == sizeof(saved)) {
+        unlink(path);
+        return ABORT;
+    }
+
+    // The slots follow the 20-byte header and the 16-byte entries
+    uint32_t count = read_u32(saved + 8);
+    uint32_t size = read_u32(saved + 12);
+    uint8_t *index = saved + 20 + count * 16;
+
+    int last = -1;
+    for (uint32_t i = 0; i < size; i++)
+        if (read_u32(index + i * 8 + 4) == 2)
+            last = i;
+    if (last < 0) {
+        unlink(path);
+        return ABORT;
+    }
+
+    for (int corruption = 0; corruption < 3; corruption++) {
+        uint8_t buf[sizeof(saved)];
+        memcpy(buf, saved, len);
+        uint8_t *slot = buf + (index - saved);
+
+        for (uint32_t i = 0; i < size; i++, slot += 8) {
+            if (corruption == 0) {
+                // No empty slot, probing for a miss would never end
+                memcpy(slot, index + last * 8, 8);
+                write_u32(slot + 4, 0);
+            } else if (corruption == 1 && read_u32(slot + 4) != 0xffffffff) {
+                // Wrong hashes, existing keys would be missed
+                write_u32(slot, read_u32(slot) ^ 1);
+            } else if (corruption == 2 && (int) i == last) {
+                // The shadowed definition of the key
+                write_u32(slot + 4, 0);
+            }
+        }
+
+        FILE *file = fopen(path, "wb");
+        if (file == NULL) {
+            unlink(path);
+            return ABORT;
+        }
+        fwrite(buf, 1, len, file);
+        fclose(file);
+
+        ASSERT(-1 == cfg_load_binary(path, &cfg, &err));
+        ASSERT(0 == strcmp("invalid binary file", err.msg));
+        ASSERT(7 == cfg_get_int(&cfg, "zz", 7));
+    }
+
+    // The untouched index loads fine
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        unlink(path);
+        return ABORT;
+    }
+    fwrite(saved, 1, len, file);
+    fclose(file);
+
+    int res = cfg_load_binary(path, &cfg, &err);
+    unlink(path);
+    ASSERT(0 == res);
+    ASSERT(cfg.index.size > 0);
+    ASSERT(3 == cfg_get_int(&cfg, "a", 0));
+    ASSERT(2 == cfg_get_int(&cfg, "b", 0));
+    ASSERT(7 == cfg_get_int(&cfg, "zz", 7));
+
+    return OK;
+}
+
+void
+run_binary_tests(Scoreboard *sb, FILE *stream)
+{
+    TestResult result;
+
+    result = run_binary_test();
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+
+    result = run_binary_error_test();
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+
+    result = run_binary_index_test();
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+}
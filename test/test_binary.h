@@ -0,0 +1,8 @@
+#ifndef TEST_BINARY_H
+#define TEST_BINARY_H
+
+#include "utils.h"
+
+void run_binary_tests(Scoreboard *sb, FILE *stream);
+
+#endif
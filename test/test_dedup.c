@@ -0,0 +1,159 @@
+#include <string.h>
+
+#include "../config.h"
+#include "test_dedup.h"
+
+// A base config followed by an override
+static const char src[] = "font: \"Mono\"\n"
+                          "font.size: 14\n"
+                          "zoom: 1.5\n"
+                          "ruler: true\n"
+                          "bg.color: rgba(1, 2, 3, 1)\n"
+                          "font.size: 16\n"
+                          "font.size: \"large\"\n"
+                          "ruler: false\n"
+                          "font: \"Sans\"\n";
+
+static TestResult
+assert_eq_effective(Cfg *cfg)
+{
+    // The last definition of each key and type, in file order
+    ASSERT(6 == cfg->count);
+    ASSERT(0 == strcmp("zoom", cfg->entries[0].key));
+    ASSERT(0 == strcmp("bg.color", cfg->entries[1].key));
+    ASSERT(0 == strcmp("font.size", cfg->entries[2].key));
+    ASSERT(16 == cfg->entries[2].val.integer);
+    ASSERT(0 == strcmp("font.size", cfg->entries[3].key));
+    ASSERT(0 == strcmp("large", cfg->entries[3].val.string));
+    ASSERT(0 == strcmp("ruler", cfg->entries[4].key));
+    ASSERT(0 == strcmp("font", cfg->entries[5].key));
+
+    ASSERT(0 == strcmp("Sans", cfg_get_string(cfg, "font", "")));
+    ASSERT(16 == cfg_get_int(cfg, "font.size", 12));
+    ASSERT(0 == strcmp("large", cfg_get_string(cfg, "font.size", "")));
+    ASSERT(false == cfg_get_bool(cfg, "ruler", true));
+    ASSERT(1.5 == cfg_get_float(cfg, "zoom", 1));
+    ASSERT(2 == cfg_get_color(cfg, "bg.color", (CfgColor){0}).g);
+    ASSERT(8 == cfg_get_int(cfg, "font", 8));
+
+    return OK;
+}
+
+static TestResult
+run_compact_test(void)
+{
+    CfgError err;
+    CfgEntry entries[TEST_CAPACITY];
+    CfgSlot slots[CFG_INDEX_CAPACITY(TEST_CAPACITY)];
+    Cfg cfg = {
+        .entries = entries,
+        .capacity = TEST_CAPACITY,
+        .index = {.slots = slots, .capacity = COUNT_OF(slots)},
+    };
+
+    if (cfg_parse(src, strlen(src), &cfg, &err) != 0)
+        return ABORT;
+
+    CfgKey key = cfg_key_resolve(&cfg, "font.size", CFG_TYPE_INT);
+    ASSERT(9 == cfg.count);
+    ASSERT(3 == cfg_compact(&cfg));
+
+    TestResult result = assert_eq_effective(&cfg);
+    if (result.type != TEST_PASSED)
+        return result;
+
+    // The index is rebuilt and handles to the old entries are invalidated
+    ASSERT(cfg.index.size >= 2 * cfg.count);
+    ASSERT(12 == cfg_get_int_h(&cfg, key, 12));
+
+    key = cfg_key_resolve(&cfg, "font.size", CFG_TYPE_INT);
+    ASSERT(0 == cfg_compact(&cfg));
+    ASSERT(16 == cfg_get_int_h(&cfg, key, 12));
+
+    // Without index slots a temporary table is used
+    Cfg plain = {.entries = entries, .capacity = TEST_CAPACITY};
+    if (cfg_parse(src, strlen(src), &plain, &err) != 0)
+        return ABORT;
+
+    ASSERT(3 == cfg_compact(&plain));
+    return assert_eq_effective(&plain);
+}
+
+static TestResult
+run_compact_layout_test(void)
+{
+    CfgError err;
+    CfgCompactEntry compact[TEST_CAPACITY];
+    char pool[sizeof(src)];
+    Cfg cfg = {
+        .compact = compact,
+        .capacity = TEST_CAPACITY,
+        .pool = pool,
+        .pool_capacity = sizeof(pool),
+    };
+
+    if (cfg_parse(src, strlen(src), &cfg, &err) != 0)
+        return ABORT;
+
+    ASSERT(3 == cfg_compact(&cfg));
+    ASSERT(6 == cfg.count);
+    ASSERT(0 == strcmp("Sans", cfg_get_string(&cfg, "font", "")));
+    ASSERT(16 == cfg_get_int(&cfg, "font.size", 12));
+    ASSERT(0 == strcmp("large", cfg_get_string(&cfg, "font.size", "")));
+    ASSERT(false == cfg_get_bool(&cfg, "ruler", true));
+
+    return OK;
+}
+
+static TestResult
+run_dedup_flag_test(void)
+{
+    CfgError err;
+    CfgEntry entries[TEST_CAPACITY];
+    Cfg cfg = {
+        .entries = entries,
+        .capacity = TEST_CAPACITY,
+        .flags = CFG_DEDUP,
+    };
+
+    if (cfg_parse(src, strlen(src), &cfg, &err) != 0)
+        return ABORT;
+
+    TestResult result = assert_eq_effective(&cfg);
+    if (result.type != TEST_PASSED)
+        return result;
+
+    // Same for the other ways of populating a Cfg object
+    if (cfg_parse_parallel(src, strlen(src), &cfg, 4, &err) != 0)
+        return ABORT;
+
+    result = assert_eq_effective(&cfg);
+    if (result.type != TEST_PASSED)
+        return result;
+
+    CfgStream stream;
+    cfg_stream_init(&stream, &cfg);
+    if (cfg_stream_feed(&stream, src, strlen(src), &err) != 0 ||
+        cfg_stream_finish(&stream, &err) != 0)
+        return ABORT;
+
+    return assert_eq_effective(&cfg);
+}
+
+void
+run_dedup_tests(Scoreboard *sb, FILE *stream)
+{
+    TestResult result;
+
+    result = run_compact_test();
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+
+    result = run_compact_layout_test();
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+
+    result = run_dedup_flag_test();
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+}
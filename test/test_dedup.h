@@ -0,0 +1,8 @@
+#ifndef TEST_DEDUP_H
+#define TEST_DEDUP_H
+
+#include "utils.h"
+
+void run_dedup_tests(Scoreboard *sb, FILE *stream);
+
+#endif
@@ -0,0 +1,229 @@
+#include <string.h>
+
+#include "../config.h"
+#include "test_diff.h"
+
+typedef struct {
+    CfgChange changes[TEST_CAPACITY];
+    char keys[TEST_CAPACITY][CFG_MAX_KEY + 1];
+    CfgValType types[TEST_CAPACITY];
+    int count;
+} Changes;
+
+static void
+on_change(CfgChange change, const char *key, CfgValType type, void *user)
+{
+    Changes *changes = user;
+    if (changes->count >= TEST_CAPACITY)
+        return;
+
+    int i = changes->count++;
+    changes->changes[i] = change;
+    strcpy(changes->keys[i], key);
+    changes->types[i] = type;
+}
+
+static bool
+has_change(Changes *changes, CfgChange change, const char *key,
+           CfgValType type)
+{
+    for (int i = 0; i < changes->count; i++) {
+        if (changes->changes[i] == change && changes->types[i] == type &&
+            !strcmp(changes->keys[i], key))
+            return true;
+    }
+    return false;
+}
+
+static const char old_src[] = "font: \"Mono\"\n"
+                              "font.size: 14\n"
+                              "font.size: 16\n"
+                              "zoom: 1.5\n"
+                              "ruler: true\n"
+                              "tabs: 4\n"
+                              "bg: rgba(1, 2, 3, 1)\n";
+
+// Only the effective definitions count, and a key changing type is removed
+// under the old type and added under the new one
+static const char new_src[] = "font: \"Mono\"\n"
+                              "font.size: 12\n"
+                              "font.size: 16\n"
+                              "zoom: 2.0\n"
+                              "tabs: \"4\"\n"
+                              "bg: rgba(1, 2, 3, 1)\n"
+                              "bg: rgba(1, 2, 4, 1)\n"
+                              "font.family: \"Sans\"\n";
+
+static TestResult
+assert_changes(Changes *changes)
+{
+    ASSERT(6 == changes->count);
+    ASSERT(has_change(changes, CFG_KEY_MODIFIED, "zoom", CFG_TYPE_FLOAT));
+    ASSERT(has_change(changes, CFG_KEY_MODIFIED, "bg", CFG_TYPE_COLOR));
+    ASSERT(has_change(changes, CFG_KEY_ADDED, "tabs", CFG_TYPE_STRING));
+    ASSERT(has_change(changes, CFG_KEY_ADDED, "font.family",
+                      CFG_TYPE_STRING));
+    ASSERT(has_change(changes, CFG_KEY_REMOVED, "tabs", CFG_TYPE_INT));
+    ASSERT(has_change(changes, CFG_KEY_REMOVED, "ruler", CFG_TYPE_BOOL));
+
+    return OK;
+}
+
+static TestResult
+run_diff_test(void)
+{
+    CfgError err;
+    CfgEntry old_entries[TEST_CAPACITY];
+    CfgEntry new_entries[TEST_CAPACITY];
+    CfgSlot slots[CFG_INDEX_CAPACITY(TEST_CAPACITY)];
+    Cfg old = {.entries = old_entries, .capacity = TEST_CAPACITY};
+    Cfg new = {
+        .entries = new_entries,
+        .capacity = TEST_CAPACITY,
+        .index = {.slots = slots, .capacity = COUNT_OF(slots)},
+    };
+
+    if (cfg_parse(old_src, strlen(old_src), &old, &err) != 0 ||
+        cfg_parse(new_src, strlen(new_src), &new, &err) != 0)
+        return ABORT;
+
+    // The old one has no hash index
+    Changes changes = {0};
+    ASSERT(6 == cfg_diff(&old, &new, on_change, &changes));
+
+    TestResult result = assert_changes(&changes);
+    if (result.type != TEST_PASSED)
+        return result;
+
+    // Nothing changes between a Cfg object and itself
+    changes.count = 0;
+    ASSERT(0 == cfg_diff(&new, &new, on_change, &changes));
+    ASSERT(0 == changes.count);
+
+    // Nor between the two layouts
+    CfgCompactEntry compact[TEST_CAPACITY];
+    char pool[256];
+    Cfg other = {
+        .compact = compact,
+        .capacity = TEST_CAPACITY,
+        .pool = pool,
+        .pool_capacity = sizeof(pool),
+    };
+    if (cfg_parse(new_src, strlen(new_src), &other, &err) != 0)
+        return ABORT;
+
+    ASSERT(0 == cfg_diff(&other, &new, on_change, &changes));
+    ASSERT(6 == cfg_diff(&old, &other, on_change, &changes));
+
+    return OK;
+}
+
+static TestResult
+run_diff_empty_test(void)
+{
+    CfgError err;
+    CfgEntry old_entries[TEST_CAPACITY];
+    CfgEntry new_entries[TEST_CAPACITY];
+    Cfg old = {.entries = old_entries, .capacity = TEST_CAPACITY};
+    Cfg new = {.entries = new_entries, .capacity = TEST_CAPACITY};
+
+    if (cfg_parse("", 0, &old, &err) != 0 ||
+        cfg_parse(old_src, strlen(old_src), &new, &err) != 0)
+        return ABORT;
+
+    Changes changes = {0};
+    ASSERT(6 == cfg_diff(&old, &new, on_change, &changes));
+    ASSERT(has_change(&changes, CFG_KEY_ADDED, "font.size", CFG_TYPE_INT));
+
+    changes.count = 0;
+    ASSERT(6 == cfg_diff(&new, &old, on_change, &changes));
+    ASSERT(has_change(&changes, CFG_KEY_REMOVED, "font.size", CFG_TYPE_INT));
+
+    return OK;
+}
+
+static TestResult
+run_subscribe_test(bool sorted)
+{
+    CfgError err;
+    CfgEntry old_entries[TEST_CAPACITY];
+    CfgEntry new_entries[TEST_CAPACITY];
+    int old_sorted[CFG_SORTED_CAPACITY(TEST_CAPACITY)];
+    int new_sorted[CFG_SORTED_CAPACITY(TEST_CAPACITY)];
+    Cfg old = {.entries = old_entries, .capacity = TEST_CAPACITY};
+    Cfg new = {.entries = new_entries, .capacity = TEST_CAPACITY};
+    if (sorted) {
+        old.sorted = (CfgSorted){old_sorted, 0, COUNT_OF(old_sorted)};
+        new.sorted = (CfgSorted){new_sorted, 0, COUNT_OF(new_sorted)};
+    }
+
+    if (cfg_parse(old_src, strlen(old_src), &old, &err) != 0 ||
+        cfg_parse(new_src, strlen(new_src), &new, &err) != 0)
+        return ABORT;
+
+    CfgSubscription buf[3];
+    CfgSubscribers subs = {.subs = buf, .capacity = COUNT_OF(buf)};
+    Changes font = {0};
+    Changes all = {0};
+    Changes tabs = {0};
+    ASSERT(0 == cfg_subscribe(&subs, "font.", on_change, &font));
+    ASSERT(0 == cfg_subscribe(&subs, "", on_change, &all));
+    ASSERT(0 == cfg_subscribe(&subs, "tabs", on_change, &tabs));
+    ASSERT(-1 == cfg_subscribe(&subs, "zoom", on_change, &all));
+
+    ASSERT(0 == cfg_notify(&subs, &old, &new));
+    ASSERT(1 == font.count);
+    ASSERT(has_change(&font, CFG_KEY_ADDED, "font.family", CFG_TYPE_STRING));
+    ASSERT(2 == tabs.count);
+    ASSERT(has_change(&tabs, CFG_KEY_ADDED, "tabs", CFG_TYPE_STRING));
+    ASSERT(has_change(&tabs, CFG_KEY_REMOVED, "tabs", CFG_TYPE_INT));
+
+    TestResult result = assert_changes(&all);
+    if (result.type != TEST_PASSED)
+        return result;
+
+    cfg_unsubscribe(&subs, on_change, &all);
+    ASSERT(2 == subs.count);
+    ASSERT(&tabs == subs.subs[1].user);
+
+    // Changes can be dispatched from an incremental reparse as well
+    font.count = 0;
+    static const char src[] = "font: \"Mono\"\n"
+                              "font.size: 12\n"
+                              "font.size: 18\n"
+                              "zoom: 2.0\n"
+                              "tabs: \"4\"\n"
+                              "bg: rgba(1, 2, 3, 1)\n"
+                              "bg: rgba(1, 2, 4, 1)\n"
+                              "font.family: \"Sans\"\n";
+    ASSERT(0 == cfg_reparse_incremental(&new, new_src, strlen(new_src), src,
+                                        strlen(src), cfg_dispatch, &subs,
+                                        &err));
+    ASSERT(1 == font.count);
+    ASSERT(has_change(&font, CFG_KEY_MODIFIED, "font.size", CFG_TYPE_INT));
+    ASSERT(2 == tabs.count);
+
+    return OK;
+}
+
+void
+run_diff_tests(Scoreboard *sb, FILE *stream)
+{
+    TestResult result;
+
+    result = run_diff_test();
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+
+    result = run_diff_empty_test();
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+
+    result = run_subscribe_test(false);
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+
+    result = run_subscribe_test(true);
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+}
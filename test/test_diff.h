@@ -0,0 +1,8 @@
+#ifndef TEST_DIFF_H
+#define TEST_DIFF_H
+
+#include "utils.h"
+
+void run_diff_tests(Scoreboard *sb, FILE *stream);
+
+#endif
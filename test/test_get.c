@@ -95,6 +95,273 @@ run_get_color_test(void)
     return OK;
 }
 
+static TestResult
+run_get_index_test(void)
+{
+    CfgError err;
+    CfgEntry entries[TEST_CAPACITY];
+    CfgSlot slots[CFG_INDEX_CAPACITY(TEST_CAPACITY)];
+    Cfg cfg = {
+        .entries = entries,
+        .capacity = TEST_CAPACITY,
+        .index = {.slots = slots, .capacity = COUNT_OF(slots)},
+    };
+
+    static const char src[] = "a: 1\n"
+                              "b: true\n"
+                              "a: \"foo\"\n"
+                              "a: 2\n";
+
+    if (cfg_parse(src, strlen(src), &cfg, &err) != 0)
+        return ABORT;
+
+    ASSERT(cfg.index.size >= 2 * cfg.count);
+
+    // Last definition wins and lookups are filtered by type
+    ASSERT(2 == cfg_get_int(&cfg, "a", 0));
+    ASSERT(0 == strcmp("foo", cfg_get_string(&cfg, "a", "bar")));
+    ASSERT(true == cfg_get_bool(&cfg, "b", false));
+    ASSERT(false == cfg_get_bool(&cfg, "a", false));
+    ASSERT(8 == cfg_get_int(&cfg, "c", 8));
+
+    // Without enough slots the index is not built
+    cfg.index.capacity = cfg.count;
+    if (cfg_parse(src, strlen(src), &cfg, &err) != 0)
+        return ABORT;
+
+    ASSERT(0 == cfg.index.size);
+    ASSERT(2 == cfg_get_int(&cfg, "a", 0));
+    ASSERT(8 == cfg_get_int(&cfg, "c", 8));
+
+    return OK;
+}
+
+static TestResult
+run_get_bloom_test(void)
+{
+    CfgError err;
+    CfgEntry entries[TEST_CAPACITY];
+    uint64_t words[CFG_BLOOM_CAPACITY(TEST_CAPACITY)];
+    Cfg cfg = {
+        .entries = entries,
+        .capacity = TEST_CAPACITY,
+        .bloom = {.words = words, .capacity = COUNT_OF(words)},
+    };
+
+    static const char src[] = "a: 1\n"
+                              "b: true\n"
+                              "ab: 2\n"
+                              "a: \"foo\"\n"
+                              "c: rgba(1, 2, 3, 1)\n"
+                              "a: 3\n";
+
+    if (cfg_parse(src, strlen(src), &cfg, &err) != 0)
+        return ABORT;
+
+    ASSERT(0 < cfg.bloom.size);
+
+    // No false negatives, and the type is part of the key
+    ASSERT(3 == cfg_get_int(&cfg, "a", 0));
+    ASSERT(0 == strcmp("foo", cfg_get_string(&cfg, "a", "")));
+    ASSERT(true == cfg_get_bool(&cfg, "b", false));
+    ASSERT(2 == cfg_get_int(&cfg, "ab", 0));
+    ASSERT(1 == cfg_get_color(&cfg, "c", (CfgColor){0}).r);
+    ASSERT(false == cfg_get_bool(&cfg, "a", false));
+    ASSERT(-1 == cfg_get_int(&cfg, "b", -1));
+    ASSERT(-1 == cfg_get_int(&cfg, "d", -1));
+
+    // Each entry sets at most 3 bits
+    int bits = 0;
+    for (int i = 0; i < cfg.bloom.size; i++)
+        bits += __builtin_popcountll(cfg.bloom.words[i]);
+    ASSERT(0 < bits && bits <= 3 * cfg.count);
+
+    // A filter smaller than it should be still works
+    cfg.bloom.capacity = 1;
+    if (cfg_parse(src, strlen(src), &cfg, &err) != 0)
+        return ABORT;
+
+    ASSERT(1 == cfg.bloom.size);
+    ASSERT(3 == cfg_get_int(&cfg, "a", 0));
+    ASSERT(-1 == cfg_get_int(&cfg, "d", -1));
+
+    // It's combined with the other lookup strategies
+    CfgSlot slots[CFG_INDEX_CAPACITY(TEST_CAPACITY)];
+    cfg.index = (CfgIndex){.slots = slots, .capacity = COUNT_OF(slots)};
+    if (cfg_parse(src, strlen(src), &cfg, &err) != 0)
+        return ABORT;
+
+    ASSERT(0 < cfg.index.size);
+    ASSERT(3 == cfg_get_int(&cfg, "a", 0));
+    ASSERT(-1 == cfg_get_int(&cfg, "d", -1));
+
+    return OK;
+}
+
+static TestResult
+run_get_keys_test(void)
+{
+    CfgError err;
+    CfgEntry entries[TEST_CAPACITY];
+    uint32_t hashes[TEST_CAPACITY];
+    uint8_t lens[TEST_CAPACITY];
+    uint8_t types[TEST_CAPACITY];
+    Cfg cfg = {
+        .entries = entries,
+        .capacity = TEST_CAPACITY,
+        .keys = {.hashes = hashes,
+                 .lens = lens,
+                 .types = types,
+                 .capacity = TEST_CAPACITY},
+    };
+
+    // More entries than a vector, so both the vector and the tail are scanned
+    static const char src[] = "a: 1\n"
+                              "b: true\n"
+                              "ab: 2\n"
+                              "a: \"foo\"\n"
+                              "c: 3\n"
+                              "d: 4\n"
+                              "e: 5\n"
+                              "f: 6\n"
+                              "g: 7\n"
+                              "h: 8\n"
+                              "a: 9\n"
+                              "i: 10\n"
+                              "j: 11\n"
+                              "k: 12\n";
+
+    if (cfg_parse(src, strlen(src), &cfg, &err) != 0)
+        return ABORT;
+
+    ASSERT(cfg.count == cfg.keys.count);
+
+    static const char *const keys[] = {"a", "b", "ab", "c", "h", "k", "ba", ""};
+    for (int i = 0; i < (int) COUNT_OF(keys); i++) {
+        int val = cfg_get_int(&cfg, keys[i], -1);
+        bool flag = cfg_get_bool(&cfg, keys[i], false);
+        char *str = cfg_get_string(&cfg, keys[i], "");
+
+        // Same results as a plain scan of the entries
+        cfg.keys.count = 0;
+        ASSERT(val == cfg_get_int(&cfg, keys[i], -1));
+        ASSERT(flag == cfg_get_bool(&cfg, keys[i], false));
+        ASSERT(str == cfg_get_string(&cfg, keys[i], ""));
+        cfg.keys.count = cfg.count;
+    }
+
+    ASSERT(9 == cfg_get_int(&cfg, "a", 0));
+    ASSERT(0 == strcmp("foo", cfg_get_string(&cfg, "a", "bar")));
+    ASSERT(12 == cfg_get_int(&cfg, "k", 0));
+
+    // Without room for every entry the index is not built
+    cfg.keys.capacity = cfg.count - 1;
+    if (cfg_parse(src, strlen(src), &cfg, &err) != 0)
+        return ABORT;
+
+    ASSERT(0 == cfg.keys.count);
+    ASSERT(9 == cfg_get_int(&cfg, "a", 0));
+
+    return OK;
+}
+
+static TestResult
+run_get_handle_test(void)
+{
+    CfgError err;
+    CfgEntry entries[TEST_CAPACITY];
+    Cfg cfg = {.entries = entries, .capacity = TEST_CAPACITY};
+
+    static const char src[] = "font: \"Mono\"\n"
+                              "font.size: 14\n"
+                              "zoom: 1.5\n"
+                              "ruler: true\n"
+                              "bg.color: rgba(1, 2, 3, 1)\n"
+                              "font.size: 16\n";
+
+    if (cfg_parse(src, strlen(src), &cfg, &err) != 0)
+        return ABORT;
+
+    CfgKey font = cfg_key_resolve(&cfg, "font", CFG_TYPE_STRING);
+    CfgKey size = cfg_key_resolve(&cfg, "font.size", CFG_TYPE_INT);
+    CfgKey zoom = cfg_key_resolve(&cfg, "zoom", CFG_TYPE_FLOAT);
+    CfgKey ruler = cfg_key_resolve(&cfg, "ruler", CFG_TYPE_BOOL);
+    CfgKey color = cfg_key_resolve(&cfg, "bg.color", CFG_TYPE_COLOR);
+    CfgKey missing = cfg_key_resolve(&cfg, "missing", CFG_TYPE_INT);
+
+    ASSERT(0 == strcmp("Mono", cfg_get_string_h(&cfg, font, "Sans")));
+    ASSERT(16 == cfg_get_int_h(&cfg, size, 12));
+    ASSERT(1.5 == cfg_get_float_h(&cfg, zoom, 1));
+    ASSERT(true == cfg_get_bool_h(&cfg, ruler, false));
+    ASSERT(3 == cfg_get_color_h(&cfg, color, (CfgColor){0}).b);
+    ASSERT(12 == cfg_get_int_h(&cfg, missing, 12));
+
+    // A handle resolved for another type yields the fallback
+    ASSERT(12 == cfg_get_int_h(&cfg, font, 12));
+
+    // Parsing again invalidates every handle
+    static const char src2[] = "font.size: 20\n";
+    if (cfg_parse(src2, strlen(src2), &cfg, &err) != 0)
+        return ABORT;
+
+    ASSERT(12 == cfg_get_int_h(&cfg, size, 12));
+    size = cfg_key_resolve(&cfg, "font.size", CFG_TYPE_INT);
+    ASSERT(20 == cfg_get_int_h(&cfg, size, 12));
+
+    return OK;
+}
+
+static TestResult
+run_get_compact_test(void)
+{
+    CfgError err;
+    CfgCompactEntry compact[TEST_CAPACITY];
+    CfgSlot slots[CFG_INDEX_CAPACITY(TEST_CAPACITY)];
+    char pool[256];
+    Cfg cfg = {
+        .compact = compact,
+        .capacity = TEST_CAPACITY,
+        .index = {.slots = slots, .capacity = COUNT_OF(slots)},
+        .pool = pool,
+        .pool_capacity = sizeof(pool),
+    };
+
+    static const char src[] = "font: \"JetBrainsMono Nerd Font\"\n"
+                              "font.size: 14\n"
+                              "zoom: 1.5\n"
+                              "ruler: true\n"
+                              "bg: rgba(255, 128, 0, 1)\n"
+                              "font.size: 16\n";
+
+    if (cfg_parse(src, strlen(src), &cfg, &err) != 0)
+        return ABORT;
+
+    // Same getters, index and handles as the default layout
+    ASSERT(cfg.index.size > 0);
+    ASSERT(0 == strcmp("JetBrainsMono Nerd Font",
+                       cfg_get_string(&cfg, "font", "")));
+    ASSERT(16 == cfg_get_int(&cfg, "font.size", 12));
+    ASSERT(1.5 == cfg_get_float(&cfg, "zoom", 1));
+    ASSERT(true == cfg_get_bool(&cfg, "ruler", false));
+    ASSERT(128 == cfg_get_color(&cfg, "bg", (CfgColor){0}).g);
+    ASSERT(8 == cfg_get_int(&cfg, "font", 8));
+
+    CfgKey key = cfg_key_resolve(&cfg, "font.size", CFG_TYPE_INT);
+    ASSERT(16 == cfg_get_int_h(&cfg, key, 12));
+
+    // Parsing stops at the first entry which doesn't fit in the pool
+    cfg.pool_capacity = 40;
+    if (cfg_parse(src, strlen(src), &cfg, &err) != 0)
+        return ABORT;
+
+    ASSERT(2 == cfg.count);
+    ASSERT(cfg.pool_len <= cfg.pool_capacity);
+    ASSERT(14 == cfg_get_int(&cfg, "font.size", 12));
+    ASSERT(1 == cfg_get_float(&cfg, "zoom", 1));
+
+    return OK;
+}
+
 void
 run_get_tests(Scoreboard *sb, FILE *stream)
 {
@@ -119,4 +386,24 @@ run_get_tests(Scoreboard *sb, FILE *stream)
     result = run_get_color_test();
     update_scoreboard(sb, result);
     log_result(result, stream);
+
+    result = run_get_index_test();
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+
+    result = run_get_bloom_test();
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+
+    result = run_get_keys_test();
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+
+    result = run_get_handle_test();
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+
+    result = run_get_compact_test();
+    update_scoreboard(sb, result);
+    log_result(result, stream);
 }
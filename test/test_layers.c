@@ -0,0 +1,134 @@
+#include <string.h>
+
+#include "../config.h"
+#include "test_layers.h"
+
+static const char defaults_src[] = "font: \"Mono\"\n"
+                                   "font.size: 12\n"
+                                   "zoom: 1.0\n"
+                                   "ruler: false\n"
+                                   "bg: rgba(7, 0, 0, 1)\n";
+
+static const char host_src[] = "font.size: 14\n"
+                               "ruler: true\n"
+                               "font.size: 16\n";
+
+static const char runtime_src[] = "zoom: 2.5\n"
+                                  "font.size: \"large\"\n";
+
+static TestResult
+assert_layered(CfgLayers *layers)
+{
+    // The highest layer which defines a key and type wins
+    ASSERT(0 == strcmp("Mono", cfg_layers_get_string(layers, "font", "")));
+    ASSERT(16 == cfg_layers_get_int(layers, "font.size", 0));
+    ASSERT(0 == strcmp("large",
+                       cfg_layers_get_string(layers, "font.size", "")));
+    ASSERT(2.5 == cfg_layers_get_float(layers, "zoom", 0));
+    ASSERT(true == cfg_layers_get_bool(layers, "ruler", false));
+    ASSERT(7 == cfg_layers_get_color(layers, "bg", (CfgColor){0}).r);
+    ASSERT(8 == cfg_layers_get_int(layers, "missing", 8));
+    ASSERT(8 == cfg_layers_get_int(layers, "font", 8));
+
+    return OK;
+}
+
+static TestResult
+run_layers_test(void)
+{
+    CfgError err;
+    CfgEntry defaults_entries[TEST_CAPACITY];
+    CfgEntry host_entries[TEST_CAPACITY];
+    CfgEntry runtime_entries[TEST_CAPACITY];
+    Cfg defaults = {.entries = defaults_entries, .capacity = TEST_CAPACITY};
+    Cfg host = {.entries = host_entries, .capacity = TEST_CAPACITY};
+    Cfg runtime = {.entries = runtime_entries, .capacity = TEST_CAPACITY};
+
+    if (cfg_parse(defaults_src, strlen(defaults_src), &defaults, &err) != 0 ||
+        cfg_parse(host_src, strlen(host_src), &host, &err) != 0 ||
+        cfg_parse(runtime_src, strlen(runtime_src), &runtime, &err) != 0)
+        return ABORT;
+
+    CfgLayerSlot slots[CFG_INDEX_CAPACITY(3 * TEST_CAPACITY)];
+    CfgLayers layers = {.slots = slots, .capacity = COUNT_OF(slots)};
+
+    // Layers can be skipped, e.g. no site config
+    ASSERT(0 == cfg_layers_set(&layers, 0, &defaults));
+    ASSERT(0 == cfg_layers_set(&layers, 2, &host));
+    ASSERT(0 == cfg_layers_set(&layers, 3, &runtime));
+    ASSERT(-1 == cfg_layers_set(&layers, CFG_MAX_LAYERS, &runtime));
+    ASSERT(4 == layers.count);
+
+    // The merged index is built on the first lookup
+    ASSERT(!layers.built);
+    TestResult result = assert_layered(&layers);
+    if (result.type != TEST_PASSED)
+        return result;
+    ASSERT(layers.built);
+    ASSERT(layers.size > defaults.count + host.count + runtime.count);
+
+    // Replacing a layer invalidates it
+    static const char host_src2[] = "font.size: 20\n";
+    if (cfg_parse(host_src2, strlen(host_src2), &host, &err) != 0)
+        return ABORT;
+
+    ASSERT(0 == cfg_layers_set(&layers, 2, &host));
+    ASSERT(!layers.built);
+    ASSERT(20 == cfg_layers_get_int(&layers, "font.size", 0));
+    ASSERT(false == cfg_layers_get_bool(&layers, "ruler", true));
+
+    ASSERT(0 == cfg_layers_set(&layers, 3, NULL));
+    ASSERT(3 == layers.count);
+    ASSERT(1.0 == cfg_layers_get_float(&layers, "zoom", 0));
+
+    return OK;
+}
+
+static TestResult
+run_layers_search_test(void)
+{
+    CfgError err;
+    CfgEntry defaults_entries[TEST_CAPACITY];
+    CfgEntry host_entries[TEST_CAPACITY];
+    CfgEntry runtime_entries[TEST_CAPACITY];
+    Cfg defaults = {.entries = defaults_entries, .capacity = TEST_CAPACITY};
+    Cfg host = {.entries = host_entries, .capacity = TEST_CAPACITY};
+    Cfg runtime = {.entries = runtime_entries, .capacity = TEST_CAPACITY};
+
+    if (cfg_parse(defaults_src, strlen(defaults_src), &defaults, &err) != 0 ||
+        cfg_parse(host_src, strlen(host_src), &host, &err) != 0 ||
+        cfg_parse(runtime_src, strlen(runtime_src), &runtime, &err) != 0)
+        return ABORT;
+
+    // Without enough slots the layers are searched one by one
+    CfgLayerSlot slots[4];
+    CfgLayers layers = {.slots = slots, .capacity = COUNT_OF(slots)};
+    cfg_layers_set(&layers, 0, &defaults);
+    cfg_layers_set(&layers, 1, &host);
+    cfg_layers_set(&layers, 2, &runtime);
+
+    TestResult result = assert_layered(&layers);
+    if (result.type != TEST_PASSED)
+        return result;
+    ASSERT(0 == layers.size);
+
+    CfgLayers unindexed = {0};
+    cfg_layers_set(&unindexed, 0, &defaults);
+    cfg_layers_set(&unindexed, 1, &host);
+    cfg_layers_set(&unindexed, 2, &runtime);
+    return assert_layered(&unindexed);
+}
+
+void
+run_layers_tests(Scoreboard *sb, FILE *stream)
+{
+    TestResult result;
+
+    result = run_layers_test();
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+
+    result = run_layers_search_test();
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+}
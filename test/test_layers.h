@@ -0,0 +1,8 @@
+#ifndef TEST_LAYERS_H
+#define TEST_LAYERS_H
+
+#include "utils.h"
+
+void run_layers_tests(Scoreboard *sb, FILE *stream);
+
+#endif
@@ -1,4 +1,10 @@
+#include <fcntl.h>
+#include <signal.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 #include "../config.h"
 #include "test_load.h"
@@ -24,10 +30,236 @@ run_load_test(void)
     return OK;
 }
 
+static TestResult
+run_load_pipe_test(void)
+{
+    CfgError err;
+    CfgEntry entries[TEST_CAPACITY];
+    Cfg cfg = {.entries = entries, .capacity = TEST_CAPACITY};
+
+    // Pipes can't be mapped, so they go through the read path
+    char path[] = "/tmp/test-load-XXXXXX.cfg";
+    int fd = mkstemps(path, 4);
+    if (fd < 0)
+        return ABORT;
+    close(fd);
+    unlink(path);
+
+    if (mkfifo(path, 0600) != 0)
+        return ABORT;
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        unlink(path);
+        return ABORT;
+    }
+
+    if (pid == 0) {
+        FILE *fifo = fopen(path, "w");
+        if (fifo == NULL)
+            _exit(1);
+        for (int i = 0; i < 1000; i++)
+            fprintf(fifo, "key: %d\n", i);
+        fclose(fifo);
+        _exit(0);
+    }
+
+    int res = cfg_parse_file(path, &cfg, &err);
+    waitpid(pid, NULL, 0);
+    unlink(path);
+
+    ASSERT(0 == res);
+    ASSERT(TEST_CAPACITY == cfg.count);
+    ASSERT(TEST_CAPACITY - 1 == cfg_get_int(&cfg, "key", -1));
+
+    return OK;
+}
+
+static TestResult
+run_load_empty_test(void)
+{
+    CfgError err;
+    CfgEntry entries[TEST_CAPACITY];
+    Cfg cfg = {.entries = entries, .capacity = TEST_CAPACITY};
+
+    // Empty files can't be mapped either
+    char path[] = "/tmp/test-load-XXXXXX.cfg";
+    int fd = mkstemps(path, 4);
+    if (fd < 0)
+        return ABORT;
+    close(fd);
+
+    int res = cfg_parse_file(path, &cfg, &err);
+    unlink(path);
+
+    ASSERT(0 == res);
+    ASSERT(0 == cfg.count);
+
+    return OK;
+}
+
+static int
+write_file(const char *path, const char *src)
+{
+    FILE *file = fopen(path, "w");
+    if (file == NULL)
+        return -1;
+    fputs(src, file);
+    return fclose(file);
+}
+
+static TestResult
+run_load_rewrite_test(void)
+{
+    CfgError err;
+    CfgEntry entries[TEST_CAPACITY];
+    Cfg cfg = {.entries = entries, .capacity = TEST_CAPACITY};
+
+    char path[] = "/tmp/test-load-XXXXXX.cfg";
+    int fd = mkstemps(path, 4);
+    if (fd < 0)
+        return ABORT;
+    close(fd);
+
+    char src[4096];
+    int off = 0;
+    for (int i = 0; i < TEST_CAPACITY; i++)
+        off += snprintf(src + off, sizeof(src) - off, "key: %d\n", i);
+
+    if (write_file(path, src) != 0) {
+        unlink(path);
+        return ABORT;
+    }
+
+    // Mapped or read, the file parses the same
+    ASSERT(0 == cfg_parse_file(path, &cfg, &err));
+    ASSERT(TEST_CAPACITY - 1 == cfg_get_int(&cfg, "key", -1));
+
+    cfg.flags = CFG_MAP_FILE;
+    ASSERT(0 == cfg_parse_file(path, &cfg, &err));
+    ASSERT(TEST_CAPACITY - 1 == cfg_get_int(&cfg, "key", -1));
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        unlink(path);
+        return ABORT;
+    }
+
+    // Truncating and rewriting the file in place while it's parsed
+    if (pid == 0) {
+        for (;;) {
+            int out = open(path, O_WRONLY | O_TRUNC);
+            if (out < 0)
+                _exit(1);
+            if (write(out, src, off) != off)
+                _exit(1);
+            close(out);
+        }
+    }
+
+    cfg.flags = 0;
+    for (int i = 0; i < 1000; i++)
+        cfg_parse_file(path, &cfg, &err);
+
+    kill(pid, SIGKILL);
+    waitpid(pid, NULL, 0);
+    unlink(path);
+
+    return OK;
+}
+
+static TestResult
+run_load_files_test(void)
+{
+    char dir[] = "/tmp/test-load-XXXXXX";
+    if (mkdtemp(dir) == NULL)
+        return ABORT;
+
+    char paths[6][64];
+    for (int i = 0; i < 6; i++)
+        snprintf(paths[i], sizeof(paths[i]), "%s/%d.cfg", dir, i);
+
+    // Larger than the initial read buffer
+    char big[8192];
+    int off = 0;
+    for (int i = 0; off < 6000; i++)
+        off += snprintf(big + off, sizeof(big) - off, "key: %d\n", i);
+
+    int res = write_file(paths[0], "font: \"Mono\"\nfont.size: 14\n") |
+              write_file(paths[1], "zoom: 1.5 # Comment\n\nzoom: 2.5") |
+              write_file(paths[2], "") | write_file(paths[3], "zoom: 1.5.") |
+              write_file(paths[4], big);
+    if (res != 0)
+        return ABORT;
+
+    // The last file doesn't exist
+    const char *names[] = {paths[0], paths[1], paths[2],
+                           paths[3], paths[4], paths[5]};
+    Cfg cfgs[6];
+    CfgError errs[6];
+    CfgArena arena = {0};
+    CfgFilesOpts opts = {.arena = &arena, .nthreads = 4};
+
+    for (int round = 0; round < 2; round++) {
+        ASSERT(-1 == cfg_parse_files(names, 6, cfgs, errs, &opts));
+
+        ASSERT(0 == strcmp("", errs[0].msg));
+        ASSERT(0 == strcmp("Mono", cfg_get_string(&cfgs[0], "font", "")));
+        ASSERT(14 == cfg_get_int(&cfgs[0], "font.size", 12));
+
+        ASSERT(2 == cfgs[1].count);
+        ASSERT(2.5 == cfg_get_float(&cfgs[1], "zoom", 1));
+
+        ASSERT(0 == strcmp("", errs[2].msg));
+        ASSERT(0 == cfgs[2].count);
+
+        ASSERT(0 != strcmp("", errs[3].msg));
+        ASSERT(1 == errs[3].row);
+
+        ASSERT(0 == strcmp("", errs[4].msg));
+        ASSERT(cfgs[4].count > TEST_CAPACITY);
+        ASSERT(cfgs[4].count - 1 == cfg_get_int(&cfgs[4], "key", -1));
+
+        ASSERT(0 == strcmp("failed to open file", errs[5].msg));
+        ASSERT(0 == cfgs[5].count);
+        ASSERT(8 == cfg_get_int(&cfgs[5], "key", 8));
+    }
+
+    // Deduplicated like any other parse
+    opts.flags = CFG_DEDUP;
+    ASSERT(0 == cfg_parse_files(names + 4, 1, cfgs, errs, &opts));
+    ASSERT(1 == cfgs[0].count);
+
+    cfg_arena_free(&arena);
+    for (int i = 0; i < 5; i++)
+        unlink(paths[i]);
+    rmdir(dir);
+
+    return OK;
+}
+
 void
 run_load_tests(Scoreboard *sb, FILE *stream)
 {
-    TestResult result = run_load_test();
+    TestResult result;
+
+    result = run_load_test();
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+
+    result = run_load_pipe_test();
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+
+    result = run_load_empty_test();
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+
+    result = run_load_rewrite_test();
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+
+    result = run_load_files_test();
     update_scoreboard(sb, result);
     log_result(result, stream);
 }
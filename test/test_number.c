@@ -0,0 +1,107 @@
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../config.h"
+#include "test_number.h"
+
+static TestResult
+run_number_test(void)
+{
+    float f;
+    double d;
+
+    static const char *const half = "16777217.0";  // Halfway, rounds to even
+    ASSERT(10 == cfg_read_float(half, strlen(half), &f));
+    ASSERT(16777216.0f == f);
+    ASSERT(10 == cfg_read_double(half, strlen(half), &d));
+    ASSERT(16777217.0 == d);
+
+    // A digit far past the mantissa breaks the tie
+    static const char *const above = "16777217.00000000000000000000000001";
+    ASSERT((int) strlen(above) == cfg_read_float(above, strlen(above), &f));
+    ASSERT(16777218.0f == f);
+
+    static const char *const tiny =
+        "0.0000000000000000000000000000000000000000000014";
+    ASSERT((int) strlen(tiny) == cfg_read_float(tiny, strlen(tiny), &f));
+    ASSERT(0x1p-149f == f);
+
+    static const char *const zero =
+        "0.0000000000000000000000000000000000000000000007";
+    ASSERT((int) strlen(zero) == cfg_read_float(zero, strlen(zero), &f));
+    ASSERT(0.0f == f);
+
+    ASSERT(4 == cfg_read_float("-0.1 x", 6, &f));
+    ASSERT(-0.1f == f);
+    ASSERT(2 == cfg_read_double("42", 2, &d));
+    ASSERT(42.0 == d);
+
+    ASSERT(0 == cfg_read_float("", 0, &f));
+    ASSERT(0 == cfg_read_float("-", 1, &f));
+    ASSERT(0 == cfg_read_float(".5", 2, &f));
+
+    char large[400];
+    memset(large, '9', sizeof(large));
+    ASSERT(0 == cfg_read_float(large, 39, &f));
+    ASSERT(38 == cfg_read_float(large, 38, &f));
+    ASSERT(0 == cfg_read_double(large, sizeof(large), &d));
+    ASSERT(308 == cfg_read_double(large, 308, &d));
+
+    return OK;
+}
+
+// The C library rounds correctly, random numbers with up to 40 digits, half
+// of them with a fraction, must convert to the same float and double
+static TestResult
+run_number_random_test(void)
+{
+    srand(42);
+
+    for (int i = 0; i < 100000; i++) {
+        char src[64];
+        int len = 0;
+
+        if (rand() % 2)
+            src[len++] = '-';
+
+        int digits = 1 + rand() % 40;
+        int dot = rand() % 2 ? rand() % digits : -1;
+        for (int j = 0; j < digits; j++) {
+            src[len++] = '0' + rand() % 10;
+            if (j == dot)
+                src[len++] = '.';
+        }
+        src[len] = '\0';
+
+        float f = 0, expected_f = strtof(src, NULL);
+        double d = 0, expected_d = strtod(src, NULL);
+
+        if (isinf(expected_f)) {
+            ASSERT(0 == cfg_read_float(src, len, &f));
+        } else {
+            ASSERT(len == cfg_read_float(src, len, &f));
+            ASSERT(0 == memcmp(&expected_f, &f, sizeof(f)));
+        }
+
+        ASSERT(len == cfg_read_double(src, len, &d));
+        ASSERT(0 == memcmp(&expected_d, &d, sizeof(d)));
+    }
+
+    return OK;
+}
+
+void
+run_number_tests(Scoreboard *sb, FILE *stream)
+{
+    TestResult result;
+
+    result = run_number_test();
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+
+    result = run_number_random_test();
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+}
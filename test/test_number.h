@@ -0,0 +1,8 @@
+#ifndef TEST_NUMBER_H
+#define TEST_NUMBER_H
+
+#include "utils.h"
+
+void run_number_tests(Scoreboard *sb, FILE *stream);
+
+#endif
@@ -1,4 +1,6 @@
 #include <assert.h>
+#include <float.h>
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -125,7 +127,7 @@ static const TestCase test_cases[] = {
                 {.key = "key",
                  .type = CFG_TYPE_COLOR,
                  .val.color =
-                     (CfgColor){.r = 255, .g = 255, .b = 255, .a = 127}},
+                     {.r = 255, .g = 255, .b = 255, .a = 127}},
             },
         .expected_count = 1,
     },
@@ -174,6 +176,49 @@ static const TestCase test_cases[] = {
             },
         .expected_count = 2,
     },
+    {
+        .type = TC_SUCC,
+        .line = __LINE__,
+        // Runs longer than a SIMD register
+        .src = "# A comment which is longer than thirty-two bytes\n"
+               "                                    \t\r\n\n"
+               "key:                                   \"A string which is "
+               "longer than thirty-two bytes!\"   \t  # Comment\n",
+        .capacity = TEST_CAPACITY,
+        .expected_entries =
+            (CfgEntry[]){
+                {.key = "key",
+                 .type = CFG_TYPE_STRING,
+                 .val.string =
+                     "A string which is longer than thirty-two bytes!"},
+            },
+        .expected_count = 1,
+    },
+    {
+        .type = TC_SUCC,
+        .line = __LINE__,
+        // Parsing stops when the Cfg is full, errors past that are ignored
+        .src = "a: 1\nb: 2\n# Comment\nc: 3\nd: x\n",
+        .capacity = 2,
+        .expected_entries =
+            (CfgEntry[]){
+                {.key = "a", .type = CFG_TYPE_INT, .val.integer = 1},
+                {.key = "b", .type = CFG_TYPE_INT, .val.integer = 2},
+            },
+        .expected_count = 2,
+    },
+    {
+        .type = TC_SUCC,
+        .line = __LINE__,
+        .src = "aaaaaaaa: 1\nb: 2\nc: x\n",
+        .capacity = 2,
+        .expected_entries =
+            (CfgEntry[]){
+                {.key = "aaaaaaaa", .type = CFG_TYPE_INT, .val.integer = 1},
+                {.key = "b", .type = CFG_TYPE_INT, .val.integer = 2},
+            },
+        .expected_count = 2,
+    },
     {
         .type = TC_SUCC,
         .line = __LINE__,
@@ -185,6 +230,28 @@ static const TestCase test_cases[] = {
             },
         .expected_count = 1,
     },
+    {
+        .type = TC_ERR,
+        .line = __LINE__,
+        .src = "key: \"A string which is longer than thirty-two \x80\"",
+        .capacity = TEST_CAPACITY,
+        .expected_error = "closing '\"' expected",
+    },
+    {
+        .type = TC_ERR,
+        .line = __LINE__,
+        // Non-ASCII letters are never part of a key, whatever the locale
+        .src = "\xE9: 1",
+        .capacity = TEST_CAPACITY,
+        .expected_error = "missing key",
+    },
+    {
+        .type = TC_ERR,
+        .line = __LINE__,
+        .src = "a: 1\nb: 2\n# Comment\nc: 3\nd: x\ne: 5\nf: y\n",
+        .capacity = TEST_CAPACITY,
+        .expected_error = "invalid literal",
+    },
     {
         .type = TC_ERR,
         .line = __LINE__,
@@ -444,20 +511,77 @@ static const TestCase test_cases[] = {
         .capacity = TEST_CAPACITY,
         .expected_error = "number too large",
     },
+    {
+        .type = TC_SUCC,
+        .line = __LINE__,
+        .src = "key: 0.0000000001",
+        .capacity = TEST_CAPACITY,
+        .expected_entries =
+            (CfgEntry[]){
+                {.key = "key", .type = CFG_TYPE_FLOAT, .val.floating = 1e-10f},
+            },
+        .expected_count = 1,
+    },
+    {
+        .type = TC_SUCC,
+        .line = __LINE__,
+        .src = "key: 1.33333333333333333",
+        .capacity = TEST_CAPACITY,
+        .expected_entries =
+            (CfgEntry[]){
+                {.key = "key",
+                 .type = CFG_TYPE_FLOAT,
+                 .val.floating = 1.33333333333333333f},
+            },
+        .expected_count = 1,
+    },
+    {
+        .type = TC_SUCC,
+        .line = __LINE__,
+        .src = "key: 340282356779733661637539395458142568447.0",
+        .capacity = TEST_CAPACITY,
+        .expected_entries =
+            (CfgEntry[]){
+                {.key = "key", .type = CFG_TYPE_FLOAT, .val.floating = FLT_MAX},
+            },
+        .expected_count = 1,
+    },
     {
         .type = TC_ERR,
         .line = __LINE__,
-        .src = "key: 0.0000000000",
+        .src = "key: 340282356779733661637539395458142568448.0",
         .capacity = TEST_CAPACITY,
         .expected_error = "number too large",
     },
+    {
+        .type = TC_SUCC,
+        .line = __LINE__,
+        .src = "key: -2147483648",
+        .capacity = TEST_CAPACITY,
+        .expected_entries =
+            (CfgEntry[]){
+                {.key = "key", .type = CFG_TYPE_INT, .val.integer = INT_MIN},
+            },
+        .expected_count = 1,
+    },
     {
         .type = TC_ERR,
         .line = __LINE__,
-        .src = "key: 1.33333333333333333",
+        .src = "key: 00000000000000000000000002147483648",
         .capacity = TEST_CAPACITY,
         .expected_error = "number too large",
     },
+    {
+        .type = TC_SUCC,
+        .line = __LINE__,
+        .src = "key: 00000000000000000000000002147483647",
+        .capacity = TEST_CAPACITY,
+        .expected_entries =
+            (CfgEntry[]){
+                {.key = "key", .type = CFG_TYPE_INT, .val.integer = INT_MAX},
+            },
+        .expected_count = 1,
+    },
     {
         .type = TC_ERR,
         .line = __LINE__,
@@ -525,6 +649,45 @@ assert_eq_entries(const TestCase tc, const CfgEntry *actual_entries)
     return OK;
 }
 
+static TestResult
+assert_eq_compact(const TestCase tc, const Cfg *cfg)
+{
+    for (int i = 0; i < tc.expected_count; i++) {
+        const CfgEntry *expected = &tc.expected_entries[i];
+        const CfgCompactEntry *actual = &cfg->compact[i];
+        const char *key = cfg->pool + actual->key;
+
+        ASSERT(expected->type == actual->type);
+        ASSERT(strlen(key) == actual->key_len);
+        ASSERT(0 == strcmp(expected->key, key));
+
+        switch (expected->type) {
+        case CFG_TYPE_STRING:
+            ASSERT(0 == strcmp(expected->val.string,
+                               cfg->pool + actual->val.string.off));
+            break;
+
+        case CFG_TYPE_INT:
+            ASSERT(expected->val.integer == actual->val.integer);
+            break;
+
+        case CFG_TYPE_FLOAT:
+            ASSERT(expected->val.floating == actual->val.floating);
+            break;
+
+        case CFG_TYPE_BOOL:
+            ASSERT(expected->val.boolean == actual->val.boolean);
+            break;
+
+        case CFG_TYPE_COLOR:
+            ASSERT(0 == memcmp(&expected->val.color, &actual->val.color,
+                               sizeof(CfgColor)));
+            break;
+        }
+    }
+    return OK;
+}
+
 static TestResult
 run_test_case(TestCase tc)
 {
@@ -540,6 +703,56 @@ run_test_case(TestCase tc)
     // cfg_fprint(stdout, &cfg);
     // cfg_fprint_error(stdout, &err);
 
+    // Splitting the source must not change the result
+    for (int nthreads = 2; nthreads <= 4; nthreads++) {
+        CfgError par_err;
+        CfgEntry par_entries[TEST_CAPACITY];
+        Cfg par_cfg = {.entries = par_entries, .capacity = tc.capacity};
+
+        int par_res =
+            cfg_parse_parallel(tc.src, strlen(tc.src), &par_cfg, nthreads,
+                               &par_err);
+
+        ASSERT(res == par_res);
+        ASSERT(cfg.count == par_cfg.count);
+        if (res != 0) {
+            ASSERT(err.row == par_err.row);
+            ASSERT(err.col == par_err.col);
+            ASSERT(0 == strcmp(err.msg, par_err.msg));
+        } else {
+            TestResult result = assert_eq_entries(tc, par_cfg.entries);
+            if (result.type != TEST_PASSED)
+                return result;
+        }
+    }
+
+    // The compact layout holds the same entries in a pool no larger than
+    // the source
+    CfgError compact_err;
+    CfgCompactEntry compact[TEST_CAPACITY];
+    char pool[1024];
+    Cfg compact_cfg = {
+        .compact = compact,
+        .capacity = tc.capacity,
+        .pool = pool,
+        .pool_capacity = strlen(tc.src),
+    };
+    assert(strlen(tc.src) <= sizeof(pool));
+
+    int compact_res =
+        cfg_parse(tc.src, strlen(tc.src), &compact_cfg, &compact_err);
+
+    ASSERT(res == compact_res);
+    ASSERT(cfg.count == compact_cfg.count);
+    if (res != 0) {
+        ASSERT(err.off == compact_err.off);
+        ASSERT(0 == strcmp(err.msg, compact_err.msg));
+    } else {
+        TestResult result = assert_eq_compact(tc, &compact_cfg);
+        if (result.type != TEST_PASSED)
+            return result;
+    }
+
     switch (tc.type) {
     case TC_SUCC:
         ASSERT(res == 0);
@@ -0,0 +1,165 @@
+#include <string.h>
+
+#include "../config.h"
+#include "test_prefix.h"
+
+typedef struct {
+    char keys[TEST_CAPACITY][CFG_MAX_KEY + 1];
+    CfgValType types[TEST_CAPACITY];
+    int ints[TEST_CAPACITY];
+    int count;
+} Visited;
+
+static void
+visit(const char *key, CfgValType type, const void *val, void *user)
+{
+    Visited *visited = user;
+    if (visited->count >= TEST_CAPACITY)
+        return;
+
+    int i = visited->count++;
+    strcpy(visited->keys[i], key);
+    visited->types[i] = type;
+    visited->ints[i] = type == CFG_TYPE_INT ? *(const int *) val : 0;
+}
+
+static const char src[] = "font: \"Mono\"\n"
+                          "font.size: 14\n"
+                          "fontsize: 10\n"
+                          "bg.color: rgba(1, 2, 3, 1)\n"
+                          "font.family: \"Mono\"\n"
+                          "font.size: 16\n"
+                          "font.bold: true\n"
+                          "fg.color: rgba(3, 2, 1, 1)\n"
+                          "font.size: \"large\"\n"
+                          "font.bold: false\n";
+
+static TestResult
+run_prefix_test(void)
+{
+    CfgError err;
+    CfgEntry entries[TEST_CAPACITY];
+    int sorted[CFG_SORTED_CAPACITY(TEST_CAPACITY)];
+    Cfg cfg = {
+        .entries = entries,
+        .capacity = TEST_CAPACITY,
+        .sorted = {.entries = sorted, .capacity = COUNT_OF(sorted)},
+    };
+
+    if (cfg_parse(src, strlen(src), &cfg, &err) != 0)
+        return ABORT;
+
+    // Every key and type once, without the overridden definitions
+    ASSERT(8 == cfg.sorted.count);
+
+    Visited visited = {0};
+    ASSERT(4 == cfg_iter_prefix(&cfg, "font.", visit, &visited));
+    ASSERT(4 == visited.count);
+
+    // In key order, the last definition of each key and type
+    ASSERT(0 == strcmp("font.bold", visited.keys[0]));
+    ASSERT(0 == strcmp("font.family", visited.keys[1]));
+    ASSERT(0 == strcmp("font.size", visited.keys[2]));
+    ASSERT(0 == strcmp("font.size", visited.keys[3]));
+    ASSERT(CFG_TYPE_STRING == visited.types[2]);
+    ASSERT(CFG_TYPE_INT == visited.types[3]);
+    ASSERT(16 == visited.ints[3]);
+
+    ASSERT(4 == cfg_count_prefix(&cfg, "font."));
+    ASSERT(6 == cfg_count_prefix(&cfg, "font"));
+    ASSERT(2 == cfg_count_prefix(&cfg, "font.size"));
+    ASSERT(8 == cfg_count_prefix(&cfg, ""));
+    ASSERT(1 == cfg_count_prefix(&cfg, "fonts"));
+    ASSERT(0 == cfg_count_prefix(&cfg, "font.sizes"));
+    ASSERT(0 == cfg_count_prefix(&cfg, "a"));
+    ASSERT(0 == cfg_count_prefix(&cfg, "z"));
+
+    visited.count = 0;
+    ASSERT(0 == cfg_iter_prefix(&cfg, "zoom", visit, &visited));
+    ASSERT(0 == visited.count);
+
+    return OK;
+}
+
+static TestResult
+run_prefix_scan_test(void)
+{
+    CfgError err;
+    CfgEntry entries[TEST_CAPACITY];
+    int sorted[CFG_SORTED_CAPACITY(TEST_CAPACITY)];
+    Cfg cfg = {
+        .entries = entries,
+        .capacity = TEST_CAPACITY,
+        .sorted = {.entries = sorted, .capacity = 4},
+    };
+
+    // Without enough room the index is not built and the entries are scanned
+    if (cfg_parse(src, strlen(src), &cfg, &err) != 0)
+        return ABORT;
+
+    ASSERT(0 == cfg.sorted.count);
+
+    Visited visited = {0};
+    ASSERT(4 == cfg_iter_prefix(&cfg, "font.", visit, &visited));
+
+    // In file order, still the last definition of each key and type
+    ASSERT(0 == strcmp("font.family", visited.keys[0]));
+    ASSERT(0 == strcmp("font.size", visited.keys[1]));
+    ASSERT(16 == visited.ints[1]);
+    ASSERT(0 == strcmp("font.size", visited.keys[2]));
+    ASSERT(CFG_TYPE_STRING == visited.types[2]);
+    ASSERT(0 == strcmp("font.bold", visited.keys[3]));
+
+    ASSERT(4 == cfg_count_prefix(&cfg, "font."));
+    ASSERT(6 == cfg_count_prefix(&cfg, "font"));
+    ASSERT(8 == cfg_count_prefix(&cfg, ""));
+    ASSERT(1 == cfg_count_prefix(&cfg, "fonts"));
+    ASSERT(0 == cfg_count_prefix(&cfg, "font.sizes"));
+
+    return OK;
+}
+
+static TestResult
+run_prefix_compact_test(void)
+{
+    CfgError err;
+    CfgCompactEntry compact[TEST_CAPACITY];
+    int sorted[CFG_SORTED_CAPACITY(TEST_CAPACITY)];
+    char pool[sizeof(src)];
+    Cfg cfg = {
+        .compact = compact,
+        .capacity = TEST_CAPACITY,
+        .sorted = {.entries = sorted, .capacity = COUNT_OF(sorted)},
+        .pool = pool,
+        .pool_capacity = sizeof(pool),
+    };
+
+    if (cfg_parse(src, strlen(src), &cfg, &err) != 0)
+        return ABORT;
+
+    Visited visited = {0};
+    ASSERT(2 == cfg_iter_prefix(&cfg, "font.size", visit, &visited));
+    ASSERT(16 == visited.ints[1]);
+    ASSERT(2 == cfg_count_prefix(&cfg, "bg.color") +
+                    cfg_count_prefix(&cfg, "fg."));
+
+    return OK;
+}
+
+void
+run_prefix_tests(Scoreboard *sb, FILE *stream)
+{
+    TestResult result;
+
+    result = run_prefix_test();
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+
+    result = run_prefix_scan_test();
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+
+    result = run_prefix_compact_test();
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+}
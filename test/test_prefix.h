@@ -0,0 +1,8 @@
+#ifndef TEST_PREFIX_H
+#define TEST_PREFIX_H
+
+#include "utils.h"
+
+void run_prefix_tests(Scoreboard *sb, FILE *stream);
+
+#endif
@@ -0,0 +1,548 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "../config.h"
+#include "test_reparse.h"
+
+typedef struct {
+    CfgChange changes[TEST_CAPACITY];
+    char keys[TEST_CAPACITY][CFG_MAX_KEY + 1];
+    CfgValType types[TEST_CAPACITY];
+    int count;
+} Changes;
+
+static void
+on_change(CfgChange change, const char *key, CfgValType type, void *user)
+{
+    Changes *changes = user;
+    if (changes->count >= TEST_CAPACITY)
+        return;
+
+    int i = changes->count++;
+    changes->changes[i] = change;
+    strcpy(changes->keys[i], key);
+    changes->types[i] = type;
+}
+
+static bool
+has_change(Changes *changes, CfgChange change, const char *key)
+{
+    for (int i = 0; i < changes->count; i++) {
+        if (changes->changes[i] == change && !strcmp(changes->keys[i], key))
+            return true;
+    }
+    return false;
+}
+
+static bool
+is_same_cfg(Cfg *a, Cfg *b)
+{
+    if (a->count != b->count)
+        return false;
+
+    for (int i = 0; i < a->count; i++) {
+        CfgEntry *x = &a->entries[i];
+        CfgEntry *y = &b->entries[i];
+        if (x->type != y->type || strcmp(x->key, y->key) != 0)
+            return false;
+
+        bool same = false;
+        switch (x->type) {
+        case CFG_TYPE_STRING:
+            same = !strcmp(x->val.string, y->val.string);
+            break;
+        case CFG_TYPE_BOOL:
+            same = x->val.boolean == y->val.boolean;
+            break;
+        case CFG_TYPE_INT:
+            same = x->val.integer == y->val.integer;
+            break;
+        case CFG_TYPE_FLOAT:
+            same = x->val.floating == y->val.floating;
+            break;
+        case CFG_TYPE_COLOR:
+            same = !memcmp(&x->val.color, &y->val.color, sizeof(CfgColor));
+            break;
+        }
+        if (!same)
+            return false;
+    }
+    return true;
+}
+
+static const char base_src[] = "# Editor\n"
+                               "font: \"Mono\"\n"
+                               "font.size: 14\n"
+                               "\n"
+                               "zoom: 1.5  # Comment\n"
+                               "ruler: true\n"
+                               "bg: rgba(1, 2, 3, 1)\n"
+                               "font.size: 16\n"
+                               "tabs: 4";
+
+static TestResult
+run_reparse_test(void)
+{
+    CfgError err;
+    CfgEntry entries[TEST_CAPACITY];
+    CfgSlot slots[CFG_INDEX_CAPACITY(TEST_CAPACITY)];
+    Cfg cfg = {
+        .entries = entries,
+        .capacity = TEST_CAPACITY,
+        .index = {.slots = slots, .capacity = COUNT_OF(slots)},
+    };
+
+    if (cfg_parse(base_src, strlen(base_src), &cfg, &err) != 0)
+        return ABORT;
+
+    // A value is edited, the index stays as it is
+    static const char src2[] = "# Editor\n"
+                               "font: \"Mono\"\n"
+                               "font.size: 14\n"
+                               "\n"
+                               "zoom: 2.0  # Comment\n"
+                               "ruler: true\n"
+                               "bg: rgba(1, 2, 3, 1)\n"
+                               "font.size: 16\n"
+                               "tabs: 4";
+
+    Changes changes = {0};
+    cfg.index.slots[0].hash ^= 1;
+    uint32_t canary = cfg.index.slots[0].hash;
+    ASSERT(0 == cfg_reparse_incremental(&cfg, base_src, strlen(base_src),
+                                        src2, strlen(src2), on_change,
+                                        &changes, &err));
+    ASSERT(canary == cfg.index.slots[0].hash);
+    cfg.index.slots[0].hash ^= 1;
+
+    ASSERT(1 == changes.count);
+    ASSERT(has_change(&changes, CFG_KEY_MODIFIED, "zoom"));
+    ASSERT(2.0 == cfg_get_float(&cfg, "zoom", 0));
+
+    // A shadowed definition changes but the effective value doesn't, and a
+    // line is added
+    static const char src3[] = "# Editor\n"
+                               "font: \"Mono\"\n"
+                               "font.size: 12\n"
+                               "font.family: \"Sans\"\n"
+                               "\n"
+                               "zoom: 2.0  # Comment\n"
+                               "ruler: true\n"
+                               "bg: rgba(1, 2, 3, 1)\n"
+                               "font.size: 16\n"
+                               "tabs: 4";
+
+    changes.count = 0;
+    ASSERT(0 == cfg_reparse_incremental(&cfg, src2, strlen(src2), src3,
+                                        strlen(src3), on_change, &changes,
+                                        &err));
+    ASSERT(1 == changes.count);
+    ASSERT(has_change(&changes, CFG_KEY_ADDED, "font.family"));
+    ASSERT(16 == cfg_get_int(&cfg, "font.size", 0));
+    ASSERT(0 == strcmp("Sans", cfg_get_string(&cfg, "font.family", "")));
+
+    // Lines are removed, including the last one without a newline
+    static const char src4[] = "# Editor\n"
+                               "font: \"Mono\"\n"
+                               "font.size: 12\n"
+                               "font.family: \"Sans\"\n"
+                               "\n"
+                               "zoom: 2.0  # Comment\n"
+                               "bg: rgba(1, 2, 3, 1)\n"
+                               "font.size: 16\n";
+
+    changes.count = 0;
+    ASSERT(0 == cfg_reparse_incremental(&cfg, src3, strlen(src3), src4,
+                                        strlen(src4), on_change, &changes,
+                                        &err));
+    ASSERT(2 == changes.count);
+    ASSERT(has_change(&changes, CFG_KEY_REMOVED, "ruler"));
+    ASSERT(has_change(&changes, CFG_KEY_REMOVED, "tabs"));
+    ASSERT(false == cfg_get_bool(&cfg, "ruler", false));
+    ASSERT(8 == cfg_get_int(&cfg, "tabs", 8));
+
+    // Same entries as parsing the new version from scratch
+    CfgEntry fresh_entries[TEST_CAPACITY];
+    Cfg fresh = {.entries = fresh_entries, .capacity = TEST_CAPACITY};
+    if (cfg_parse(src4, strlen(src4), &fresh, &err) != 0)
+        return ABORT;
+    ASSERT(is_same_cfg(&fresh, &cfg));
+
+    // Errors are located in the whole source and nothing changes
+    static const char src5[] = "# Editor\n"
+                               "font: \"Mono\"\n"
+                               "font.size: 12\n"
+                               "font.family: \"Sans\"\n"
+                               "\n"
+                               "zoom: 2.0.  # Comment\n"
+                               "bg: rgba(1, 2, 3, 1)\n"
+                               "font.size: 16\n";
+
+    CfgError fresh_err;
+    CfgEntry other_entries[TEST_CAPACITY];
+    Cfg other = {.entries = other_entries, .capacity = TEST_CAPACITY};
+    if (cfg_parse(src5, strlen(src5), &other, &fresh_err) != -1)
+        return ABORT;
+
+    unsigned generation = cfg.generation;
+    ASSERT(-1 == cfg_reparse_incremental(&cfg, src4, strlen(src4), src5,
+                                         strlen(src5), NULL, NULL, &err));
+    ASSERT(6 == err.row);
+    ASSERT(fresh_err.row == err.row);
+    ASSERT(fresh_err.col == err.col);
+    ASSERT(fresh_err.off == err.off);
+    ASSERT(0 == strcmp(fresh_err.msg, err.msg));
+    ASSERT(generation == cfg.generation);
+    ASSERT(is_same_cfg(&fresh, &cfg));
+
+    return OK;
+}
+
+static TestResult
+run_reparse_full_test(void)
+{
+    CfgError err;
+    CfgEntry entries[4];
+    Cfg cfg = {.entries = entries, .capacity = COUNT_OF(entries)};
+
+    static const char src[] = "a: 1\nb: 2\nc: 3\nd: 4\ne: 5\n";
+    static const char src2[] = "a: 1\nb: 2\nc: 3\nd: 4\ne: 6\n";
+    static const char src3[] = "x: 0\na: 1\nb: 2\nc: 3\nd: 4\ne: 6\n";
+
+    if (cfg_parse(src, strlen(src), &cfg, &err) != 0)
+        return ABORT;
+
+    // The entries stop before the end, so an edit past them changes nothing
+    Changes changes = {0};
+    ASSERT(0 == cfg_reparse_incremental(&cfg, src, strlen(src), src2,
+                                        strlen(src2), on_change, &changes,
+                                        &err));
+    ASSERT(0 == changes.count);
+    ASSERT(4 == cfg.count);
+
+    // While an edit before them shifts them out
+    ASSERT(0 == cfg_reparse_incremental(&cfg, src2, strlen(src2), src3,
+                                        strlen(src3), on_change, &changes,
+                                        &err));
+    ASSERT(2 == changes.count);
+    ASSERT(has_change(&changes, CFG_KEY_ADDED, "x"));
+    ASSERT(has_change(&changes, CFG_KEY_REMOVED, "d"));
+    ASSERT(0 == strcmp("c", entries[3].key));
+
+    return OK;
+}
+
+static TestResult
+run_reparse_compact_test(void)
+{
+    CfgError err;
+    CfgCompactEntry compact[TEST_CAPACITY];
+    char pool[sizeof(base_src) + 8];
+    Cfg cfg = {
+        .compact = compact,
+        .capacity = TEST_CAPACITY,
+        .pool = pool,
+        .pool_capacity = sizeof(pool),
+    };
+
+    if (cfg_parse(base_src, strlen(base_src), &cfg, &err) != 0)
+        return ABORT;
+
+    // Edits take pool space until it runs out, then the pool starts over
+    char src[2][sizeof(base_src) + 16];
+    strcpy(src[0], base_src);
+    for (int i = 1; i <= 20; i++) {
+        char *prev = src[(i - 1) % 2];
+        char *next = src[i % 2];
+        snprintf(next, sizeof(src[0]), "%.*s\"Font%02d\"%s", 15, base_src, i,
+                 base_src + 21);
+
+        Changes changes = {0};
+        ASSERT(0 == cfg_reparse_incremental(&cfg, prev, strlen(prev), next,
+                                            strlen(next), on_change,
+                                            &changes, &err));
+        ASSERT(1 == changes.count);
+        ASSERT(has_change(&changes, CFG_KEY_MODIFIED, "font"));
+        ASSERT(cfg.pool_len <= cfg.pool_capacity);
+        ASSERT(0 == strncmp("Font", cfg_get_string(&cfg, "font", ""), 4));
+        ASSERT(16 == cfg_get_int(&cfg, "font.size", 0));
+        ASSERT(4 == cfg_get_int(&cfg, "tabs", 0));
+    }
+
+    return OK;
+}
+
+static TestResult
+run_reparse_after_compact_test(void)
+{
+    CfgError err;
+    CfgEntry entries[TEST_CAPACITY];
+    Cfg cfg = {.entries = entries, .capacity = TEST_CAPACITY};
+
+    static const char old_src[] = "a: 1\na: 2\nb: 3\nc: 4\n";
+    static const char *new_srcs[] = {
+        "a: 9\na: 2\nb: 3\nc: 4\n",
+        "a: 1\na: 7\nb: 3\nc: 4\n",
+    };
+
+    // The dropped entries no longer map to lines, so the source is parsed
+    // again from scratch
+    for (int i = 0; i < (int) COUNT_OF(new_srcs); i++) {
+        if (cfg_parse(old_src, strlen(old_src), &cfg, &err) != 0 ||
+            cfg_compact(&cfg) != 1)
+            return ABORT;
+
+        const char *new_src = new_srcs[i];
+        ASSERT(0 == cfg_reparse_incremental(&cfg, old_src, strlen(old_src),
+                                            new_src, strlen(new_src), NULL,
+                                            NULL, &err));
+        ASSERT(4 == cfg.count);
+        ASSERT((i ? 7 : 2) == cfg_get_int(&cfg, "a", 0));
+        ASSERT(3 == cfg_get_int(&cfg, "b", 0));
+        ASSERT(4 == cfg_get_int(&cfg, "c", 0));
+    }
+
+    // Once parsed again, edits are incremental
+    const char *src = new_srcs[1];
+    ASSERT(0 == cfg_reparse_incremental(&cfg, src, strlen(src), old_src,
+                                        strlen(old_src), NULL, NULL, &err));
+    ASSERT(4 == cfg.count);
+    ASSERT(2 == cfg_get_int(&cfg, "a", 0));
+
+    return OK;
+}
+
+static TestResult
+run_reparse_pool_test(void)
+{
+    CfgError err, expected_err;
+    CfgCompactEntry compact[TEST_CAPACITY], expected_compact[TEST_CAPACITY];
+    char pool[16], expected_pool[16];
+    Cfg cfg = {
+        .compact = compact,
+        .capacity = TEST_CAPACITY,
+        .pool = pool,
+        .pool_capacity = sizeof(pool),
+    };
+    Cfg expected = {
+        .compact = expected_compact,
+        .capacity = TEST_CAPACITY,
+        .pool = expected_pool,
+        .pool_capacity = sizeof(expected_pool),
+    };
+
+    static const char old_src[] = "aaaaaaaa: 1\nbbbbbbbb: 2\n";
+    static const char *new_srcs[] = {
+        "aaaaaaaa: 1\nbbbbbbbb: 2\n!!!\n",
+        "aaaaaaaa: 3\nbbbbbbbb: 2\n",
+        "aaaaaaaa: 1\nbbbbbbbb: 2\nccc: 4\n",
+    };
+
+    // A full pool stops the parse silently, whatever follows
+    for (int i = 0; i < (int) COUNT_OF(new_srcs); i++) {
+        if (cfg_parse(old_src, strlen(old_src), &cfg, &err) != 0)
+            return ABORT;
+
+        const char *new_src = new_srcs[i];
+        ASSERT(0 == cfg_parse(new_src, strlen(new_src), &expected,
+                              &expected_err));
+        ASSERT(0 == cfg_reparse_incremental(&cfg, old_src, strlen(old_src),
+                                            new_src, strlen(new_src), NULL,
+                                            NULL, &err));
+        ASSERT(expected.count == cfg.count);
+        ASSERT(cfg_get_int(&expected, "aaaaaaaa", 0) ==
+               cfg_get_int(&cfg, "aaaaaaaa", 0));
+        ASSERT(0 == cfg_get_int(&cfg, "bbbbbbbb", 0));
+    }
+
+    return OK;
+}
+
+typedef struct {
+    const char *key;
+    CfgValType type;
+} Probe;
+
+static const Probe probes[] = {
+    {"a", CFG_TYPE_INT},  {"a", CFG_TYPE_STRING}, {"b", CFG_TYPE_INT},
+    {"c", CFG_TYPE_BOOL}, {"d", CFG_TYPE_INT},
+};
+
+// Returns whether the key is defined, along with its value
+static bool
+lookup(Cfg *cfg, const Probe *probe, int *val)
+{
+    static char fallback[] = "";
+    char *string;
+
+    switch (probe->type) {
+    case CFG_TYPE_STRING:
+        string = cfg_get_string(cfg, probe->key, fallback);
+        *val = string[0];
+        return string != fallback;
+    case CFG_TYPE_BOOL:
+        *val = cfg_get_bool(cfg, probe->key, false);
+        return *val == cfg_get_bool(cfg, probe->key, true);
+    default:
+        *val = cfg_get_int(cfg, probe->key, 0);
+        return *val == cfg_get_int(cfg, probe->key, 1);
+    }
+}
+
+static bool
+has_expected_changes(Cfg *old, Cfg *new, Changes *changes)
+{
+    int expected = 0;
+    for (int i = 0; i < (int) COUNT_OF(probes); i++) {
+        int old_val, new_val;
+        bool was = lookup(old, &probes[i], &old_val);
+        bool is = lookup(new, &probes[i], &new_val);
+
+        CfgChange change = is ? CFG_KEY_ADDED : CFG_KEY_REMOVED;
+        if (was && is)
+            change = CFG_KEY_MODIFIED;
+        if (was == is && (!is || old_val == new_val))
+            continue;
+
+        expected++;
+        if (!has_change(changes, change, probes[i].key))
+            return false;
+    }
+    return expected == changes->count;
+}
+
+// Random line edits compared with parsing from scratch, which checks the
+// patched indexes as well
+static TestResult
+run_reparse_random_test(bool indexed)
+{
+    static const char *const lines[] = {
+        "a: 1\n", "b: 2\n",    "a: \"x\"\n", "# Comment\n",
+        "\n",     "c: true\n", "b: 3  # Trailing\n",
+    };
+
+    CfgError err;
+    CfgEntry entries[3][TEST_CAPACITY];
+    CfgSlot slots[3][CFG_INDEX_CAPACITY(TEST_CAPACITY)];
+    int sorted[3][CFG_SORTED_CAPACITY(TEST_CAPACITY)];
+    uint32_t hashes[3][TEST_CAPACITY];
+    uint8_t lens[3][TEST_CAPACITY];
+    uint8_t types[3][TEST_CAPACITY];
+    uint64_t words[3][CFG_BLOOM_CAPACITY(TEST_CAPACITY)];
+
+    // The first one is edited, the others are parsed in turns
+    Cfg cfgs[3];
+    for (int i = 0; i < 3; i++) {
+        cfgs[i] = (Cfg){.entries = entries[i], .capacity = TEST_CAPACITY};
+        if (!indexed)
+            continue;
+        cfgs[i].index = (CfgIndex){.slots = slots[i],
+                                   .capacity = COUNT_OF(slots[i])};
+        cfgs[i].sorted = (CfgSorted){.entries = sorted[i],
+                                     .capacity = COUNT_OF(sorted[i])};
+        cfgs[i].keys = (CfgKeys){.hashes = hashes[i],
+                                 .lens = lens[i],
+                                 .types = types[i],
+                                 .capacity = TEST_CAPACITY};
+        cfgs[i].bloom = (CfgBloom){.words = words[i],
+                                   .capacity = COUNT_OF(words[i])};
+    }
+
+    Cfg *cfg = &cfgs[0];
+    int picked[24] = {0};
+    int count = 0;
+    char src[2][512] = {""};
+    if (cfg_parse(src[0], 0, cfg, &err) != 0 ||
+        cfg_parse(src[0], 0, &cfgs[2], &err) != 0)
+        return ABORT;
+
+    srand(indexed ? 21 : 12);
+    for (int round = 1; round <= 2000; round++) {
+        int i = count > 0 ? rand() % count : 0;
+        int op = count == 0 ? 0 : rand() % 3;
+        if (op == 0 && count < (int) COUNT_OF(picked)) {
+            memmove(&picked[i + 1], &picked[i], (count - i) * sizeof(int));
+            picked[i] = rand() % COUNT_OF(lines);
+            count++;
+        } else if (op == 1) {
+            memmove(&picked[i], &picked[i + 1], (count - i - 1) * sizeof(int));
+            count--;
+        } else {
+            picked[i] = rand() % COUNT_OF(lines);
+        }
+
+        char *prev = src[(round - 1) % 2];
+        char *next = src[round % 2];
+        next[0] = '\0';
+        for (int j = 0; j < count; j++)
+            strcat(next, lines[picked[j]]);
+
+        Changes changes = {0};
+        ASSERT(0 == cfg_reparse_incremental(cfg, prev, strlen(prev), next,
+                                            strlen(next), on_change,
+                                            &changes, &err));
+
+        Cfg *old = &cfgs[1 + (round - 1) % 2];
+        Cfg *fresh = &cfgs[1 + round % 2];
+        if (cfg_parse(next, strlen(next), fresh, &err) != 0)
+            return ABORT;
+
+        ASSERT(is_same_cfg(fresh, cfg));
+        ASSERT(has_expected_changes(old, fresh, &changes));
+        for (int j = 0; j < (int) COUNT_OF(probes); j++) {
+            int want, got;
+            ASSERT(lookup(fresh, &probes[j], &want) ==
+                   lookup(cfg, &probes[j], &got));
+            ASSERT(want == got);
+        }
+
+        if (!indexed)
+            continue;
+
+        ASSERT(fresh->sorted.count == cfg->sorted.count);
+        ASSERT(0 == memcmp(fresh->sorted.entries, cfg->sorted.entries,
+                           cfg->sorted.count * sizeof(int)));
+        ASSERT(cfg->keys.count == cfg->count);
+        ASSERT(0 == memcmp(fresh->keys.hashes, cfg->keys.hashes,
+                           cfg->count * sizeof(uint32_t)));
+        ASSERT(0 == memcmp(fresh->keys.lens, cfg->keys.lens, cfg->count));
+        ASSERT(0 == memcmp(fresh->keys.types, cfg->keys.types, cfg->count));
+        ASSERT(cfg->index.size > cfg->count);
+    }
+
+    return OK;
+}
+
+void
+run_reparse_tests(Scoreboard *sb, FILE *stream)
+{
+    TestResult result;
+
+    result = run_reparse_test();
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+
+    result = run_reparse_full_test();
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+
+    result = run_reparse_compact_test();
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+
+    result = run_reparse_after_compact_test();
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+
+    result = run_reparse_pool_test();
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+
+    result = run_reparse_random_test(false);
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+
+    result = run_reparse_random_test(true);
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+}
@@ -0,0 +1,8 @@
+#ifndef TEST_REPARSE_H
+#define TEST_REPARSE_H
+
+#include "utils.h"
+
+void run_reparse_tests(Scoreboard *sb, FILE *stream);
+
+#endif
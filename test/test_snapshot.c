@@ -0,0 +1,186 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+
+#include "../config.h"
+#include "test_snapshot.h"
+
+#define READERS 4
+#define VERSIONS 500
+
+static CfgSnapshot *
+parse_version(int version)
+{
+    CfgError err;
+    char src[128];
+
+    int len = snprintf(src, sizeof(src),
+                       "version: %d\na: %d\nb: %d\nversion: %d\nc: \"%d\"\n",
+                       -1, version, version, version, version);
+    return cfg_snapshot_parse(src, len, &err);
+}
+
+static TestResult
+run_snapshot_test(void)
+{
+    CfgError err;
+
+    static const char src[] = "font.size: 14\n"
+                              "font: \"JetBrainsMono Nerd Font\"\n"
+                              "font.size: 16\n";
+
+    CfgSnapshot *snapshot = cfg_snapshot_parse(src, strlen(src), &err);
+    if (snapshot == NULL)
+        return ABORT;
+
+    Cfg *cfg = cfg_snapshot_cfg(snapshot);
+    ASSERT(3 == cfg->count);
+    ASSERT(16 == cfg_get_int(cfg, "font.size", 12));
+
+    // References keep the snapshot alive
+    ASSERT(snapshot == cfg_snapshot_acquire(snapshot));
+    cfg_snapshot_release(snapshot);
+    ASSERT(16 == cfg_get_int(cfg, "font.size", 12));
+
+    // Handles belong to a single snapshot
+    CfgKey key = cfg_key_resolve(cfg, "font.size", CFG_TYPE_INT);
+    CfgSnapshot *other = cfg_snapshot_parse(src, strlen(src), &err);
+    if (other == NULL) {
+        cfg_snapshot_release(snapshot);
+        return ABORT;
+    }
+    int own = cfg_get_int_h(cfg, key, 12);
+    int foreign = cfg_get_int_h(cfg_snapshot_cfg(other), key, 12);
+    cfg_snapshot_release(other);
+    cfg_snapshot_release(snapshot);
+
+    ASSERT(16 == own);
+    ASSERT(12 == foreign);
+
+    ASSERT(NULL == cfg_snapshot_parse("a: 1\nb 2\n", 9, &err));
+    ASSERT(2 == err.row);
+    ASSERT(0 == strcmp("':' expected", err.msg));
+
+    ASSERT(NULL == cfg_snapshot_parse_file("sample.txt", &err));
+    ASSERT(0 == strcmp("invalid file extension", err.msg));
+
+    snapshot = cfg_snapshot_parse_file("sample.cfg", &err);
+    ASSERT(snapshot != NULL);
+    cfg_snapshot_release(snapshot);
+
+    return OK;
+}
+
+typedef struct {
+    CfgShared *shared;
+    atomic_bool *done;
+    bool torn;
+    bool backwards;
+    int reads;
+} Reader;
+
+static void *
+read_snapshots(void *arg)
+{
+    Reader *reader = arg;
+    int last = 0;
+
+    do {
+        CfgSnapshot *snapshot = cfg_shared_acquire(reader->shared);
+        Cfg *cfg = cfg_snapshot_cfg(snapshot);
+
+        // Every value of a snapshot comes from the same version
+        int version = cfg_get_int(cfg, "version", -2);
+        char expected[16];
+        snprintf(expected, sizeof(expected), "%d", version);
+
+        if (cfg_get_int(cfg, "a", -2) != version ||
+            cfg_get_int(cfg, "b", -2) != version ||
+            strcmp(expected, cfg_get_string(cfg, "c", "")) != 0)
+            reader->torn = true;
+
+        // Versions are published in order
+        if (version < last)
+            reader->backwards = true;
+        last = version;
+
+        cfg_snapshot_release(snapshot);
+        reader->reads++;
+    } while (!atomic_load(reader->done));
+
+    return NULL;
+}
+
+// Several readers acquire the current snapshot while it's being replaced,
+// run under ThreadSanitizer with 'make tsan'
+static TestResult
+run_snapshot_stress_test(void)
+{
+    CfgSnapshot *first = parse_version(0);
+    if (first == NULL)
+        return ABORT;
+
+    CfgShared *shared = cfg_shared_new(first);
+    if (shared == NULL) {
+        cfg_snapshot_release(first);
+        return ABORT;
+    }
+
+    atomic_bool done = false;
+    Reader readers[READERS];
+    pthread_t threads[READERS];
+    int started = 0;
+
+    for (int i = 0; i < READERS; i++) {
+        readers[i] = (Reader){.shared = shared, .done = &done};
+        Reader *reader = &readers[i];
+        if (pthread_create(&threads[i], NULL, read_snapshots, reader) != 0)
+            break;
+        started++;
+    }
+
+    bool published = true;
+    for (int version = 1; version <= VERSIONS; version++) {
+        CfgSnapshot *snapshot = parse_version(version);
+        if (snapshot == NULL) {
+            published = false;
+            break;
+        }
+        cfg_shared_publish(shared, snapshot);
+    }
+
+    atomic_store(&done, true);
+    for (int i = 0; i < started; i++)
+        pthread_join(threads[i], NULL);
+
+    CfgSnapshot *last = cfg_shared_acquire(shared);
+    int version = cfg_get_int(cfg_snapshot_cfg(last), "version", -2);
+    cfg_snapshot_release(last);
+    cfg_shared_free(shared);
+
+    if (started < READERS || !published)
+        return ABORT;
+
+    for (int i = 0; i < READERS; i++) {
+        ASSERT(!readers[i].torn);
+        ASSERT(!readers[i].backwards);
+        ASSERT(readers[i].reads > 0);
+    }
+    ASSERT(VERSIONS == version);
+
+    return OK;
+}
+
+void
+run_snapshot_tests(Scoreboard *sb, FILE *stream)
+{
+    TestResult result;
+
+    result = run_snapshot_test();
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+
+    result = run_snapshot_stress_test();
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+}
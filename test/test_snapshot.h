@@ -0,0 +1,8 @@
+#ifndef TEST_SNAPSHOT_H
+#define TEST_SNAPSHOT_H
+
+#include "utils.h"
+
+void run_snapshot_tests(Scoreboard *sb, FILE *stream);
+
+#endif
@@ -0,0 +1,176 @@
+#include <string.h>
+#include <sys/stat.h>
+
+#include "../config.h"
+#include "test_stats.h"
+
+#ifdef CFG_STATS
+static TestResult
+run_stats_test(void)
+{
+    CfgError err;
+    CfgEntry entries[TEST_CAPACITY];
+    Cfg cfg = {.entries = entries, .capacity = TEST_CAPACITY};
+    CfgStats stats;
+
+    static const char src[] = "# Editor\n"
+                              "font: \"Mono\"  # Family\n"
+                              "font.size: 14\n"
+                              "font.size: 16\n"
+                              "zoom: 1.5\n"
+                              "ruler: true\n"
+                              "bg: rgba(1, 2, 3, 1)\n";
+
+    if (cfg_parse(src, strlen(src), &cfg, &err) != 0)
+        return ABORT;
+
+    cfg_get_stats(&cfg, &stats);
+    ASSERT(strlen(src) == stats.bytes);
+    ASSERT(strlen("# Editor") + strlen("# Family") == stats.comment_bytes);
+    ASSERT(1 == stats.entries[CFG_TYPE_STRING]);
+    ASSERT(1 == stats.entries[CFG_TYPE_BOOL]);
+    ASSERT(2 == stats.entries[CFG_TYPE_INT]);
+    ASSERT(1 == stats.entries[CFG_TYPE_FLOAT]);
+    ASSERT(1 == stats.entries[CFG_TYPE_COLOR]);
+    ASSERT(0 == stats.io_ns);
+    ASSERT(0 < stats.parse_ns);
+    ASSERT(0 == stats.lookups);
+
+    // Key handles count as lookups too
+    cfg_get_int(&cfg, "font.size", 0);
+    cfg_get_int(&cfg, "zoom", 0);
+    cfg_get_float(&cfg, "zoom", 0);
+    CfgKey key = cfg_key_resolve(&cfg, "ruler", CFG_TYPE_BOOL);
+    cfg_get_bool_h(&cfg, key, false);
+    cfg_get_int_h(&cfg, key, 0);
+
+    cfg_get_stats(&cfg, &stats);
+    ASSERT(5 == stats.lookups);
+    ASSERT(2 == stats.misses);
+
+    // Parsing again only resets the parse statistics
+    if (cfg_parse("a: 1\n", 5, &cfg, &err) != 0)
+        return ABORT;
+
+    cfg_get_stats(&cfg, &stats);
+    ASSERT(5 == stats.bytes);
+    ASSERT(0 == stats.comment_bytes);
+    ASSERT(0 == stats.entries[CFG_TYPE_STRING]);
+    ASSERT(1 == stats.entries[CFG_TYPE_INT]);
+    ASSERT(5 == stats.lookups);
+
+    return OK;
+}
+
+static TestResult
+run_stats_parallel_test(void)
+{
+    CfgError err;
+    CfgEntry entries[TEST_CAPACITY];
+    Cfg cfg = {.entries = entries, .capacity = TEST_CAPACITY};
+    CfgStats stats, parallel;
+
+    static const char src[] = "# Editor\n"
+                              "font: \"Mono\"  # Family\n"
+                              "font.size: 14\n"
+                              "zoom: 1.5\n"
+                              "# Ruler\n"
+                              "ruler: true\n"
+                              "bg: rgba(1, 2, 3, 1)\n"
+                              "font.size: 16\n";
+
+    if (cfg_parse(src, strlen(src), &cfg, &err) != 0)
+        return ABORT;
+    cfg_get_stats(&cfg, &stats);
+
+    // The shards add up to the same statistics as a sequential parse
+    for (int nthreads = 2; nthreads <= 4; nthreads++) {
+        Cfg other = {.entries = entries, .capacity = TEST_CAPACITY};
+        ASSERT(0 == cfg_parse_parallel(src, strlen(src), &other, nthreads,
+                                       &err));
+
+        cfg_get_stats(&other, &parallel);
+        ASSERT(stats.bytes == parallel.bytes);
+        ASSERT(stats.comment_bytes == parallel.comment_bytes);
+        ASSERT(0 == memcmp(stats.entries, parallel.entries,
+                           sizeof(stats.entries)));
+        ASSERT(0 < parallel.parse_ns);
+    }
+
+    // Entries past the capacity aren't counted
+    Cfg small = {.entries = entries, .capacity = 3};
+    ASSERT(0 == cfg_parse_parallel(src, strlen(src), &small, 4, &err));
+
+    cfg_get_stats(&small, &parallel);
+    ASSERT(1 == parallel.entries[CFG_TYPE_STRING]);
+    ASSERT(1 == parallel.entries[CFG_TYPE_INT]);
+    ASSERT(1 == parallel.entries[CFG_TYPE_FLOAT]);
+    ASSERT(0 == parallel.entries[CFG_TYPE_BOOL]);
+
+    return OK;
+}
+
+static TestResult
+run_stats_file_test(void)
+{
+    CfgError err;
+    CfgEntry entries[TEST_CAPACITY];
+    Cfg cfg = {.entries = entries, .capacity = TEST_CAPACITY};
+    CfgStats stats;
+
+    struct stat st;
+    if (stat("sample.cfg", &st) != 0)
+        return ABORT;
+
+    ASSERT(0 == cfg_parse_file("sample.cfg", &cfg, &err));
+
+    cfg_get_stats(&cfg, &stats);
+    ASSERT(st.st_size == (off_t) stats.bytes);
+    ASSERT(0 < stats.comment_bytes);
+    ASSERT(0 < stats.io_ns);
+    ASSERT(0 < stats.parse_ns);
+
+    // Same for the files loaded in batches
+    CfgArena arena = {0};
+    const char *paths[] = {"sample.cfg"};
+    Cfg cfgs[1];
+    CfgError errs[1];
+    CfgFilesOpts opts = {.arena = &arena, .nthreads = 1};
+    ASSERT(0 == cfg_parse_files(paths, 1, cfgs, errs, &opts));
+
+    CfgStats batch;
+    cfg_get_stats(&cfgs[0], &batch);
+    ASSERT(stats.bytes == batch.bytes);
+    ASSERT(stats.comment_bytes == batch.comment_bytes);
+    ASSERT(0 == memcmp(stats.entries, batch.entries, sizeof(stats.entries)));
+    ASSERT(0 < batch.io_ns);
+
+    cfg_arena_free(&arena);
+    return OK;
+}
+#endif
+
+void
+run_stats_tests(Scoreboard *sb, FILE *stream)
+{
+    // The statistics are compiled out unless CFG_STATS is defined, as by
+    // the tst-stats target
+#ifdef CFG_STATS
+    TestResult result;
+
+    result = run_stats_test();
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+
+    result = run_stats_parallel_test();
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+
+    result = run_stats_file_test();
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+#else
+    (void) sb;
+    (void) stream;
+#endif
+}
@@ -0,0 +1,8 @@
+#ifndef TEST_STATS_H
+#define TEST_STATS_H
+
+#include "utils.h"
+
+void run_stats_tests(Scoreboard *sb, FILE *stream);
+
+#endif
@@ -0,0 +1,132 @@
+#include <string.h>
+
+#include "../config.h"
+#include "test_stream.h"
+
+static int
+parse_in_chunks(const char *src, int chunk, Cfg *cfg, CfgError *err)
+{
+    CfgStream stream;
+    cfg_stream_init(&stream, cfg);
+
+    int len = strlen(src);
+    for (int off = 0; off < len; off += chunk) {
+        int n = len - off < chunk ? len - off : chunk;
+        if (cfg_stream_feed(&stream, src + off, n, err) != 0) {
+            CfgError ignored;
+            cfg_stream_finish(&stream, &ignored);
+            return -1;
+        }
+    }
+
+    return cfg_stream_finish(&stream, err);
+}
+
+static bool
+eq_entries(const CfgEntry *a, const CfgEntry *b, int count)
+{
+    for (int i = 0; i < count; i++) {
+        if (a[i].type != b[i].type || strcmp(a[i].key, b[i].key))
+            return false;
+
+        bool eq = true;
+        switch (a[i].type) {
+        case CFG_TYPE_STRING:
+            eq = !strcmp(a[i].val.string, b[i].val.string);
+            break;
+        case CFG_TYPE_BOOL:
+            eq = a[i].val.boolean == b[i].val.boolean;
+            break;
+        case CFG_TYPE_INT:
+            eq = a[i].val.integer == b[i].val.integer;
+            break;
+        case CFG_TYPE_FLOAT:
+            eq = a[i].val.floating == b[i].val.floating;
+            break;
+        case CFG_TYPE_COLOR:
+            eq = !memcmp(&a[i].val.color, &b[i].val.color, sizeof(CfgColor));
+            break;
+        }
+
+        if (!eq)
+            return false;
+    }
+    return true;
+}
+
+static TestResult
+run_stream_test(void)
+{
+    static const char src[] = "# Comment\n"
+                              "font: \"JetBrainsMono Nerd Font\"\n"
+                              "\n"
+                              "font.size: 14 # Comment\n"
+                              "  zoom: 1.5\n"
+                              "bg.color: rgba(255, 255, 255, 1)\n"
+                              "font.size: 16";
+
+    CfgError err;
+    CfgEntry expected[TEST_CAPACITY];
+    Cfg expected_cfg = {.entries = expected, .capacity = TEST_CAPACITY};
+    if (cfg_parse(src, strlen(src), &expected_cfg, &err) != 0)
+        return ABORT;
+
+    // Every chunk size splits lines at a different place
+    for (int chunk = 1; chunk <= (int) sizeof(src); chunk++) {
+        CfgEntry entries[TEST_CAPACITY];
+        Cfg cfg = {.entries = entries, .capacity = TEST_CAPACITY};
+
+        ASSERT(0 == parse_in_chunks(src, chunk, &cfg, &err));
+        ASSERT(expected_cfg.count == cfg.count);
+        ASSERT(eq_entries(expected, entries, cfg.count));
+    }
+
+    return OK;
+}
+
+static TestResult
+run_stream_error_test(void)
+{
+    static const char *srcs[] = {
+        "a: 1\nb: 2\nc: x\nd: 4\n",
+        "a: 1\n\n# Comment\n  b: \"foo\nc: 3\n",
+        "a: 1\nb: 2\nc:",
+    };
+
+    for (int i = 0; i < (int) COUNT_OF(srcs); i++) {
+        CfgError expected;
+        CfgEntry expected_entries[TEST_CAPACITY];
+        Cfg expected_cfg = {.entries = expected_entries,
+                            .capacity = TEST_CAPACITY};
+        if (cfg_parse(srcs[i], strlen(srcs[i]), &expected_cfg, &expected) == 0)
+            return ABORT;
+
+        for (int chunk = 1; chunk <= (int) strlen(srcs[i]); chunk++) {
+            CfgError err;
+            CfgEntry entries[TEST_CAPACITY];
+            Cfg cfg = {.entries = entries, .capacity = TEST_CAPACITY};
+
+            ASSERT(-1 == parse_in_chunks(srcs[i], chunk, &cfg, &err));
+            ASSERT(expected.off == err.off);
+            ASSERT(expected.row == err.row);
+            ASSERT(expected.col == err.col);
+            ASSERT(0 == strcmp(expected.msg, err.msg));
+        }
+    }
+
+    return OK;
+}
+
+void
+run_stream_tests(Scoreboard *sb, FILE *stream)
+{
+    TestResult result;
+
+    result = run_stream_test();
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+
+    result = run_stream_error_test();
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+}
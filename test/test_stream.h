@@ -0,0 +1,8 @@
+#ifndef TEST_STREAM_H
+#define TEST_STREAM_H
+
+#include "utils.h"
+
+void run_stream_tests(Scoreboard *sb, FILE *stream);
+
+#endif
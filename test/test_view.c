@@ -0,0 +1,96 @@
+#include <string.h>
+
+#include "../config.h"
+#include "test_view.h"
+
+static TestResult
+run_view_test(void)
+{
+    CfgError err;
+    CfgViewEntry entries[TEST_CAPACITY];
+    CfgView view = {.entries = entries, .capacity = TEST_CAPACITY};
+
+    static const char src[] = "font: \"JetBrainsMono Nerd Font\"\n"
+                              "font.size: 14\n"
+                              "zoom: 1.5\n"
+                              "ruler: false # Comment\n"
+                              "bg.color: rgba(255, 255, 255, 1)\n"
+                              "font.size: 16\n";
+
+    ASSERT(0 == cfg_parse_view(src, strlen(src), &view, &err));
+    ASSERT(6 == view.count);
+    ASSERT(src == view.src);
+
+    ASSERT(0 == entries[0].key.off);
+    ASSERT(4 == entries[0].key.len);
+    ASSERT(CFG_TYPE_STRING == entries[0].type);
+    ASSERT(7 == entries[0].val.string.off);
+    ASSERT(23 == entries[0].val.string.len);
+
+    int len;
+    const char *font = cfg_view_get_string(&view, "font", "Sans", &len);
+    ASSERT(23 == len);
+    ASSERT(0 == strncmp("JetBrainsMono Nerd Font", font, len));
+
+    font = cfg_view_get_string(&view, "fon", "Sans", &len);
+    ASSERT(4 == len);
+    ASSERT(0 == strcmp("Sans", font));
+
+    ASSERT(16 == cfg_view_get_int(&view, "font.size", 12));
+    ASSERT(12 == cfg_view_get_int(&view, "font", 12));
+    ASSERT(1.5 == cfg_view_get_float(&view, "zoom", 1));
+    ASSERT(false == cfg_view_get_bool(&view, "ruler", true));
+
+    CfgColor white = {.r = 255, .g = 255, .b = 255, .a = 255};
+    CfgColor black = {0};
+    CfgColor bg = cfg_view_get_color(&view, "bg.color", black);
+    ASSERT(0 == memcmp(&white, &bg, sizeof(CfgColor)));
+
+    return OK;
+}
+
+static TestResult
+run_view_limits_test(void)
+{
+    CfgError err;
+    CfgViewEntry entries[TEST_CAPACITY];
+    CfgView view = {.entries = entries, .capacity = TEST_CAPACITY};
+
+    char src[256];
+    int len = 0;
+
+    // Neither CFG_MAX_KEY nor CFG_MAX_VAL apply to slices
+    memset(src, 'k', 2 * CFG_MAX_KEY);
+    len += 2 * CFG_MAX_KEY;
+    memcpy(src + len, ": \"", 3);
+    len += 3;
+    memset(src + len, 'v', 2 * CFG_MAX_VAL);
+    len += 2 * CFG_MAX_VAL;
+    src[len++] = '"';
+
+    ASSERT(0 == cfg_parse_view(src, len, &view, &err));
+    ASSERT(1 == view.count);
+    ASSERT(2 * CFG_MAX_KEY == entries[0].key.len);
+    ASSERT(2 * CFG_MAX_VAL == entries[0].val.string.len);
+
+    static const char bad[] = "a: 1\nb: 2 x";
+    ASSERT(-1 == cfg_parse_view(bad, strlen(bad), &view, &err));
+    ASSERT(0 == strcmp("unexpected character 'x'", err.msg));
+    ASSERT(2 == err.row);
+
+    return OK;
+}
+
+void
+run_view_tests(Scoreboard *sb, FILE *stream)
+{
+    TestResult result;
+
+    result = run_view_test();
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+
+    result = run_view_limits_test();
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+}
@@ -0,0 +1,8 @@
+#ifndef TEST_VIEW_H
+#define TEST_VIEW_H
+
+#include "utils.h"
+
+void run_view_tests(Scoreboard *sb, FILE *stream);
+
+#endif
@@ -0,0 +1,211 @@
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../config.h"
+#include "test_watch.h"
+
+typedef struct {
+    atomic_int reloads;
+    atomic_int failures;
+    CfgError err;
+} Reloads;
+
+static void
+on_reload(int res, CfgError *err, void *user)
+{
+    Reloads *reloads = user;
+
+    if (res != 0) {
+        reloads->err = *err;
+        atomic_fetch_add(&reloads->failures, 1);
+    }
+    atomic_fetch_add(&reloads->reloads, 1);
+}
+
+static bool
+write_file(const char *path, const char *src)
+{
+    FILE *file = fopen(path, "w");
+    if (file == NULL)
+        return false;
+
+    fputs(src, file);
+    return fclose(file) == 0;
+}
+
+// Waits up to 5 seconds for the watcher thread to catch up
+static bool
+wait_reloads(Reloads *reloads, int n)
+{
+    struct timespec delay = {.tv_nsec = 1000000};
+    for (int i = 0; i < 5000; i++) {
+        if (atomic_load(&reloads->reloads) >= n)
+            return true;
+        nanosleep(&delay, NULL);
+    }
+    return false;
+}
+
+static int
+get_size(CfgWatcher *watcher)
+{
+    int epoch;
+    Cfg *cfg = cfg_watcher_enter(watcher, &epoch);
+    int size = cfg_get_int(cfg, "size", -1);
+    cfg_watcher_exit(watcher, epoch);
+    return size;
+}
+
+static TestResult
+run_watch_test(void)
+{
+    CfgError err;
+    Reloads reloads = {0};
+
+    char dir[] = "/tmp/test-watch-XXXXXX";
+    if (mkdtemp(dir) == NULL)
+        return ABORT;
+
+    char path[64], tmp[64];
+    snprintf(path, sizeof(path), "%s/test.cfg", dir);
+    snprintf(tmp, sizeof(tmp), "%s/test.tmp", dir);
+
+    if (!write_file(path, "size: 1\n")) {
+        rmdir(dir);
+        return ABORT;
+    }
+
+    CfgWatcher *watcher = cfg_watch(path, on_reload, &reloads, &err);
+    if (watcher == NULL) {
+        unlink(path);
+        rmdir(dir);
+        return ABORT;
+    }
+
+    int before = get_size(watcher);
+
+    // Replaced by renaming, as most editors do
+    bool replaced = write_file(tmp, "size: 2\n") && rename(tmp, path) == 0 &&
+                    wait_reloads(&reloads, 1);
+    int after_rename = get_size(watcher);
+
+    // Written in place with an error, the previous config is kept
+    bool rewritten = write_file(path, "size: 3\nsize 4\n") &&
+                     wait_reloads(&reloads, 2);
+    int after_error = get_size(watcher);
+
+    // Other files in the directory are ignored
+    bool other = write_file(tmp, "size: 5\n");
+    bool fixed = write_file(path, "size: 6\n") && wait_reloads(&reloads, 3);
+    int after_fix = get_size(watcher);
+
+    cfg_unwatch(watcher);
+    unlink(tmp);
+    unlink(path);
+    rmdir(dir);
+
+    if (!replaced || !rewritten || !other || !fixed)
+        return ABORT;
+
+    ASSERT(1 == before);
+    ASSERT(2 == after_rename);
+    ASSERT(2 == after_error);
+    ASSERT(6 == after_fix);
+    ASSERT(3 == atomic_load(&reloads.reloads));
+    ASSERT(1 == atomic_load(&reloads.failures));
+    ASSERT(2 == reloads.err.row);
+    ASSERT(0 == strcmp("':' expected", reloads.err.msg));
+
+    return OK;
+}
+
+static TestResult
+run_watch_rewrite_test(void)
+{
+    CfgError err;
+    Reloads reloads = {0};
+
+    char dir[] = "/tmp/test-watch-XXXXXX";
+    if (mkdtemp(dir) == NULL)
+        return ABORT;
+
+    char path[64];
+    snprintf(path, sizeof(path), "%s/test.cfg", dir);
+
+    char src[4096];
+    int len = 0;
+    for (int i = 0; i < 256; i++)
+        len += snprintf(src + len, sizeof(src) - len, "size: %d\n", i % 7);
+
+    if (!write_file(path, src)) {
+        rmdir(dir);
+        return ABORT;
+    }
+
+    CfgWatcher *watcher = cfg_watch(path, on_reload, &reloads, &err);
+    if (watcher == NULL) {
+        unlink(path);
+        rmdir(dir);
+        return ABORT;
+    }
+
+    // Truncated and rewritten in place while the watcher reloads it
+    bool rewritten = true;
+    for (int i = 0; i < 1000 && rewritten; i++)
+        rewritten = write_file(path, src);
+
+    bool fixed = write_file(path, "size: 7\n");
+    struct timespec delay = {.tv_nsec = 1000000};
+    for (int i = 0; i < 5000 && get_size(watcher) != 7; i++)
+        nanosleep(&delay, NULL);
+    int after = get_size(watcher);
+
+    cfg_unwatch(watcher);
+    unlink(path);
+    rmdir(dir);
+
+    if (!rewritten || !fixed)
+        return ABORT;
+
+    ASSERT(7 == after);
+
+    return OK;
+}
+
+static TestResult
+run_watch_error_test(void)
+{
+    CfgError err;
+
+    ASSERT(NULL == cfg_watch("sample.txt", NULL, NULL, &err));
+    ASSERT(0 == strcmp("invalid file extension", err.msg));
+
+    ASSERT(NULL == cfg_watch("sample2.cfg", NULL, NULL, &err));
+    ASSERT(0 == strcmp("failed to open file", err.msg));
+
+    ASSERT(NULL == cfg_watch("/nonexistent/sample.cfg", NULL, NULL, &err));
+    ASSERT(0 == strcmp("failed to watch file", err.msg));
+
+    return OK;
+}
+
+void
+run_watch_tests(Scoreboard *sb, FILE *stream)
+{
+    TestResult result;
+
+    result = run_watch_test();
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+
+    result = run_watch_rewrite_test();
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+
+    result = run_watch_error_test();
+    update_scoreboard(sb, result);
+    log_result(result, stream);
+}
@@ -0,0 +1,8 @@
+#ifndef TEST_WATCH_H
+#define TEST_WATCH_H
+
+#include "utils.h"
+
+void run_watch_tests(Scoreboard *sb, FILE *stream);
+
+#endif
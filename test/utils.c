@@ -3,8 +3,8 @@
 void
 log_result(TestResult result, FILE *stream)
 {
-    char *res;
-    char *color;
+    char *res = "";
+    char *color = RESET;
 
     switch (result.type) {
     case TEST_PASSED: